@@ -0,0 +1,418 @@
+// Microbenchmarks for calist operations across sizes, ctypes and storage
+//   modes. Each result is one row of CSV or one object of a JSON array:
+//     type, mode, op, size, ops, total_ns, ns_per_op
+//   where ops is the number of timed operations at the given list size.
+//
+// Usage: bench_calist [--format csv|json] [--out FILE] [--min N] [--max N]
+//                     [--types LIST] [--modes LIST] [--ops LIST]
+//   Sizes run in powers of ten from --min [1000] to --max [1000000]; pass
+//   --max 100000000 for the largest runs. LISTs are comma-separated names:
+//     types: int, double, string
+//     modes: boxed, inline, parallel
+//     ops:   append, insert_front, pop, remove_if, index, count, qsort,
+//            bsearch, unique, dup, print
+//   Inline string lists use ctype_sso_string, and boxed ones ctype_string.
+//   The parallel mode uses inline storage and runs the operations that
+//   have a calist_par_* counterpart (count, qsort).
+// note: build with "make bench BUILD=release" to time optimized code
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "calist.h"
+
+// Linear operations on a list of n items are repeated about
+//   BENCH_WORK / n times, so that each measurement scans a similar
+//   number of items at every size
+#define BENCH_WORK 10000000
+#define BENCH_MAX_REPS 1000
+// The largest number of lookups timed by bsearch
+#define BENCH_MAX_LOOKUPS 1000000
+
+typedef enum { TYPE_INT, TYPE_DOUBLE, TYPE_STRING } bench_type;
+typedef enum { MODE_BOXED, MODE_INLINE, MODE_PARALLEL } bench_mode;
+
+// A value of any of the benchmarked ctypes
+typedef struct {
+  int i;
+  double d;
+  char s[24];
+} bench_item;
+
+typedef struct {
+  bench_type type;
+  bench_mode mode;
+  size_t size;
+  calist *base;  // size items in pseudo-random order
+} bench_case;
+
+typedef struct {
+  const char *name;
+  bool parallel;  // runs in the parallel mode
+  void (*run)(const bench_case *bc, const char *name);
+} bench_op;
+
+static const char *const TYPE_NAMES[] = { "int", "double", "string" };
+static const char *const MODE_NAMES[] = { "boxed", "inline", "parallel" };
+
+static FILE *out;
+static bool json;
+static size_t rows;
+
+static uint64_t now_ns(void);
+static void report(const bench_case *bc, const char *op, size_t ops,
+                   uint64_t ns);
+static const void *make_item(bench_type type, size_t v, bench_item *buf);
+static calist *create_list(const bench_case *bc, size_t init_cap);
+static size_t bench_reps(size_t n);
+static bool listed(const char *list, const char *name);
+static bool less_than(const calist *al, const void *item, const void *args);
+static bool equal_to(const calist *al, const void *item, const void *args);
+static size_t sink_discard(const char *buf, size_t n, void *ctx);
+static void run_append(const bench_case *bc, const char *name);
+static void run_insert_front(const bench_case *bc, const char *name);
+static void run_pop(const bench_case *bc, const char *name);
+static void run_remove_if(const bench_case *bc, const char *name);
+static void run_index(const bench_case *bc, const char *name);
+static void run_count(const bench_case *bc, const char *name);
+static void run_qsort(const bench_case *bc, const char *name);
+static void run_bsearch(const bench_case *bc, const char *name);
+static void run_unique(const bench_case *bc, const char *name);
+static void run_dup(const bench_case *bc, const char *name);
+static void run_print(const bench_case *bc, const char *name);
+
+static const bench_op OPS[] = {
+  { "append", false, run_append },
+  { "insert_front", false, run_insert_front },
+  { "pop", false, run_pop },
+  { "remove_if", false, run_remove_if },
+  { "index", false, run_index },
+  { "count", true, run_count },
+  { "qsort", true, run_qsort },
+  { "bsearch", false, run_bsearch },
+  { "unique", false, run_unique },
+  { "dup", false, run_dup },
+  { "print", false, run_print },
+};
+
+int main(int argc, char *argv[]) {
+  const char *types = "int,double,string";
+  const char *modes = "boxed,inline,parallel";
+  const char *ops = NULL;
+  const char *path = NULL;
+  size_t min_size = 1000;
+  size_t max_size = 1000000;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (!val) {
+      fprintf(stderr, "bench_calist: %s needs a value\n", arg);
+      return EXIT_FAILURE;
+    }
+    if (strcmp(arg, "--format") == 0) {
+      json = (strcmp(val, "json") == 0);
+    } else if (strcmp(arg, "--out") == 0) {
+      path = val;
+    } else if (strcmp(arg, "--min") == 0) {
+      min_size = strtoull(val, NULL, 10);
+    } else if (strcmp(arg, "--max") == 0) {
+      max_size = strtoull(val, NULL, 10);
+    } else if (strcmp(arg, "--types") == 0) {
+      types = val;
+    } else if (strcmp(arg, "--modes") == 0) {
+      modes = val;
+    } else if (strcmp(arg, "--ops") == 0) {
+      ops = val;
+    } else {
+      fprintf(stderr, "bench_calist: unknown option %s\n", arg);
+      return EXIT_FAILURE;
+    }
+    ++i;
+  }
+  if (min_size == 0) {
+    min_size = 1;
+  }
+
+  out = path ? fopen(path, "w") : stdout;
+  if (!out) {
+    perror(path);
+    return EXIT_FAILURE;
+  }
+  fputs(json ? "[" : "type,mode,op,size,ops,total_ns,ns_per_op\n", out);
+
+  for (size_t n = min_size; n <= max_size; n *= 10) {
+    for (int t = TYPE_INT; t <= TYPE_STRING; ++t) {
+      if (!listed(types, TYPE_NAMES[t])) continue;
+      for (int m = MODE_BOXED; m <= MODE_PARALLEL; ++m) {
+        if (!listed(modes, MODE_NAMES[m])) continue;
+
+        bench_case bc = { (bench_type) t, (bench_mode) m, n, NULL };
+        bc.base = create_list(&bc, n);
+        uint64_t seed = 88172645463325252u;
+        for (size_t i = 0; i < n; ++i) {
+          // xorshift64, so that sizes share a sequence of values
+          seed ^= seed << 13;
+          seed ^= seed >> 7;
+          seed ^= seed << 17;
+          bench_item buf;
+          calist_append(bc.base, make_item(bc.type, seed % n, &buf));
+        }
+
+        for (size_t k = 0; k < sizeof(OPS) / sizeof(OPS[0]); ++k) {
+          if (ops && !listed(ops, OPS[k].name)) continue;
+          if (m == MODE_PARALLEL && !OPS[k].parallel) continue;
+          OPS[k].run(&bc, OPS[k].name);
+        }
+        calist_destroy(bc.base);
+      }
+    }
+    if (n > max_size / 10) break;
+  }
+
+  fputs(json ? "\n]\n" : "", out);
+  if (out != stdout) {
+    fclose(out);
+  }
+  return EXIT_SUCCESS;
+}
+
+// Produce the current time of a monotonic clock in nanoseconds
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Emit the result of ops operations of bc taking ns nanoseconds in total
+static void report(const bench_case *bc, const char *op, size_t ops,
+                   uint64_t ns) {
+  double per_op = ops ? (double) ns / (double) ops : 0.0;
+  if (json) {
+    fprintf(out, "%s\n  {\"type\": \"%s\", \"mode\": \"%s\", "
+            "\"op\": \"%s\", \"size\": %zu, \"ops\": %zu, "
+            "\"total_ns\": %llu, \"ns_per_op\": %.3f}",
+            rows ? "," : "", TYPE_NAMES[bc->type], MODE_NAMES[bc->mode],
+            op, bc->size, ops, (unsigned long long) ns, per_op);
+  } else {
+    fprintf(out, "%s,%s,%s,%zu,%zu,%llu,%.3f\n", TYPE_NAMES[bc->type],
+            MODE_NAMES[bc->mode], op, bc->size, ops,
+            (unsigned long long) ns, per_op);
+  }
+  fflush(out);
+  ++rows;
+}
+
+// Produce the item of the given type for the value v, stored in buf
+static const void *make_item(bench_type type, size_t v, bench_item *buf) {
+  switch (type) {
+    case TYPE_INT:
+      buf->i = (int) v;
+      return &buf->i;
+    case TYPE_DOUBLE:
+      buf->d = (double) v + 0.5;
+      return &buf->d;
+    case TYPE_STRING:
+    default:
+      snprintf(buf->s, sizeof(buf->s), "item-%zu", v);
+      return buf->s;
+  }
+}
+
+// Create an empty calist of the type and storage mode of bc
+static calist *create_list(const bench_case *bc, size_t init_cap) {
+  const ctype *type = NULL;
+  switch (bc->type) {
+    case TYPE_INT:
+      type = ctype_int();
+      break;
+    case TYPE_DOUBLE:
+      type = ctype_double();
+      break;
+    case TYPE_STRING:
+      type = (bc->mode == MODE_BOXED) ? ctype_string() : ctype_sso_string();
+      break;
+  }
+  calist_storage storage = (bc->mode == MODE_BOXED)
+                         ? CALIST_STORAGE_BOXED : CALIST_STORAGE_INLINE;
+  return calist_create_storage(type, init_cap ? init_cap : 1, storage);
+}
+
+// Produce the number of repetitions of a linear operation on n items
+static size_t bench_reps(size_t n) {
+  size_t reps = BENCH_WORK / n;
+  if (reps < 1) return 1;
+  return (reps > BENCH_MAX_REPS) ? BENCH_MAX_REPS : reps;
+}
+
+// Produce true if name is an item of the comma-separated list
+static bool listed(const char *list, const char *name) {
+  size_t len = strlen(name);
+  for (const char *p = list; p; p = strchr(p, ',')) {
+    if (*p == ',') ++p;
+    if (strncmp(p, name, len) == 0 && (p[len] == ',' || p[len] == '\0')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool less_than(const calist *al, const void *item, const void *args) {
+  return data_cmp(item, args, calist_type(al)) < 0;
+}
+
+static bool equal_to(const calist *al, const void *item, const void *args) {
+  return data_cmp(item, args, calist_type(al)) == 0;
+}
+
+static size_t sink_discard(const char *buf, size_t n, void *ctx) {
+  (void) buf;
+  *(size_t *) ctx += n;
+  return n;
+}
+
+// Append size items to an empty list
+static void run_append(const bench_case *bc, const char *name) {
+  calist *al = create_list(bc, 1);
+  bench_item buf;
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < bc->size; ++i) {
+    calist_append(al, make_item(bc->type, i, &buf));
+  }
+  report(bc, name, bc->size, now_ns() - start);
+  calist_destroy(al);
+}
+
+// Insert items at the front of a list of size items
+static void run_insert_front(const bench_case *bc, const char *name) {
+  calist *al = calist_dup(bc->base);
+  size_t reps = bench_reps(bc->size);
+  bench_item buf;
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < reps; ++i) {
+    calist_insert_front(al, make_item(bc->type, i, &buf));
+  }
+  report(bc, name, reps, now_ns() - start);
+  calist_destroy(al);
+}
+
+// Pop the first item of a list of size items, which shifts the rest
+static void run_pop(const bench_case *bc, const char *name) {
+  calist *al = calist_dup(bc->base);
+  size_t reps = bench_reps(bc->size);
+  if (reps > bc->size) {
+    reps = bc->size;
+  }
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < reps; ++i) {
+    calist_pop(al, 0);
+  }
+  report(bc, name, reps, now_ns() - start);
+  calist_destroy(al);
+}
+
+// Remove about half of the items, those below the middle value
+static void run_remove_if(const bench_case *bc, const char *name) {
+  calist *al = calist_dup(bc->base);
+  bench_item buf;
+  const void *pivot = make_item(bc->type, bc->size / 2, &buf);
+  uint64_t start = now_ns();
+  calist_remove_if(al, less_than, pivot);
+  report(bc, name, bc->size, now_ns() - start);
+  calist_destroy(al);
+}
+
+// Search for an absent item, scanning the whole list
+static void run_index(const bench_case *bc, const char *name) {
+  size_t reps = bench_reps(bc->size);
+  bench_item buf;
+  const void *item = make_item(bc->type, bc->size, &buf);
+  size_t found = 0;
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < reps; ++i) {
+    found += (calist_index(bc->base, item) != CALIST_INDEX_NOT_FOUND);
+  }
+  uint64_t ns = now_ns() - start;
+  if (found) {
+    fprintf(stderr, "bench_calist: index found an absent item\n");
+  }
+  report(bc, name, reps, ns);
+}
+
+// Count the occurrences of the first item
+static void run_count(const bench_case *bc, const char *name) {
+  size_t reps = bench_reps(bc->size);
+  const void *item = calist_get(bc->base, 0);
+  size_t total = 0;
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < reps; ++i) {
+    total += (bc->mode == MODE_PARALLEL)
+           ? calist_par_count_if(bc->base, equal_to, item)
+           : calist_count(bc->base, item);
+  }
+  uint64_t ns = now_ns() - start;
+  if (total == 0) {
+    fprintf(stderr, "bench_calist: count missed a present item\n");
+  }
+  report(bc, name, reps, ns);
+}
+
+// Sort a copy of the list
+static void run_qsort(const bench_case *bc, const char *name) {
+  calist *al = calist_dup(bc->base);
+  uint64_t start = now_ns();
+  if (bc->mode == MODE_PARALLEL) {
+    calist_par_sort(al);
+  } else {
+    calist_qsort(al);
+  }
+  report(bc, name, 1, now_ns() - start);
+  calist_destroy(al);
+}
+
+// Look up items of the list in a sorted copy
+static void run_bsearch(const bench_case *bc, const char *name) {
+  calist *al = calist_dup(bc->base);
+  calist_sort(al);
+  size_t lookups = bc->size < BENCH_MAX_LOOKUPS
+                 ? bc->size : BENCH_MAX_LOOKUPS;
+  size_t missed = 0;
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < lookups; ++i) {
+    const void *item = calist_get(bc->base, i);
+    missed += (calist_bsearch(al, item) == CALIST_INDEX_NOT_FOUND);
+  }
+  uint64_t ns = now_ns() - start;
+  if (missed) {
+    fprintf(stderr, "bench_calist: bsearch missed a present item\n");
+  }
+  report(bc, name, lookups, ns);
+  calist_destroy(al);
+}
+
+static void run_unique(const bench_case *bc, const char *name) {
+  uint64_t start = now_ns();
+  calist *al = calist_unique(bc->base);
+  report(bc, name, 1, now_ns() - start);
+  calist_destroy(al);
+}
+
+static void run_dup(const bench_case *bc, const char *name) {
+  uint64_t start = now_ns();
+  calist *al = calist_dup(bc->base);
+  report(bc, name, 1, now_ns() - start);
+  calist_destroy(al);
+}
+
+// Format the list as calist_print does, discarding the text
+static void run_print(const bench_case *bc, const char *name) {
+  size_t bytes = 0;
+  uint64_t start = now_ns();
+  calist_write(bc->base, sink_discard, &bytes);
+  report(bc, name, 1, now_ns() - start);
+}
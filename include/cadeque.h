@@ -0,0 +1,189 @@
+// The cadeque module provides the cadeque ADT, a double-ended queue of
+//   items of one ctype.
+
+#ifndef CADEQUE_H
+#define CADEQUE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "calist.h"
+
+// A cadeque is a sequence of items of one ctype, indexed like a calist,
+//   with all items deeply copied into heap memory. Items are stored in a
+//   ring buffer: the slots wrap around the end of one array, and a head
+//   offset locates index 0. Pushing and popping at either end takes
+//   amortized O(1) time, where calist_insert_front and calist_pop(al, 0)
+//   shift every item, and cadeque_get takes O(1) time.
+//
+// Slots hold POD items inline and other items boxed, as in a calist. The
+//   capacity is 0 or a power of 2, and doubles when the cadeque is full.
+//
+// Memory model:
+//   - All inserted items are deeply copied into memory owned by the
+//     cadeque, and freed when removed or when it is destroyed.
+//   - With inline storage, pointers produced by cadeque_get are
+//     invalidated by any operation that adds or removes items.
+typedef struct cadeque cadeque;
+
+// cadeque_visit is a function applied to each item of dq
+//   [see cadeque_foreach].
+// parameters:
+//   - dq: the cadeque containing item (may be used for context or ignored)
+//   - item: a mutable pointer to the item being visited
+//   - args: optional external data (may be NULL)
+// requires: dq and item are not NULL
+// effects: may modify item
+// note: visit must not add or remove items of dq
+typedef void (*cadeque_visit)(const cadeque *dq,
+                              void *item,
+                              const void *args);
+
+// Method alias
+#define cadeque_length cadeque_size
+#define cadeque_append cadeque_push_back
+#define cadeque_insert_front cadeque_push_front
+
+// cadeque_create(type) creates an empty cadeque of items of type.
+// requires: type is not NULL
+// effects: allocates heap memory [caller must free with cadeque_destroy]
+// note: no slots are allocated until the first insertion
+cadeque *cadeque_create(const ctype *type);
+
+// cadeque_destroy(dq) frees dq and its items from the heap memory.
+// effects: frees heap memory [dq becomes invalid]
+// note: if dq is NULL, no operation is performed
+void cadeque_destroy(cadeque *dq);
+
+// cadeque_clear(dq) removes all items from dq, keeping its capacity.
+// requires: dq is not NULL
+// effects: modifies dq, frees heap memory
+void cadeque_clear(cadeque *dq);
+
+// cadeque_print(dq) displays the items of dq from front to back.
+// requires: dq is not NULL
+// effects: produces output
+void cadeque_print(const cadeque *dq);
+
+// cadeque_equals(d1, d2) produces true if d1 and d2 have the same type and
+//   contain equal items in the same order, and false otherwise.
+// requires: d1 and d2 are not NULL
+bool cadeque_equals(const cadeque *d1, const cadeque *d2);
+
+// cadeque_type(dq) produces the ctype of the items in dq.
+// requires: dq is not NULL
+const ctype *cadeque_type(const cadeque *dq);
+
+// cadeque_size(dq) produces the number of items in dq.
+// requires: dq is not NULL
+size_t cadeque_size(const cadeque *dq);
+
+// cadeque_empty(dq) produces true if dq is empty and false otherwise.
+// requires: dq is not NULL
+bool cadeque_empty(const cadeque *dq);
+
+// cadeque_capacity(dq) produces the number of slots of dq.
+// requires: dq is not NULL
+size_t cadeque_capacity(const cadeque *dq);
+
+// cadeque_reserve(dq, n) ensures dq can hold at least n items.
+// requires: dq is not NULL
+// effects: may allocate heap memory
+void cadeque_reserve(cadeque *dq, size_t n);
+
+// cadeque_reclaim(dq) sets the capacity of dq to the smallest power of 2
+//   holding its items, freeing the slots if dq is empty.
+// requires: dq is not NULL
+// effects: may modify dq, may reallocate heap memory
+void cadeque_reclaim(cadeque *dq);
+
+// cadeque_get(dq, index) produces a constant pointer to the item at the
+//   given index position in dq, where index 0 is the front.
+// requires: dq is not NULL
+//           0 <= index < cadeque_size(dq)
+const void *cadeque_get(const cadeque *dq, size_t index);
+
+// cadeque_get_mutable(dq, index) produces a mutable pointer to the item at
+//   the given index position in dq.
+// requires: dq is not NULL
+//           0 <= index < cadeque_size(dq)
+// warning: do not free the returned pointer
+void *cadeque_get_mutable(const cadeque *dq, size_t index);
+
+// cadeque_front(dq) and cadeque_back(dq) produce a constant pointer to the
+//   first and last item in dq.
+// requires: dq is not NULL and not empty
+const void *cadeque_front(const cadeque *dq);
+const void *cadeque_back(const cadeque *dq);
+
+// cadeque_set(dq, index, new_item) replaces the item at the given index
+//   position in dq with a deep copy of new_item.
+// requires: dq and new_item are not NULL
+//           0 <= index < cadeque_size(dq)
+// effects: modifies dq [frees the old item]
+void cadeque_set(cadeque *dq, size_t index, const void *new_item);
+
+// cadeque_push_back(dq, item) adds a deep copy of item to the back of dq,
+//   and cadeque_push_front(dq, item) adds it to the front.
+// requires: dq and item are not NULL
+// effects: modifies dq, allocates heap memory
+// time: O(1) amortized
+void cadeque_push_back(cadeque *dq, const void *item);
+void cadeque_push_front(cadeque *dq, const void *item);
+
+// cadeque_pop_back(dq) removes the last item in dq, and
+//   cadeque_pop_front(dq) removes the first.
+// requires: dq is not NULL and not empty
+// effects: modifies dq, frees heap memory
+// time: O(1)
+void cadeque_pop_back(cadeque *dq);
+void cadeque_pop_front(cadeque *dq);
+
+// cadeque_insert(dq, index, item) inserts a deep copy of item before the
+//   given index position in dq.
+// requires: dq and item are not NULL
+//           0 <= index <= cadeque_size(dq)
+// effects: modifies dq, allocates heap memory
+// time: O(min(index, size - index)) amortized, as the items on the
+//       shorter side of index are shifted
+void cadeque_insert(cadeque *dq, size_t index, const void *item);
+
+// cadeque_pop(dq, index) removes the item at the given index position in
+//   dq.
+// requires: dq is not NULL
+//           0 <= index < cadeque_size(dq)
+// effects: modifies dq, frees heap memory
+// time: O(min(index, size - index)) [see cadeque_insert]
+void cadeque_pop(cadeque *dq, size_t index);
+
+// cadeque_index(dq, item) produces the index position of the first item
+//   in dq equal to item, or CALIST_INDEX_NOT_FOUND if there is none.
+// requires: dq and item are not NULL
+size_t cadeque_index(const cadeque *dq, const void *item);
+
+// cadeque_contains(dq, item) produces true if dq contains an item equal to
+//   item, and false otherwise.
+// requires: dq and item are not NULL
+bool cadeque_contains(const cadeque *dq, const void *item);
+
+// cadeque_foreach(dq, visit, args) applies visit to each item of dq from
+//   front to back, where args provides additional arguments to the visit
+//   function.
+// requires: dq and visit are not NULL
+// effects: may modify the items of dq
+void cadeque_foreach(const cadeque *dq, cadeque_visit visit,
+                     const void *args);
+
+// cadeque_from_calist(al) creates a cadeque holding copies of the items of
+//   al, in order.
+// requires: al is not NULL
+// effects: allocates heap memory [caller must free with cadeque_destroy]
+cadeque *cadeque_from_calist(const calist *al);
+
+// cadeque_to_calist(dq) produces a calist holding copies of the items of
+//   dq, from front to back.
+// requires: dq is not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *cadeque_to_calist(const cadeque *dq);
+
+#endif
@@ -3,7 +3,9 @@
 #ifndef CALIST_H
 #define CALIST_H
 
+#include <stdio.h>
 #include "ctype.h"
+#include "cpool.h"
 
 // A calist stores items in a dynamically resizable array,
 // with all items deeply copied into heap memory.
@@ -12,15 +14,28 @@
 // for all stored items. Type-specific behaviors (duplication, comparison,
 // printing, and deallocation) are handled through the ctype interface.
 //
+// Storage modes (see calist_storage):
+//   - boxed:  each item is deeply copied into separately allocated heap 
+//             memory and the calist stores pointers to the copies
+//   - inline: items of POD ctypes are copied directly into one contiguous
+//             buffer without per-item allocation
+//   calist_create and calist_create_size select inline storage for POD 
+//   ctypes (including the built-in numeric ctypes) and boxed storage 
+//   otherwise.
+//
 // Memory model:
-//   - All inserted items are deeply copied into separately allocated 
-//     heap memory.
+//   - All inserted items are deeply copied into memory owned by the calist.
 //   - Stack-allocated or heap-allocated objects are both safe to insert;
 //     the calist duplicates them internally.
 //   - Stored items are automatically freed when individually removed or
 //     when the calist is destroyed.
 //   - Clients are responsible for freeing the original heap-allocated 
 //     objects after insertion to avoid memory leaks.
+//   - Ownership can also be transferred instead of copied: the *_owned 
+//     functions adopt an item created by data_dup_with(..., type, 
+//     calist_allocator(al)) [data_dup for the default allocator], and 
+//     calist_take detaches an item that the client must later free with
+//     data_destroy_with(..., type, calist_allocator(al)).
 //
 // Example:
 //   int temp = 10;
@@ -61,6 +76,176 @@ typedef void (*calist_map)(const calist *al,
                            void *item, 
                            const void *args);
 
+// calist_cmp is a comparison function on two items, item1 and item2,
+//   of a calist.
+// requires: item1 and item2 are not NULL
+// note: returns 0 if equal, <0 if item1 < item2, >0 if item1 > item2
+typedef int (*calist_cmp)(const void *item1, const void *item2);
+
+// calist_reduce is an accumulation function that folds the given item in 
+//   al into the accumulator acc.
+// parameters:
+//   - al: the calist containing item (may be used for context or ignored)
+//   - acc: the accumulator to be updated
+//   - item: the item to be folded into acc
+//   - args: optional external data (may be NULL)
+// requires: al, acc and item are not NULL
+// effects: modifies acc
+typedef void (*calist_reduce)(const calist *al, 
+                              void *acc, 
+                              const void *item, 
+                              const void *args);
+
+// calist_combine is a function that merges the accumulator part, which 
+//   covers later items than acc, into the accumulator acc.
+// parameters:
+//   - acc: the accumulator to be updated
+//   - part: the accumulator to be merged into acc
+//   - args: optional external data (may be NULL)
+// requires: acc and part are not NULL
+// effects: modifies acc
+typedef void (*calist_combine)(void *acc, 
+                               const void *part, 
+                               const void *args);
+
+// calist_sink is an output function, like fwrite, that receives the text 
+//   of a calist in consecutive chunks.
+// parameters:
+//   - buf: the next n characters of text [not null-terminated]
+//   - n: the number of characters at buf
+//   - ctx: the context pointer given to calist_write (may be NULL)
+// note: returns the number of characters consumed; returning fewer than n
+//       stops the output
+typedef size_t (*calist_sink)(const char *buf, size_t n, void *ctx);
+
+// A calist_view is a read-only window onto the items of a calist at index
+//   positions [offset, offset + length), which copies nothing and
+//   allocates no memory [see calist_view_of]. Views are passed by value.
+//   A view reads the items of its calist in place, so it sees changes to
+//   them, and index positions it produces are relative to its offset.
+//
+// A view stays valid while its calist keeps the same slots and still
+//   holds the whole range: growing or shrinking storage, or a write to a
+//   snapshot that gives the calist storage of its own, advances the
+//   generation of the calist and invalidates its views, which the view
+//   functions assert [see calist_view_valid].
+// note: the layout is public only so that views can live on the stack;
+//       use the functions below instead of the fields
+typedef struct {
+  const calist *parent;
+  size_t offset;
+  size_t length;
+  size_t generation;  // of parent when the view was made
+} calist_view;
+
+// The leading fields of every calist.
+// note: the layout is public only so that the unchecked accessors below
+//       can be inlined at call sites; use the functions instead of the
+//       fields
+typedef struct {
+  unsigned char *data;
+  const ctype *type;
+  size_t size;
+  size_t width;   // the size of a slot in bytes
+  bool boxed;     // slots hold pointers to the items
+  bool slotted;   // inline slots filled through data_slot_store
+} calist_core;
+
+// calist_storage selects how a calist stores its items.
+//   - CALIST_STORAGE_AUTO:   inline for POD and slotted ctypes, boxed 
+//                            otherwise
+//   - CALIST_STORAGE_BOXED:  one heap allocation per item; item addresses
+//                            stay valid until the item is removed
+//   - CALIST_STORAGE_INLINE: items packed contiguously [POD ctypes, or 
+//                            slotted ctypes such as ctype_sso_string(), 
+//                            see data_slot_size]; item addresses are 
+//                            invalidated whenever the calist grows, 
+//                            shrinks, or shifts its items
+typedef enum {
+  CALIST_STORAGE_AUTO,
+  CALIST_STORAGE_BOXED,
+  CALIST_STORAGE_INLINE,
+} calist_storage;
+
+// calist_mapped_flags are the flags of calist_create_mapped, combined
+//   with |.
+//   - CALIST_MAPPED_TRUNCATE:   discard the existing contents of the file
+//   - CALIST_MAPPED_SEQUENTIAL: advise the operating system that items 
+//                               are mostly accessed in order
+//   - CALIST_MAPPED_RANDOM:     advise the operating system that items 
+//                               are mostly accessed at random
+typedef enum {
+  CALIST_MAPPED_DEFAULT = 0,
+  CALIST_MAPPED_TRUNCATE = 1 << 0,
+  CALIST_MAPPED_SEQUENTIAL = 1 << 1,
+  CALIST_MAPPED_RANDOM = 1 << 2,
+} calist_mapped_flags;
+
+// calist_growth describes how a calist resizes its storage on its own.
+// fields:
+//   - factor:         the capacity is multiplied by factor whenever a
+//                     full calist grows
+//   - min_capacity:   the smallest capacity a calist grows or shrinks to
+//   - huge_threshold: storage of at least huge_threshold bytes grows and
+//                     shrinks in whole multiples of huge_page bytes, so
+//                     that large calists can be backed by huge pages
+//                     (0 disables the rounding)
+//   - huge_page:      the rounding unit for large storage, in bytes
+//   - shrink_below:   once removals leave fewer than shrink_below *
+//                     capacity items, the capacity shrinks to factor
+//                     times the size (0 disables shrinking)
+// requires: factor > 1
+//           min_capacity > 0
+//           huge_page > 0 if huge_threshold > 0
+//           0 <= shrink_below and shrink_below * factor < 1 [a calist
+//           that has just shrunk must grow by (factor - 1) * size items,
+//           or lose most of its items again, before it resizes again]
+// note: calist_reserve and calist_reclaim resize to exactly the capacity
+//       requested, regardless of the growth policy
+typedef struct {
+  double factor;
+  size_t min_capacity;
+  size_t huge_threshold;
+  size_t huge_page;
+  double shrink_below;
+} calist_growth;
+
+// The growth policy of a new calist: doubling from a capacity of at least
+//   8, 2 MiB-rounded above 4 MiB, and no automatic shrinking
+extern const calist_growth CALIST_GROWTH_DEFAULT;
+
+// calist_counters counts the work a calist has done since it was created
+//   or its counters were reset, while CALIST_STATS is enabled [see ctype.h].
+// fields:
+//   - dups:          items copied into the calist [data_dup_with, or 
+//                    data_slot_store for slotted ctypes]
+//   - destroys:      items freed by the calist
+//   - reallocs:      resizes of the storage [growth, calist_reserve, 
+//                    calist_reclaim and shrinking]
+//   - bytes_moved:   bytes of items the resizes had to carry over
+//   - shifted:       items moved one or more positions by inserting or 
+//                    removing items before them
+//   - peak_size:     the largest number of items held
+//   - peak_capacity: the largest capacity reached
+// note: shifted growing as the square of peak_size points at repeated 
+//       inserts or pops at the front of a large calist
+typedef struct {
+  size_t dups;
+  size_t destroys;
+  size_t reallocs;
+  size_t bytes_moved;
+  size_t shifted;
+  size_t peak_size;
+  size_t peak_capacity;
+} calist_counters;
+
+// calist_stats_hook receives the final counters of each calist when it 
+//   is destroyed, before its items are freed, along with the context 
+//   given to calist_set_stats_hook.
+typedef void (*calist_stats_hook)(const calist *al, 
+                                  const calist_counters *stats,
+                                  void *ctx);
+
 // The return value if an item is not in calist (SIZE_MAX)
 extern const size_t CALIST_INDEX_NOT_FOUND;
 
@@ -85,6 +270,77 @@ calist *calist_create(const ctype *type);
 // effects: allocates heap memory [caller must free with calist_destroy]
 calist *calist_create_size(const ctype *type, size_t init_cap);
 
+// calist_create_storage(type, init_cap, storage) creates an empty calist 
+//   of the given type with an initial capacity of init_cap, using the
+//   given storage mode.
+// requires: type is not NULL
+//           init_cap > 0
+//           type is a POD or slotted ctype if storage is 
+//           CALIST_STORAGE_INLINE
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *calist_create_storage(const ctype *type, size_t init_cap,
+                              calist_storage storage);
+
+// calist_create_alloc(type, init_cap, storage, alloc) creates an empty 
+//   calist like calist_create_storage, drawing the calist, its storage 
+//   and its items from alloc. Calists produced from it (calist_dup, 
+//   calist_slice, calist_filter, calist_unique) use alloc as well.
+// requires: type and alloc are not NULL
+//           init_cap > 0
+//           type is a POD or slotted ctype if storage is 
+//           CALIST_STORAGE_INLINE
+// effects: allocates memory from alloc [caller must free with 
+//          calist_destroy, or release all of it with callocator_reset]
+// note: alloc must outlive the calist
+//       items of ctypes that are not allocator-aware are still created
+//       with their dup method [see data_dup_with]
+calist *calist_create_alloc(const ctype *type, size_t init_cap,
+                            calist_storage storage, 
+                            const callocator *alloc);
+
+// calist_create_from_array(type, base, n) creates a calist of the given
+//   type containing the n items of the array base, in order, where each
+//   item takes data_size(type) bytes [see calist_append_array].
+// requires: type is not NULL and is not a string ctype
+//           base is not NULL if n > 0
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *calist_create_from_array(const ctype *type, const void *base,
+                                 size_t n);
+
+// calist_create_mapped(type, path, flags) creates a calist of the given
+//   type whose inline storage is the file at path, mapped into memory, so
+//   that the operating system pages its items in and out on demand. A 
+//   file left by an earlier mapped calist of a type of the same size is
+//   reopened with its items in place, without copying them; otherwise the
+//   calist starts empty [see calist_mapped_flags].
+// requires: type and path are not NULL
+//           type is a POD ctype
+//           flags does not contain both CALIST_MAPPED_SEQUENTIAL and
+//           CALIST_MAPPED_RANDOM
+// effects: may create or modify the file at path, allocates heap memory
+//          [caller must free with calist_destroy, which also records the
+//          items in the file and trims it to them]
+// notes:
+//   - returns NULL if the file cannot be opened or mapped, or holds the
+//     items of a calist of a different item size
+//   - the file grows and shrinks with the capacity of the calist; changes
+//     to its items reach the file as the operating system writes back 
+//     the mapping, and the number of items is recorded by calist_sync and
+//     calist_destroy
+//   - calists produced from a mapped calist (calist_dup, calist_slice, 
+//     calist_filter, calist_unique) are stored in memory
+//   - the file must not be mapped by another calist at the same time
+calist *calist_create_mapped(const ctype *type, const char *path, 
+                             int flags);
+
+// calist_sync(al) records the items of the mapped calist al in its file
+//   and waits for them to be written, producing true on success and false
+//   otherwise. For a calist stored in memory, calist_sync has no effect
+//   and produces true.
+// requires: al is not NULL
+// effects: may modify the file of al
+bool calist_sync(calist *al);
+
 // calist_destroy(al) frees al and its items from the heap memory.
 // effects: frees heap memory [al becomes invalid]
 void calist_destroy(calist *al);
@@ -103,12 +359,88 @@ void calist_clear(calist *al);
 // effects: allocates heap memory [caller must free with calist_destroy]
 calist *calist_dup(const calist *al);
 
+// calist_snapshot(al) creates a copy of al that shares the storage and 
+//   items of al instead of copying them. Sharing calists behave like 
+//   independent copies: the first operation that modifies one of them 
+//   (including calist_get_mutable, calist_foreach and the sorts) gives it 
+//   storage of its own, copying the items like calist_dup. Snapshots of a 
+//   snapshot share the same storage.
+// requires: al is not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+// time: O(1); the copy on the first modification is O(n)
+// notes:
+//   - the shared storage is freed with the last calist sharing it
+//   - sharing calists may be used and destroyed on different threads, 
+//     and calist_snapshot may run concurrently with other reads of al
+//   - items must not be modified through pointers from calist_get, which
+//     would change them in every sharing calist
+//   - a snapshot of a mapped calist is an in-memory copy [see 
+//     calist_create_mapped]
+calist *calist_snapshot(const calist *al);
+
+// calist_shares_storage(l1, l2) produces true if l1 and l2 share their
+//   storage through calist_snapshot and neither has been modified since,
+//   and false otherwise.
+// requires: l1 and l2 are not NULL
+bool calist_shares_storage(const calist *l1, const calist *l2);
+
 // calist_print(al) displays al in the format [X, Y, ...], where 
-//   X, Y, ... are items of al.
+//   X, Y, ... are items of al [see calist_write].
 // requires: al is not NULL
 // effects: produces output
 void calist_print(const calist *al);
 
+// calist_write(al, sink, ctx) passes the text that calist_print displays,
+//   without the trailing newline, to sink with the context ctx. The text 
+//   is formatted through the format method of the ctype of al and handed
+//   to sink in large batches.
+// requires: al and sink are not NULL
+//           the ctype of al has a format method [see ctype_has_format]
+// effects: calls sink
+// note: returns true if sink consumed all of the text, and false otherwise
+//       no memory is allocated unless the text of some item exceeds 4 KiB
+bool calist_write(const calist *al, calist_sink sink, void *ctx);
+
+// calist_format(al, buf, cap) writes the text of calist_write into buf, 
+//   null-terminated and truncated to cap - 1 characters, and produces the 
+//   length of the full text [like snprintf].
+// requires: al is not NULL
+//           buf is not NULL if cap > 0
+//           the ctype of al has a format method [see ctype_has_format]
+// effects: modifies buf if cap > 0
+size_t calist_format(const calist *al, char *buf, size_t cap);
+
+// calist_save(al, out) writes al to out in a versioned binary format: a
+//   header recording the kind of ctype, the item size, the number of 
+//   items and a checksum, followed by the items [see calist_load]. POD 
+//   items are written as their bytes, and other items through their 
+//   serialize method [see ctype_has_serialize].
+// requires: al and out are not NULL
+//           the ctype of al can be serialized
+// effects: produces output to out
+// notes:
+//   - returns true if al was written in full, and false otherwise
+//   - the format uses the native byte order and type layout, so a saved 
+//     calist can only be loaded on a compatible platform
+//   - several calists may be saved to the same stream one after another
+bool calist_save(const calist *al, FILE *out);
+
+// calist_load(type, in) reads a calist of the given type saved by
+//   calist_save from in. The items of a POD ctype are read straight into
+//   the inline storage of the new calist, without per-item work.
+// requires: type and in are not NULL
+//           type can be serialized
+// effects: reads from in, allocates heap memory [caller must free with 
+//          calist_destroy]
+// notes:
+//   - returns NULL if in does not hold a calist saved by calist_save, 
+//     holds one of a different kind of ctype or item size, is truncated,
+//     or fails its checksum
+//   - reads exactly the bytes written by calist_save for a calist that
+//     loads successfully
+//   - see calist_create_mapped to reopen a file without reading it
+calist *calist_load(const ctype *type, FILE *in);
+
 // calist_equals(l1, l2) produces true if l1 and l2 have identical size, 
 //   type, and items; false otherwise.
 // requires: l1 and l2 are not NULL
@@ -131,18 +463,62 @@ bool calist_empty(const calist *al);
 // requires: al is not NULL
 size_t calist_capacity(const calist *al);
 
+// calist_allocator(al) produces the callocator of al.
+// requires: al is not NULL
+const callocator *calist_allocator(const calist *al);
+
+// calist_storage_mode(al) produces the storage mode of al, which is
+//   either CALIST_STORAGE_BOXED or CALIST_STORAGE_INLINE.
+// requires: al is not NULL
+calist_storage calist_storage_mode(const calist *al);
+
+// calist_growth_policy(al) produces the growth policy of al.
+// requires: al is not NULL
+calist_growth calist_growth_policy(const calist *al);
+
+// calist_set_growth_policy(al, growth) makes al resize its storage 
+//   according to growth [see calist_growth] from now on. Calists 
+//   produced from al (calist_dup, calist_slice, calist_filter, 
+//   calist_unique) inherit the policy.
+// requires: al and growth are not NULL
+//           growth satisfies the requirements of calist_growth
+// effects: modifies al, may reallocate heap memory [al shrinks at once
+//          if the new policy calls for it]
+void calist_set_growth_policy(calist *al, const calist_growth *growth);
+
 // calist_reserve(al, n) ensures al can hold at least n items.
 // requires: al is not NULL
 // effects: may allocate heap memory
 // note: if al has more than n items, calist_reserve has no effect
 void calist_reserve(calist *al, size_t n);
 
-// calist_reclaim(al) sets al's capacity to al's current size.
+// calist_reclaim(al) sets al's capacity to al's current size, or to 1
+//   if al is empty.
 // requires: al is not NULL
 // effects: may modify al, may reallocate heap memory
-// note: if al's capacity is equal to al's size, calist_reclaim has no effect
+// note: if al's capacity is already that size, calist_reclaim has no effect
 void calist_reclaim(calist *al);
 
+// calist_stats(al, out) stores the counters of al in out, which are all 0
+//   unless CALIST_STATS is enabled [see calist_counters].
+// requires: al and out are not NULL
+// effects: modifies *out
+void calist_stats(const calist *al, calist_counters *out);
+
+// calist_stats_reset(al) sets the counters of al to 0, and its peaks to 
+//   its current size and capacity.
+// requires: al is not NULL
+// effects: modifies al
+void calist_stats_reset(calist *al);
+
+// calist_set_stats_hook(hook, ctx) makes calist_destroy pass the counters
+//   of each calist to hook with ctx while CALIST_STATS is enabled, 
+//   e.g. to feed a metrics exporter. A NULL hook removes it.
+// effects: modifies the global hook
+// note: set the hook before creating calists on other threads; hook runs
+//       on the thread that destroys the calist
+void calist_set_stats_hook(calist_stats_hook hook, void *ctx);
+
 // calist_get(al, index) produces a constant pointer to the item 
 //   at the given index position in al.
 // requires: al is not NULL and not empty
@@ -151,14 +527,59 @@ void calist_reclaim(calist *al);
 //   - calist_get protects the contents of al by returning a 
 //     constant pointer, preventing direct modification
 //   - call calist_get_mutable to modify an item in-place
+//   - with inline storage, the returned pointer is invalidated by any
+//     operation that adds or removes items
 const void *calist_get(const calist *al, size_t index);
 
+// calist_get_unchecked(al, index) produces a constant pointer to the item
+//   at the given index position in al like calist_get, but checks none of
+//   its requirements and is inlined at the call site, for loops that
+//   already keep index in bounds.
+// requires: al is not NULL
+//           0 <= index < calist_size(al) [not asserted]
+// note: see calist_get
+static inline const void *calist_get_unchecked(const calist *al, 
+                                               size_t index) {
+  const calist_core *core = (const calist_core *) al;
+  const unsigned char *slot = core->data + index * core->width;
+  if (core->boxed) {
+    return *(void *const *) slot;
+  }
+  return core->slotted ? data_slot_value(slot, core->type) : slot;
+}
+
+// calist_size_unchecked(al) produces the number of items in al like
+//   calist_size, inlined at the call site.
+// requires: al is not NULL [not asserted]
+static inline size_t calist_size_unchecked(const calist *al) {
+  return ((const calist_core *) al)->size;
+}
+
+// calist_data(al) produces a constant pointer to the items of al, which
+//   has inline storage of a POD ctype: item i is at calist_data(al) + 
+//   i * data_size(calist_type(al)), for 0 <= i < calist_size(al).
+// requires: al is not NULL
+//           al has inline storage and a POD ctype [not asserted]
+// notes:
+//   - the pointer is invalidated by any operation that adds or removes
+//     items of al
+//   - modify items through calist_get_mutable, which first gives al 
+//     storage of its own if it shares it [see calist_snapshot]
+static inline const void *calist_data(const calist *al) {
+  return ((const calist_core *) al)->data;
+}
+
 // calist_get_mutable(al, index) produces a mutable pointer to the item 
 //   at the given index position in al.
 // requires: al is not NULL and not empty
 //           0 <= index < calist_size(al)
 // warning: do not free the returned pointer, as doing so will result
 //          in a double free when removing the item or destroying al
+// notes:
+//   - with inline storage, the returned pointer is invalidated by any
+//     operation that adds or removes items
+//   - if al shares its storage [see calist_snapshot], al first gets
+//     storage of its own
 void *calist_get_mutable(const calist *al, size_t index);
 
 // calist_set(al, index, new_item) replaces the old item at the given 
@@ -169,6 +590,18 @@ void *calist_get_mutable(const calist *al, size_t index);
 // effects: modifies al [replaces the old item]
 void calist_set(calist *al, size_t index, const void *new_item);
 
+// calist_set_owned(al, index, new_item) replaces the old item at the 
+//   given index position in al with new_item, taking ownership of 
+//   new_item instead of copying it.
+// requires: al is not NULL and not empty
+//           0 <= index < calist_size(al)
+//           new_item is not NULL and owned by the caller [see memory 
+//           model above]
+// effects: modifies al [replaces the old item], frees heap memory
+//          [new_item is owned by al]
+// note: for inline storage, new_item is copied into its slot and freed
+void calist_set_owned(calist *al, size_t index, void *new_item);
+
 // calist_swap(al, i, j) swaps the items at index positions i and j in al.
 // requires: al is not NULL and not empty
 //           0 <= i < calist_size(al)
@@ -181,11 +614,31 @@ void calist_swap(calist *al, size_t i, size_t j);
 // effects: modifies al, allocates heap memory
 void calist_append(calist *al, const void *item);
 
+// calist_append_owned(al, item) adds item to the back of al, taking 
+//   ownership of item instead of copying it [see calist_insert_owned].
+// requires: al is not NULL
+//           item is not NULL and owned by the caller [see memory model 
+//           above]
+// effects: modifies al [item is owned by al]
+void calist_append_owned(calist *al, void *item);
+
 // calist_append_all(al, src) adds all items in src to the back of al.
 // requires: al and src are not NULL and have the same type
 // effects: modifies al, allocates heap memory
 void calist_append_all(calist *al, const calist *src);
 
+// calist_append_array(al, base, n) adds the n items of the array base to 
+//   the back of al, in order, where item i is at base + i * 
+//   data_size(calist_type(al)).
+// requires: al is not NULL
+//           base is not NULL if n > 0
+//           the ctype of al is not a string ctype [strings have no fixed
+//           size; append them one at a time]
+// effects: modifies al, allocates heap memory
+// note: reserves capacity once; items are copied with one memcpy for 
+//       inline storage and duplicated one by one for boxed storage
+void calist_append_array(calist *al, const void *base, size_t n);
+
 // calist_insert(al, index, item) inserts item before the given index 
 //   position in al (shifting existing items to the right).
 // requires: al and item are not NULL
@@ -193,9 +646,21 @@ void calist_append_all(calist *al, const calist *src);
 // effects: modifies al, allocates heap memory
 void calist_insert(calist *al, size_t index, const void *item);
 
+// calist_insert_owned(al, index, item) inserts item before the given 
+//   index position in al, taking ownership of item instead of copying it.
+// requires: al is not NULL
+//           item is not NULL and owned by the caller [see memory model 
+//           above]
+//           0 <= index <= calist_size(al)
+// effects: modifies al [item is owned by al]
+// note: for inline storage, item is copied into its slot and freed
+void calist_insert_owned(calist *al, size_t index, void *item);
+
 // calist_insert_front(al, item) inserts item to the beginning of al.
 // requires: al and item are not NULL
 // effects: modifies al, allocates heap memory
+// note: takes O(n) time, shifting every item; a cadeque pushes and pops
+//       at both ends in O(1) time [see cadeque.h]
 void calist_insert_front(calist *al, const void *item);
 
 // calist_insert_all(al, index, src) inserts all items in src before the 
@@ -205,12 +670,40 @@ void calist_insert_front(calist *al, const void *item);
 // effects: modifies al, allocates heap memory
 void calist_insert_all(calist *al, size_t index, const calist *src);
 
+// calist_insert_array(al, index, base, n) inserts the n items of the 
+//   array base before the given index position in al, in order
+//   [see calist_append_array].
+// requires: al is not NULL
+//           base is not NULL if n > 0
+//           0 <= index <= calist_size(al)
+//           the ctype of al is not a string ctype
+// effects: modifies al, allocates heap memory
+void calist_insert_array(calist *al, size_t index, const void *base, 
+                         size_t n);
+
 // calist_pop(al, index) removes the item at the given index position in al.
 // requires: al is not NULL and not empty
 //           0 <= index < calist_size(al)
 // effects: modifies al, frees heap memory
 void calist_pop(calist *al, size_t index);
 
+// calist_take(al, index) removes the item at the given index position in 
+//   al and produces it without destroying it.
+// requires: al is not NULL and not empty
+//           0 <= index < calist_size(al)
+// effects: modifies al [the produced item is owned by the caller, who 
+//          must free it with data_destroy_with(item, calist_type(al), 
+//          calist_allocator(al))]
+// note: for inline storage, the item is copied into memory from the 
+//       allocator of al
+void *calist_take(calist *al, size_t index);
+
+// calist_pop_back_take(al) removes the last item in al and produces it
+//   without destroying it [see calist_take].
+// requires: al is not NULL and not empty
+// effects: modifies al [the produced item is owned by the caller]
+void *calist_pop_back_take(calist *al);
+
 // calist_remove(al, item) removes the first occurrence of item in al.
 // requires: al is not NULL and not empty
 //           item is not NULL
@@ -232,6 +725,7 @@ size_t calist_remove_last(calist *al, const void *item);
 //           item is not NULL
 // effects: modifies al, frees heap memory
 // note: returns the number of items removed
+// time: O(n), where n is the size of al
 size_t calist_remove_all(calist *al, const void *item);
 
 // calist_remove_if(al, pred, args) removes all items in al that satisfies 
@@ -240,6 +734,9 @@ size_t calist_remove_all(calist *al, const void *item);
 //           pred is not NULL
 // effects: modifies al, frees heap memory
 // note: returns the number of items removed
+//       pred is applied to the items in order; while pred runs, al holds
+//       only the items kept so far, and pred must not modify al
+// time: O(n), where n is the size of al
 size_t calist_remove_if(calist *al, calist_pred pred, const void *args);
 
 // calist_remove_range(al, from_index, to_index) removes all items in al
@@ -248,6 +745,7 @@ size_t calist_remove_if(calist *al, calist_pred pred, const void *args);
 //           0 <= from_index < calist_size(al)
 //           from_index <= to_index <= calist_size(al)
 // effects: modifies al, frees heap memory
+// time: O(calist_size(al) - from_index)
 void calist_remove_range(calist *al, size_t from_index, size_t to_index);
 
 // calist_contains(al, item) produces true if al contains item
@@ -284,6 +782,16 @@ calist *calist_index_all_if(const calist *al, calist_pred pred,
 // requires: al and item are not NULL
 size_t calist_count(const calist *al, const void *item);
 
+// calist_index_min(al) produces the index position of the first smallest
+//   item in al and CALIST_INDEX_NOT_FOUND if al is empty.
+// requires: al is not NULL
+size_t calist_index_min(const calist *al);
+
+// calist_index_max(al) produces the index position of the first largest
+//   item in al and CALIST_INDEX_NOT_FOUND if al is empty.
+// requires: al is not NULL
+size_t calist_index_max(const calist *al);
+
 // calist_replace(al, old_item, new_item) replaces the first occurrence of 
 //   old_item in al with new_item.
 // requires: al, old_item, and new_item are not NULL
@@ -319,7 +827,28 @@ size_t calist_replace_all(calist *al, const void *old_item,
 size_t calist_replace_if(calist *al, const void *new_item, 
                          calist_pred pred, const void *args);
 
-// calist_qsort(al) sorts al using the quicksort algorithm.
+// calist_sort(al) sorts al in ascending order using introsort.
+// requires: al is not NULL
+// effects: modifies al
+// time: O(n log n) worst case, where n is the size of al
+// note: the sort is not stable
+void calist_sort(calist *al);
+
+// calist_stable_sort(al) sorts al in ascending order using timsort, 
+//   keeping equal items in their original relative order.
+// requires: al is not NULL
+// effects: modifies al, may allocate and free heap memory
+// time: O(n log n) worst case; close to O(n) if al consists of a few
+//       ascending or descending runs
+void calist_stable_sort(calist *al);
+
+// calist_sort_by(al, cmp) stably sorts al in ascending order as defined
+//   by cmp instead of the ctype of al [see calist_stable_sort].
+// requires: al and cmp are not NULL
+// effects: modifies al, may allocate and free heap memory
+void calist_sort_by(calist *al, calist_cmp cmp);
+
+// calist_qsort(al) sorts al in ascending order [same as calist_sort].
 // requires: al is not NULL
 // effects: modifies al
 void calist_qsort(calist *al);
@@ -330,6 +859,33 @@ void calist_qsort(calist *al);
 //           al must be sorted in ascending order [not asserted]
 size_t calist_bsearch(const calist *al, const void *item);
 
+// calist_lower_bound(al, item) produces the index of the first item in al
+//   that is not less than item, or calist_size(al) if there is none. This
+//   is the first position at which item can be inserted keeping al sorted.
+// requires: al and item are not NULL
+//           al must be sorted in ascending order [not asserted]
+// time: O(log n)
+size_t calist_lower_bound(const calist *al, const void *item);
+
+// calist_upper_bound(al, item) produces the index of the first item in al
+//   that is greater than item, or calist_size(al) if there is none. This
+//   is the last position at which item can be inserted keeping al sorted.
+// requires: al and item are not NULL
+//           al must be sorted in ascending order [not asserted]
+// time: O(log n)
+size_t calist_upper_bound(const calist *al, const void *item);
+
+// calist_equal_range(al, item, from_index, to_index) stores the bounds of
+//   the items equal to item in al at from_index and to_index, so that
+//   they are at [*from_index, *to_index); the range is empty if item is
+//   not in al.
+// requires: al, item, from_index and to_index are not NULL
+//           al must be sorted in ascending order [not asserted]
+// effects: modifies *from_index and *to_index
+// time: O(log n)
+void calist_equal_range(const calist *al, const void *item,
+                        size_t *from_index, size_t *to_index);
+
 // calist_reverse(al) reverses the order of items in al.
 // requires: al is not NULL
 // effects: modifies al
@@ -341,8 +897,70 @@ void calist_reverse(calist *al);
 //           0 <= from_index < calist_size(al)
 //           from_index <= to_index <= calist_size(al)
 // effects: allocates heap memory [caller must free with calist_destroy]
+// note: calist_view_of reads a range without copying it
 calist *calist_slice(const calist *al, size_t from_index, size_t to_index);
 
+// calist_view_of(al, from_index, to_index) produces a view of the items
+//   of al from index position from_index to (to_index - 1), inclusive.
+// requires: al is not NULL
+//           from_index <= to_index <= calist_size(al)
+// note: the view is invalidated when al's storage moves [see calist_view]
+calist_view calist_view_of(const calist *al, size_t from_index, 
+                           size_t to_index);
+
+// calist_view_slice(view, from_index, to_index) produces a view of the
+//   items of view from index position from_index to (to_index - 1).
+// requires: view is valid
+//           from_index <= to_index <= calist_view_size(view)
+calist_view calist_view_slice(calist_view view, size_t from_index, 
+                              size_t to_index);
+
+// calist_view_valid(view) produces true if the calist of view still has
+//   the slots it had when view was made, and holds the whole range of
+//   view, and false otherwise.
+// requires: the calist of view has not been destroyed
+bool calist_view_valid(calist_view view);
+
+// calist_view_parent(view) produces the calist of view.
+const calist *calist_view_parent(calist_view view);
+
+// calist_view_type(view) produces the ctype of the items of view.
+const ctype *calist_view_type(calist_view view);
+
+// calist_view_size(view) produces the number of items in view, and
+//   calist_view_empty(view) produces true if there are none.
+size_t calist_view_size(calist_view view);
+bool calist_view_empty(calist_view view);
+
+// calist_view_get(view, index) produces a constant pointer to the item at
+//   the given index position in view.
+// requires: view is valid
+//           0 <= index < calist_view_size(view)
+const void *calist_view_get(calist_view view, size_t index);
+
+// The following functions behave like their calist counterparts
+//   [calist_index ... calist_print] on the items of view, producing index
+//   positions in view.
+// requires: view [or v1 and v2] is valid
+//           item is not NULL
+//           view must be sorted in ascending order for bsearch, 
+//           lower_bound and upper_bound [not asserted]
+size_t calist_view_index(calist_view view, const void *item);
+size_t calist_view_index_last(calist_view view, const void *item);
+bool calist_view_contains(calist_view view, const void *item);
+size_t calist_view_count(calist_view view, const void *item);
+size_t calist_view_bsearch(calist_view view, const void *item);
+size_t calist_view_lower_bound(calist_view view, const void *item);
+size_t calist_view_upper_bound(calist_view view, const void *item);
+bool calist_view_equals(calist_view v1, calist_view v2);
+void calist_view_print(calist_view view);
+
+// calist_view_to_calist(view) creates a calist holding copies of the items
+//   of view, like calist_slice.
+// requires: view is valid
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *calist_view_to_calist(calist_view view);
+
 // calist_filter(al, pred, args) produces a calist containing items in al
 //   filtered by pred, where args provides additional arguments to the 
 //   pred function.
@@ -360,6 +978,8 @@ void calist_foreach(const calist *al, calist_map map, const void *args);
 //   preserving the original order.
 // requires: al is not NULL
 // effects: allocates heap memory [caller must free with calist_destroy]
+// note: takes O(n) expected time if the ctype of al has a hash method,
+//       and O(n log n) time otherwise
 calist *calist_unique(const calist *al);
 
 // calist_remove_dup(al) removes all duplicate items from al, keeping only 
@@ -367,6 +987,77 @@ calist *calist_unique(const calist *al);
 // requires: al is not NULL
 // effects: modifies al, frees heap memory
 // note: returns the number of duplicate items removed
+//       takes O(n) expected time if the ctype of al has a hash method,
+//       and O(n log n) time otherwise
 size_t calist_remove_dup(calist *al);
 
+// Parallel operations:
+//   The calist_par_* functions split al into chunks of the grain size of 
+//   the cpool of al [see calist_set_pool] and run the callback on the 
+//   chunks on several threads at once. The callback must be safe to call
+//   concurrently, and must not modify al other than through the item it
+//   is given. Calists of fewer items than the grain size are processed on
+//   the calling thread.
+
+// calist_pool(al) produces the cpool that runs the parallel operations on
+//   al, which is cpool_default() unless set by calist_set_pool.
+// requires: al is not NULL
+cpool *calist_pool(const calist *al);
+
+// calist_set_pool(al, pool) makes pool run the parallel operations on al.
+//   Calists produced from al (calist_dup, calist_slice, calist_filter, 
+//   calist_unique) use pool as well. A NULL pool restores cpool_default().
+// requires: al is not NULL
+// effects: modifies al
+// note: pool must outlive al
+void calist_set_pool(calist *al, cpool *pool);
+
+// calist_par_foreach(al, map, args) applies map to each item in al like 
+//   calist_foreach, in parallel and in no particular order.
+// requires: al and map are not NULL
+// effects: may modify item [see calist_map documentation]
+void calist_par_foreach(const calist *al, calist_map map, const void *args);
+
+// calist_par_filter(al, pred, args) produces a calist containing the items
+//   in al that satisfy pred, in their original order, like calist_filter.
+//   pred runs in parallel; the items are then copied on the calling 
+//   thread.
+// requires: al and pred are not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *calist_par_filter(const calist *al, calist_pred pred, 
+                          const void *args);
+
+// calist_par_count_if(al, pred, args) produces the number of items in al 
+//   that satisfy pred, running pred in parallel.
+// requires: al and pred are not NULL
+size_t calist_par_count_if(const calist *al, calist_pred pred, 
+                           const void *args);
+
+// calist_par_reduce(al, acc, acc_size, reduce, combine, args) folds the 
+//   items in al into the accumulator acc of acc_size bytes. Each chunk of
+//   al is folded with reduce into its own copy of the initial acc, and the
+//   chunk accumulators are then merged into acc with combine in the order
+//   of the chunks, on the calling thread.
+// requires: al, acc, reduce and combine are not NULL
+//           acc_size > 0
+//           acc holds an identity of combine [a value that combine leaves
+//           any accumulator unchanged by], and combine is associative
+// effects: modifies acc, may allocate and free heap memory
+// note: the accumulator must be trivially copyable [it is copied with 
+//       memcpy]
+void calist_par_reduce(const calist *al, void *acc, size_t acc_size,
+                       calist_reduce reduce, calist_combine combine,
+                       const void *args);
+
+// calist_par_sort(al) stably sorts al in ascending order like 
+//   calist_stable_sort, producing exactly the same order, on the threads 
+//   of the cpool of al. Chunks of al are sorted concurrently and then 
+//   merged in parallel.
+// requires: al is not NULL
+// effects: modifies al, allocates and frees heap memory
+// time: O(n log n) work, divided among the threads of the cpool of al
+// note: the merge uses a buffer of the size of the storage of al; if it
+//       cannot be allocated, al is sorted on the calling thread
+void calist_par_sort(calist *al);
+
 #endif
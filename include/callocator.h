@@ -0,0 +1,112 @@
+// The callocator module provides the callocator ADT, an interface to the
+//   memory allocators used by generic storage ADTs. The module also
+//   provides a default allocator backed by malloc, a bump-pointer arena,
+//   a size-class pool and a fixed-size slab.
+
+#ifndef CALLOCATOR_H
+#define CALLOCATOR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// A callocator describes how a storage ADT obtains and returns memory.
+// methods (each receives the context pointer ctx of the allocator):
+//   - alloc:   allocates size bytes, like malloc
+//              returns NULL if allocation fails
+//   - resize:  resizes the old_size bytes at ptr to new_size bytes,
+//              like realloc; ptr is never NULL
+//              returns NULL if allocation fails [ptr remains valid]
+//   - release: frees the size bytes at ptr, like free; ptr is never NULL
+// note: memory obtained from an allocator must be resized and released
+//       through the same allocator with the size it currently has
+//       all memory returned is suitably aligned for any built-in type
+typedef struct callocator callocator;
+
+// callocator_create(alloc, resize, release, ctx) creates a callocator
+//   with the given methods and context (see callocator documentation
+//   above).
+// requires: alloc, resize, release are not NULL
+// effects: allocates heap memory [caller must free with callocator_destroy]
+callocator *callocator_create(void *(*alloc)(void *ctx, size_t size),
+                              void *(*resize)(void *ctx, void *ptr,
+                                              size_t old_size,
+                                              size_t new_size),
+                              void (*release)(void *ctx, void *ptr,
+                                              size_t size),
+                              void *ctx);
+
+// callocator_create_arena(block_size) creates a bump-pointer arena that
+//   carves allocations from blocks of at least block_size bytes.
+//   Releasing memory is a no-op except for the most recent allocation,
+//   which can also be resized in place. All memory is released at once
+//   by callocator_reset or callocator_destroy.
+// requires: block_size > 0
+// effects: allocates heap memory [caller must free with callocator_destroy]
+callocator *callocator_create_arena(size_t block_size);
+
+// callocator_create_pool() creates a pool allocator that serves small
+//   allocations from per-size-class free lists carved out of large slabs,
+//   and larger ones from malloc. Released memory is reused by later
+//   allocations of the same size class. All memory is released at once
+//   by callocator_reset or callocator_destroy.
+// effects: allocates heap memory [caller must free with callocator_destroy]
+callocator *callocator_create_pool(void);
+
+// callocator_create_slab(size) creates a slab allocator for objects of
+//   size bytes. Objects are carved from slabs refilled in growing batches
+//   and each takes size bytes rounded up to a multiple of sizeof(void *),
+//   without a per-object header. Released objects are reused through a
+//   free list, and allocations larger than size bytes fall back to 
+//   malloc. All memory is released at once by callocator_reset or 
+//   callocator_destroy.
+// requires: size > 0
+// effects: allocates heap memory [caller must free with callocator_destroy]
+// note: objects never move while allocated
+callocator *callocator_create_slab(size_t size);
+
+// callocator_destroy(alloc) frees alloc and, for an arena, a pool or a
+//   slab, all memory allocated from it.
+// requires: alloc is not callocator_default()
+// effects: frees heap memory [alloc becomes invalid]
+void callocator_destroy(callocator *alloc);
+
+// callocator_reset(alloc) releases all memory allocated from the arena,
+//   pool or slab alloc at once, keeping alloc usable for new allocations.
+// requires: alloc is not NULL
+//           alloc was created by callocator_create_arena, 
+//           callocator_create_pool or callocator_create_slab
+// effects: invalidates all memory allocated from alloc [including any
+//          storage ADT whose memory came from alloc]
+void callocator_reset(callocator *alloc);
+
+// callocator_resettable(alloc) produces true if alloc supports
+//   callocator_reset, and false otherwise.
+// requires: alloc is not NULL
+bool callocator_resettable(const callocator *alloc);
+
+// callocator_default() produces the shared allocator backed by malloc,
+//   realloc and free.
+// note: the returned pointer must not be destroyed
+const callocator *callocator_default(void);
+
+// callocator_alloc(alloc, size) allocates size bytes from alloc.
+// requires: alloc is not NULL
+// effects: allocates memory [caller must free with callocator_release]
+// note: returns NULL if allocation fails
+void *callocator_alloc(const callocator *alloc, size_t size);
+
+// callocator_resize(alloc, ptr, old_size, new_size) resizes the old_size
+//   bytes at ptr, allocated from alloc, to new_size bytes.
+// requires: alloc and ptr are not NULL
+// effects: may allocate or free memory
+// note: returns NULL if allocation fails [ptr remains valid]
+void *callocator_resize(const callocator *alloc, void *ptr,
+                        size_t old_size, size_t new_size);
+
+// callocator_release(alloc, ptr, size) frees the size bytes at ptr,
+//   allocated from alloc.
+// requires: alloc is not NULL
+// effects: frees memory [if ptr is not NULL]
+void callocator_release(const callocator *alloc, void *ptr, size_t size);
+
+#endif
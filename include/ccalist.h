@@ -0,0 +1,99 @@
+// The ccalist module provides the ccalist ADT, a concurrent append-only
+//   variant of calist.
+
+#ifndef CCALIST_H
+#define CCALIST_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "calist.h"
+
+// A ccalist stores items like a calist, but may be appended to from any
+//   number of threads while other threads read it, without locks.
+//
+// Items are kept in segments of doubling size that are never moved or
+//   freed before ccalist_destroy, so a published item stays at the same
+//   address. An append reserves an index with one atomic increment,
+//   copies the item into its slot and then publishes it. The published
+//   items are always a prefix of the list: an item becomes visible once
+//   it and all items at lower indices are published, so readers never
+//   see a gap.
+//
+// Readers never block and never wait for writers, since published items
+//   are neither modified nor retired while the ccalist exists. Items of
+//   POD ctypes are stored inline; other items are boxed like in a calist.
+//
+// Thread safety:
+//   - ccalist_append may be called from several threads at once, and at
+//     the same time as the read functions.
+//   - The read functions see the items published when they are called
+//     [see ccalist_size] and are safe to call from any thread.
+//   - ccalist_destroy must not run concurrently with any other function.
+//   - Items must not be modified through the pointers from ccalist_get.
+typedef struct ccalist ccalist;
+
+// ccalist_create(type) creates an empty ccalist of items of type.
+// requires: type is not NULL
+//           the dup and destroy methods of type are safe to call from
+//           several threads at once [true of the built-in ctypes except
+//           ctype_interned_string; slab ctypes are not]
+// effects: allocates heap memory [caller must free with ccalist_destroy]
+ccalist *ccalist_create(const ctype *type);
+
+// ccalist_destroy(cl) frees cl and all of its items.
+// requires: no other function runs on cl
+// effects: frees heap memory [cl becomes invalid]
+// note: if cl is NULL, no operation is performed
+void ccalist_destroy(ccalist *cl);
+
+// ccalist_type(cl) produces the ctype of the items in cl.
+// requires: cl is not NULL
+const ctype *ccalist_type(const ccalist *cl);
+
+// ccalist_append(cl, item) appends a deep copy of item to cl and produces
+//   its index.
+// requires: cl and item are not NULL
+// effects: modifies cl, may allocate heap memory
+// time: lock-free; O(1) apart from copying item
+// note: the item is visible to readers once all items appended before it
+//       are, which may be after ccalist_append returns if another append
+//       is still copying its item
+size_t ccalist_append(ccalist *cl, const void *item);
+
+// ccalist_size(cl) produces the number of published items in cl. Items
+//   [0, ccalist_size(cl)) may be read; the count only increases.
+// requires: cl is not NULL
+size_t ccalist_size(const ccalist *cl);
+
+// ccalist_get(cl, index) produces the item at index.
+// requires: cl is not NULL
+//           index < ccalist_size(cl)
+// note: the item stays valid and unchanged until cl is destroyed
+const void *ccalist_get(const ccalist *cl, size_t index);
+
+// ccalist_index(cl, item) produces the index of the first published item
+//   equal to item, or CALIST_INDEX_NOT_FOUND if there is none.
+// requires: cl and item are not NULL
+size_t ccalist_index(const ccalist *cl, const void *item);
+
+// ccalist_contains(cl, item) produces true if a published item of cl is
+//   equal to item, and false otherwise.
+// requires: cl and item are not NULL
+bool ccalist_contains(const ccalist *cl, const void *item);
+
+// ccalist_bsearch(cl, item) produces the index of an item equal to item
+//   among the published items of cl, or CALIST_INDEX_NOT_FOUND if there is
+//   none.
+// requires: cl and item are not NULL
+//           items are appended in ascending order [not asserted]
+// time: O(log n)
+size_t ccalist_bsearch(const ccalist *cl, const void *item);
+
+// ccalist_snapshot(cl) produces a calist holding copies of the items
+//   published in cl.
+// requires: cl is not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *ccalist_snapshot(const ccalist *cl);
+
+#endif
@@ -8,6 +8,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// CERROR_CHECKS selects whether ASSERT_MSG and ASSERT_NOT_NULL check their
+//   conditions: 1 [the default] checks them, and 0 compiles them out, so
+//   that the contracts of the library cost nothing in optimized builds.
+//   Defining NDEBUG sets it to 0 unless it is defined explicitly
+//   [see "make BUILD=release"]. FATAL_ERROR and ALLOC_ERROR report
+//   failures at run time, and are never compiled out.
+// note: with checks off, the conditions are not evaluated [they must have
+//       no side effects], and a violated contract is undefined behavior
+#ifndef CERROR_CHECKS
+#ifdef NDEBUG
+#define CERROR_CHECKS 0
+#else
+#define CERROR_CHECKS 1
+#endif
+#endif
+
+#if CERROR_CHECKS
+
 // ASSERT_MSG(cond, msg) prints msg and terminates the program immediately
 //   if cond is false. If msg is NULL, then the printed message will be
 //   "Terminating program".
@@ -34,6 +52,22 @@
   abort(); \
 } while (0)
 
+#else
+
+// The operands are named in sizeof only, so that variables used solely in
+//   checks do not become unused
+#define ASSERT_MSG(cond, msg) do { \
+  (void) sizeof((cond) ? 1 : 0); \
+  (void) sizeof(msg); \
+} while (0)
+
+#define ASSERT_NOT_NULL(nonnull, name) do { \
+  (void) sizeof((nonnull) ? 1 : 0); \
+  (void) sizeof(name); \
+} while (0)
+
+#endif
+
 // FATAL_ERROR(msg) prints a formatted error message and terminates 
 //   the program immediately. If msg is NULL, then the printed message 
 //   will be "Terminating program".
@@ -0,0 +1,161 @@
+// The chashmap module provides the chashmap ADT, a hash map from keys of
+//   one ctype to values of another.
+
+#ifndef CHASHMAP_H
+#define CHASHMAP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "calist.h"
+
+// A chashmap maps distinct keys of one ctype to values of another, with
+//   all keys and values deeply copied into heap memory, and finds a key
+//   in O(1) expected time. Keys are compared and hashed like the items of
+//   a chashset [see chashset.h], using the same table: each slot holds a
+//   key and its value side by side.
+//
+// Entries are visited in an unspecified order, which changes when the
+//   table is rehashed.
+//
+// Memory model:
+//   - All inserted keys and values are deeply copied into memory owned by
+//     the chashmap, and freed when removed or when it is destroyed.
+//   - Keys must not be modified; values may be modified in place through
+//     chashmap_get_mutable.
+typedef struct chashmap chashmap;
+
+// chashmap_visit is a function applied to each entry of map
+//   [see chashmap_foreach].
+// parameters:
+//   - map: the chashmap containing the entry (may be used for context or
+//          ignored)
+//   - key: the key of the entry
+//   - value: a mutable pointer to the value of the entry
+//   - args: optional external data (may be NULL)
+// requires: map, key and value are not NULL
+// effects: may modify value
+// note: visit must not insert or remove entries of map
+typedef void (*chashmap_visit)(const chashmap *map,
+                               const void *key,
+                               void *value,
+                               const void *args);
+
+// Method alias
+#define chashmap_length chashmap_size
+#define chashmap_set chashmap_put
+
+// chashmap_create(key_type, value_type) creates an empty chashmap from
+//   keys of key_type to values of value_type.
+// requires: key_type and value_type are not NULL
+//           key_type has a hash method
+// effects: allocates heap memory [caller must free with chashmap_destroy]
+// note: no table is allocated until the first insertion
+chashmap *chashmap_create(const ctype *key_type, const ctype *value_type);
+
+// chashmap_destroy(map) frees map and its entries from the heap memory.
+// effects: frees heap memory [map becomes invalid]
+// note: if map is NULL, no operation is performed
+void chashmap_destroy(chashmap *map);
+
+// chashmap_clear(map) removes all entries from map, keeping its capacity.
+// requires: map is not NULL
+// effects: modifies map, frees heap memory
+void chashmap_clear(chashmap *map);
+
+// chashmap_print(map) displays the entries of map.
+// requires: map is not NULL
+// effects: produces output
+void chashmap_print(const chashmap *map);
+
+// chashmap_key_type(map) produces the ctype of the keys in map, and
+//   chashmap_value_type(map) the ctype of the values.
+// requires: map is not NULL
+const ctype *chashmap_key_type(const chashmap *map);
+const ctype *chashmap_value_type(const chashmap *map);
+
+// chashmap_size(map) produces the number of entries in map.
+// requires: map is not NULL
+size_t chashmap_size(const chashmap *map);
+
+// chashmap_empty(map) produces true if map is empty and false otherwise.
+// requires: map is not NULL
+bool chashmap_empty(const chashmap *map);
+
+// chashmap_capacity(map) produces the number of slots in the table of
+//   map, of which at most 7/8 are filled.
+// requires: map is not NULL
+size_t chashmap_capacity(const chashmap *map);
+
+// chashmap_reserve(map, n) grows the table of map, if needed, so that it
+//   holds n entries without rehashing.
+// requires: map is not NULL
+// effects: may modify map, allocate and free heap memory
+void chashmap_reserve(chashmap *map, size_t n);
+
+// chashmap_rehash(map, n) rebuilds the table of map with the smallest
+//   capacity that holds n entries, or all of its entries if there are
+//   more [see chashset_rehash].
+// requires: map is not NULL
+// effects: modifies map, may allocate and free heap memory
+void chashmap_rehash(chashmap *map, size_t n);
+
+// chashmap_put(map, key, value) maps key to a deep copy of value in map,
+//   producing true if key was added and false if the value of an existing
+//   key was replaced.
+// requires: map, key and value are not NULL
+// effects: modifies map, may allocate and free heap memory
+// time: O(1) expected, amortized
+bool chashmap_put(chashmap *map, const void *key, const void *value);
+
+// chashmap_get(map, key) produces the value of key in map, or NULL if map
+//   does not contain key.
+// requires: map and key are not NULL
+// time: O(1) expected
+// note: the value is invalidated by any insertion or removal
+const void *chashmap_get(const chashmap *map, const void *key);
+
+// chashmap_get_mutable(map, key) produces a mutable pointer to the value
+//   of key in map, or NULL if map does not contain key.
+// requires: map and key are not NULL
+// time: O(1) expected
+// note: see chashmap_get
+void *chashmap_get_mutable(chashmap *map, const void *key);
+
+// chashmap_contains(map, key) produces true if map contains key, and false
+//   otherwise.
+// requires: map and key are not NULL
+// time: O(1) expected
+bool chashmap_contains(const chashmap *map, const void *key);
+
+// chashmap_remove(map, key) removes key and its value from map, producing
+//   true if map contained key and false otherwise.
+// requires: map and key are not NULL
+// effects: may modify map and free heap memory
+// time: O(1) expected
+bool chashmap_remove(chashmap *map, const void *key);
+
+// chashmap_foreach(map, visit, args) applies visit to each entry of map,
+//   where args provides additional arguments to the visit function.
+// requires: map and visit are not NULL
+// effects: may modify the values of map
+void chashmap_foreach(const chashmap *map, chashmap_visit visit,
+                      const void *args);
+
+// chashmap_from_calists(keys, values) creates a chashmap mapping each item
+//   of keys to the item of values at the same index; of equal keys, the
+//   last one wins.
+// requires: keys and values are not NULL and have the same size
+//           the type of keys has a hash method
+// effects: allocates heap memory [caller must free with chashmap_destroy]
+chashmap *chashmap_from_calists(const calist *keys, const calist *values);
+
+// chashmap_keys(map) produces a calist holding copies of the keys of map,
+//   and chashmap_values(map) one holding copies of the values, both in the
+//   order chashmap_foreach visits the entries.
+// requires: map is not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *chashmap_keys(const chashmap *map);
+calist *chashmap_values(const chashmap *map);
+
+#endif
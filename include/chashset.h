@@ -0,0 +1,163 @@
+// The chashset module provides the chashset ADT, a hash set of items of one
+//   ctype.
+
+#ifndef CHASHSET_H
+#define CHASHSET_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "calist.h"
+
+// A chashset stores distinct items of one ctype, with all items deeply
+//   copied into heap memory, and finds an item in O(1) expected time.
+//   Items are equal if the cmp method of the ctype produces 0, and are
+//   located with its hash method [see ctype_set_hash], which must agree:
+//   equal items must have equal hashes.
+//
+// Items are stored in an open-addressing table in the manner of
+//   SwissTable: besides one contiguous array of slots [inline for POD
+//   ctypes, boxed otherwise, as in a calist], the table keeps one control
+//   byte per slot holding seven bits of the item's hash. A lookup probes
+//   16 control bytes at once with SIMD instructions and calls cmp only on
+//   slots whose byte matches. The table holds at most 7/8 of its capacity
+//   and doubles when full.
+//
+// Items are visited in an unspecified order, which changes when the table
+//   is rehashed.
+//
+// Memory model:
+//   - All inserted items are deeply copied into memory owned by the
+//     chashset, and freed when removed or when it is destroyed.
+//   - Items must not be modified through the pointers it produces, as
+//     that may change their hash.
+typedef struct chashset chashset;
+
+// chashset_visit is a function applied to each item of set
+//   [see chashset_foreach].
+// parameters:
+//   - set: the chashset containing item (may be used for context or
+//          ignored)
+//   - item: the item being visited
+//   - args: optional external data (may be NULL)
+// requires: set and item are not NULL
+// note: visit must not modify set
+typedef void (*chashset_visit)(const chashset *set,
+                               const void *item,
+                               const void *args);
+
+// Method alias
+#define chashset_length chashset_size
+#define chashset_add chashset_insert
+
+// chashset_create(type) creates an empty chashset of items of type.
+// requires: type is not NULL and has a hash method
+// effects: allocates heap memory [caller must free with chashset_destroy]
+// note: no table is allocated until the first insertion
+chashset *chashset_create(const ctype *type);
+
+// chashset_destroy(set) frees set and its items from the heap memory.
+// effects: frees heap memory [set becomes invalid]
+// note: if set is NULL, no operation is performed
+void chashset_destroy(chashset *set);
+
+// chashset_clear(set) removes all items from set, keeping its capacity.
+// requires: set is not NULL
+// effects: modifies set, frees heap memory
+void chashset_clear(chashset *set);
+
+// chashset_print(set) displays the items of set.
+// requires: set is not NULL
+// effects: produces output
+void chashset_print(const chashset *set);
+
+// chashset_equals(s1, s2) produces true if s1 and s2 have the same type
+//   and contain the same items, and false otherwise.
+// requires: s1 and s2 are not NULL
+bool chashset_equals(const chashset *s1, const chashset *s2);
+
+// chashset_type(set) produces the ctype of the items in set.
+// requires: set is not NULL
+const ctype *chashset_type(const chashset *set);
+
+// chashset_size(set) produces the number of items in set.
+// requires: set is not NULL
+size_t chashset_size(const chashset *set);
+
+// chashset_empty(set) produces true if set is empty and false otherwise.
+// requires: set is not NULL
+bool chashset_empty(const chashset *set);
+
+// chashset_capacity(set) produces the number of slots in the table of
+//   set, of which at most 7/8 are filled.
+// requires: set is not NULL
+size_t chashset_capacity(const chashset *set);
+
+// chashset_reserve(set, n) grows the table of set, if needed, so that it
+//   holds n items without rehashing.
+// requires: set is not NULL
+// effects: may modify set, allocate and free heap memory
+void chashset_reserve(chashset *set, size_t n);
+
+// chashset_rehash(set, n) rebuilds the table of set with the smallest
+//   capacity that holds n items, or all of its items if there are more,
+//   clearing the slots left behind by removals. chashset_rehash(set, 0)
+//   shrinks set to fit its items.
+// requires: set is not NULL
+// effects: modifies set, may allocate and free heap memory
+void chashset_rehash(chashset *set, size_t n);
+
+// chashset_insert(set, item) inserts a deep copy of item into set,
+//   producing true if item was added and false if set already contained
+//   an equal item [set is unchanged].
+// requires: set and item are not NULL
+// effects: may modify set and allocate heap memory
+// time: O(1) expected, amortized
+bool chashset_insert(chashset *set, const void *item);
+
+// chashset_insert_all(set, al) inserts deep copies of the items of al
+//   into set, and produces the number of items added.
+// requires: set and al are not NULL and have the same type
+// effects: may modify set and allocate heap memory
+// note: the table is grown once beforehand to hold all items of al
+size_t chashset_insert_all(chashset *set, const calist *al);
+
+// chashset_remove(set, item) removes the item equal to item from set,
+//   producing true if there was one and false otherwise.
+// requires: set and item are not NULL
+// effects: may modify set and free heap memory
+// time: O(1) expected
+bool chashset_remove(chashset *set, const void *item);
+
+// chashset_contains(set, item) produces true if set contains an item
+//   equal to item, and false otherwise.
+// requires: set and item are not NULL
+// time: O(1) expected
+bool chashset_contains(const chashset *set, const void *item);
+
+// chashset_get(set, item) produces the item of set equal to item, or NULL
+//   if there is none.
+// requires: set and item are not NULL
+// time: O(1) expected
+// note: the item is invalidated by any insertion or removal
+const void *chashset_get(const chashset *set, const void *item);
+
+// chashset_foreach(set, visit, args) applies visit to each item of set,
+//   where args provides additional arguments to the visit function.
+// requires: set and visit are not NULL
+void chashset_foreach(const chashset *set, chashset_visit visit,
+                      const void *args);
+
+// chashset_from_calist(al) creates a chashset holding the distinct items
+//   of al.
+// requires: al is not NULL, and its type has a hash method
+// effects: allocates heap memory [caller must free with chashset_destroy]
+chashset *chashset_from_calist(const calist *al);
+
+// chashset_to_calist(set) produces a calist holding copies of the items
+//   of set, in the order chashset_foreach visits them.
+// requires: set is not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *chashset_to_calist(const chashset *set);
+
+#endif
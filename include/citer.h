@@ -0,0 +1,217 @@
+// The citer module provides the citer ADT, a lazy iterator over a calist
+//   or a valist.
+
+#ifndef CITER_H
+#define CITER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "ctypeitem.h"
+#include "calist.h"
+#include "valist.h"
+
+// A citer produces the items of a list one at a time through a pipeline of
+//   stages: filter, map, skip and take. Stages run only when an item is
+//   requested, and all stages run on one item before the next is read, so
+//   a chain such as "skip, filter, count" makes one pass over the list and
+//   copies nothing. Nothing is materialized until citer_collect.
+//
+// A citer lives on the stack and allocates no memory:
+//
+//   citer it = citer_calist(al);
+//   citer_skip(&it, 100);
+//   citer_filter(&it, is_even, NULL);
+//   size_t n = citer_count(&it);
+//
+// Skip and take stages that precede every filter narrow the index range of
+//   a calist or valist at once, in O(1) time, instead of reading the items
+//   they drop.
+//
+// A citer over a valist produces its ctypeitems [see ctypeitem.h], and a
+//   citer over the items of one ctype in a valist produces their values.
+//
+// Memory model:
+//   - Items are produced as constant pointers into the list, or into the
+//     buffer of a map stage, valid until the next item is requested.
+//   - The list must not be modified while the citer is in use.
+//   - A citer is used up by its terminal function [citer_next until it
+//     produces false, or one of citer_count ... citer_collect_valist].
+
+// The most stages of a citer
+#define CITER_MAX_STAGES 8
+
+// The size in bytes of the buffer of a map stage
+#define CITER_BUFFER_SIZE 64
+
+// citer_pred is a predicate function that checks whether the given item
+//   satisfies specific conditions [see citer_filter].
+// parameters:
+//   - item: the item to be tested
+//   - args: optional external data (may be NULL)
+// requires: item is not NULL
+// note: returns true if item satisfies the conditions; false otherwise
+typedef bool (*citer_pred)(const void *item, const void *args);
+
+// citer_transform is a mapping function that produces the item that the
+//   given item maps to [see citer_map].
+// parameters:
+//   - item: the item to be mapped
+//   - buffer: CITER_BUFFER_SIZE bytes of scratch memory, aligned for any
+//             scalar, that may hold the produced item
+//   - args: optional external data (may be NULL)
+// requires: item and buffer are not NULL
+// note: returns a pointer to the mapped item, which must stay valid until
+//       it is called again; the function must not have side effects, as
+//       it is not called on an item dropped by a skip or take stage
+typedef const void *(*citer_transform)(const void *item,
+                                       void *buffer,
+                                       const void *args);
+
+// citer_accumulate is an accumulation function that folds the given item
+//   into the accumulator acc [see citer_reduce].
+// parameters:
+//   - acc: the accumulator to be updated
+//   - item: the item to be folded into acc
+//   - args: optional external data (may be NULL)
+// requires: acc and item are not NULL
+// effects: modifies acc
+typedef void (*citer_accumulate)(void *acc,
+                                 const void *item,
+                                 const void *args);
+
+// The layout of a citer is public only so that it can live on the stack;
+//   use the functions below instead of the fields.
+typedef enum {
+  CITER_STAGE_FILTER,
+  CITER_STAGE_MAP,
+  CITER_STAGE_SKIP,
+  CITER_STAGE_TAKE,
+} citer_stage_kind;
+
+typedef struct {
+  citer_stage_kind kind;
+  citer_pred pred;
+  citer_transform transform;
+  const void *args;
+  size_t left;  // the items still to skip or take
+  union {
+    unsigned char bytes[CITER_BUFFER_SIZE];
+    void *ptr;
+    long double align;
+  } buffer;
+} citer_stage;
+
+typedef enum {
+  CITER_SOURCE_CALIST,
+  CITER_SOURCE_VALIST,
+  CITER_SOURCE_VALIST_TYPE,
+} citer_source;
+
+typedef struct citer {
+  citer_source source;
+  const void *list;
+  const ctype *match;   // the ctype selected from a valist
+  const ctype *type;    // of the items produced, or NULL for ctypeitems
+  size_t pos;           // the index of the next item of the list
+  size_t end;
+  bool done;            // true once a take stage has taken all its items
+  bool ranged;          // true while skip and take narrow [pos, end)
+  size_t stage_count;
+  citer_stage stages[CITER_MAX_STAGES];
+} citer;
+
+// citer_calist(al) produces a citer over the items of al, in order.
+// requires: al is not NULL
+citer citer_calist(const calist *al);
+
+// citer_valist(al) produces a citer over the ctypeitems of al, in order.
+// requires: al is not NULL
+citer citer_valist(const valist *al);
+
+// citer_valist_type(al, type) produces a citer over the values of the
+//   items of al with the given type, in order.
+// requires: al and type are not NULL
+citer citer_valist_type(const valist *al, const ctype *type);
+
+// citer_type(it) produces the ctype of the items that it produces, or NULL
+//   if it produces the ctypeitems of a valist.
+// requires: it is not NULL
+const ctype *citer_type(const citer *it);
+
+// citer_filter(it, pred, args) adds a stage to it that drops the items
+//   for which pred produces false, where args provides additional
+//   arguments to the pred function.
+// requires: it and pred are not NULL
+//           it has fewer than CITER_MAX_STAGES stages
+// effects: modifies it
+void citer_filter(citer *it, citer_pred pred, const void *args);
+
+// citer_map(it, transform, type, args) adds a stage to it that replaces
+//   each item with the item transform produces for it, of the given type
+//   [NULL for ctypeitems], where args provides additional arguments to the
+//   transform function.
+// requires: it and transform are not NULL
+//           it has fewer than CITER_MAX_STAGES stages
+// effects: modifies it
+void citer_map(citer *it, citer_transform transform, const ctype *type,
+               const void *args);
+
+// citer_skip(it, n) adds a stage to it that drops the first n items that
+//   reach it.
+// requires: it is not NULL
+//           it has fewer than CITER_MAX_STAGES stages, unless the stage
+//           narrows the range of the list [see above]
+// effects: modifies it
+void citer_skip(citer *it, size_t n);
+
+// citer_take(it, n) adds a stage to it that passes the first n items that
+//   reach it, and ends it afterwards.
+// requires: see citer_skip
+// effects: modifies it
+void citer_take(citer *it, size_t n);
+
+// citer_next(it, item) stores the next item of it in *item and produces
+//   true, or produces false if it has no more items.
+// requires: it and item are not NULL
+// effects: modifies it and *item
+bool citer_next(citer *it, const void **item);
+
+// citer_count(it) produces the number of remaining items of it.
+// requires: it is not NULL
+// effects: modifies it [it is used up]
+size_t citer_count(citer *it);
+
+// citer_any(it, pred, args) produces true if pred produces true for some
+//   remaining item of it, stopping at the first one, and false otherwise.
+//   citer_all(it, pred, args) produces true if pred produces true for
+//   every remaining item of it, stopping at the first one that fails.
+// requires: it and pred are not NULL
+// effects: modifies it
+bool citer_any(citer *it, citer_pred pred, const void *args);
+bool citer_all(citer *it, citer_pred pred, const void *args);
+
+// citer_reduce(it, acc, accumulate, args) folds the remaining items of it
+//   into acc in order, where args provides additional arguments to the
+//   accumulate function.
+// requires: it, acc and accumulate are not NULL
+// effects: modifies it and acc [it is used up]
+void citer_reduce(citer *it, void *acc, citer_accumulate accumulate,
+                  const void *args);
+
+// citer_collect(it) produces a calist holding copies of the remaining
+//   items of it.
+// requires: it is not NULL
+//           citer_type(it) is not NULL
+// effects: modifies it [it is used up], allocates heap memory [caller must
+//          free with calist_destroy]
+calist *citer_collect(citer *it);
+
+// citer_collect_valist(it) produces a valist holding copies of the
+//   remaining items of it, which are ctypeitems or values of citer_type(it).
+// requires: it is not NULL
+// effects: modifies it [it is used up], allocates heap memory [caller must
+//          free with valist_destroy]
+valist *citer_collect_valist(citer *it);
+
+#endif
@@ -0,0 +1,82 @@
+// The cpool module provides the cpool ADT, a reusable pool of worker
+//   threads that runs data-parallel loops for the parallel operations of
+//   the storage ADTs. Each loop is split into chunks of a tunable grain
+//   size; every thread starts on its own share of the chunks and steals
+//   half of the remaining chunks of another thread once it runs out.
+
+#ifndef CPOOL_H
+#define CPOOL_H
+
+#include <stddef.h>
+
+// A cpool is a pool of worker threads.
+// note: a cpool runs one loop at a time; a loop started while another is
+//       running on the same pool (including from inside a loop body) runs
+//       on the calling thread alone
+typedef struct cpool cpool;
+
+// cpool_body is the body of a parallel loop, called for consecutive
+//   chunks [begin, end) of the loop range.
+// parameters:
+//   - ctx: the context pointer given to cpool_for
+//   - begin, end: the chunk, where begin is a multiple of the grain size
+//                 and end - begin is the grain size except for the last
+//                 chunk
+// note: chunks run concurrently on different threads, in any order
+typedef void (*cpool_body)(void *ctx, size_t begin, size_t end);
+
+// The grain size of a new cpool
+extern const size_t CPOOL_DEFAULT_GRAIN;
+
+// cpool_create(threads) creates a pool that runs loops on threads threads,
+//   including the thread that starts the loop. If threads is 0, the pool
+//   uses one thread per online processor.
+// effects: allocates heap memory and starts threads [caller must free with
+//          cpool_destroy]
+cpool *cpool_create(size_t threads);
+
+// cpool_destroy(pool) stops the threads of pool and frees it.
+// requires: no loop is running on pool
+//           pool is not cpool_default()
+// effects: frees heap memory [pool becomes invalid]
+void cpool_destroy(cpool *pool);
+
+// cpool_default() produces the shared pool with one thread per online
+//   processor, creating it on first use.
+// note: the returned pointer must not be destroyed
+cpool *cpool_default(void);
+
+// cpool_threads(pool) produces the number of threads that run the loops
+//   of pool.
+// requires: pool is not NULL
+size_t cpool_threads(const cpool *pool);
+
+// cpool_grain(pool) produces the grain size of pool.
+// requires: pool is not NULL
+size_t cpool_grain(const cpool *pool);
+
+// cpool_set_grain(pool, grain) sets the grain size of pool, the number of
+//   loop indices per chunk. Larger grains lower the scheduling overhead;
+//   smaller grains balance uneven work better.
+// requires: pool is not NULL
+//           grain > 0
+//           no loop is running on pool
+// effects: modifies pool
+void cpool_set_grain(cpool *pool, size_t grain);
+
+// cpool_for(pool, n, body, ctx) calls body(ctx, begin, end) for chunks
+//   covering [0, n) and returns once all of them have run.
+// requires: pool and body are not NULL
+// effects: calls body, possibly on several threads at once
+void cpool_for(cpool *pool, size_t n, cpool_body body, void *ctx);
+
+// cpool_for_grain(pool, n, grain, body, ctx) is cpool_for with chunks of 
+//   grain indices instead of the grain size of pool, for loops whose 
+//   indices are already coarse tasks.
+// requires: pool and body are not NULL
+//           grain > 0
+// effects: calls body, possibly on several threads at once
+void cpool_for_grain(cpool *pool, size_t n, size_t grain, cpool_body body,
+                     void *ctx);
+
+#endif
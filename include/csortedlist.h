@@ -0,0 +1,179 @@
+// The csortedlist module provides the csortedlist ADT, a list that keeps
+//   its items in ascending order.
+
+#ifndef CSORTEDLIST_H
+#define CSORTEDLIST_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "calist.h"
+
+// A csortedlist stores items of one ctype in ascending order as defined by
+//   the ctype, with all items deeply copied into heap memory. Equal items
+//   keep the order in which they were inserted.
+//
+// Items are kept in a B+-tree: leaves hold runs of consecutive items in
+//   contiguous slots [inline for POD ctypes, boxed otherwise, as in a
+//   calist] and are linked in order, and every branch records the number
+//   of items below each child. Inserting and removing items take O(log n)
+//   time instead of the O(n) shift of a sorted calist, and the index of an
+//   item is found and resolved in O(log n), so a csortedlist is also
+//   indexed like a calist. Ranges of items are visited leaf by leaf.
+//
+// Memory model:
+//   - All inserted items are deeply copied into memory owned by the
+//     csortedlist, and freed when removed or when it is destroyed.
+//   - Items must not be modified through the pointers it produces, as
+//     that may break the order.
+//
+// Example:
+//   csortedlist *sl = csortedlist_create(ctype_int());
+//   csortedlist_insert(sl, WRAP_INT(30));
+//   csortedlist_insert(sl, WRAP_INT(10));
+//   csortedlist_insert(sl, WRAP_INT(20));
+//   // sl is [10, 20, 30]
+//   int second = *(const int *) csortedlist_get(sl, 1);  // 20
+typedef struct csortedlist csortedlist;
+
+// csortedlist_visit is a function applied to the items of a range of sl
+//   [see csortedlist_foreach_range].
+// parameters:
+//   - sl: the csortedlist containing item (may be used for context or
+//         ignored)
+//   - item: the item being visited
+//   - args: optional external data (may be NULL)
+// requires: sl and item are not NULL
+typedef void (*csortedlist_visit)(const csortedlist *sl,
+                                  const void *item,
+                                  const void *args);
+
+// Method alias
+#define csortedlist_length csortedlist_size
+#define csortedlist_add csortedlist_insert
+#define csortedlist_find csortedlist_index
+
+// csortedlist_create(type) creates an empty csortedlist of items of type.
+// requires: type is not NULL
+// effects: allocates heap memory [caller must free with csortedlist_destroy]
+csortedlist *csortedlist_create(const ctype *type);
+
+// csortedlist_destroy(sl) frees sl and its items from the heap memory.
+// effects: frees heap memory [sl becomes invalid]
+// note: if sl is NULL, no operation is performed
+void csortedlist_destroy(csortedlist *sl);
+
+// csortedlist_clear(sl) removes all items from sl.
+// requires: sl is not NULL
+// effects: modifies sl, frees heap memory
+void csortedlist_clear(csortedlist *sl);
+
+// csortedlist_print(sl) displays the items of sl in order.
+// requires: sl is not NULL
+// effects: produces output
+void csortedlist_print(const csortedlist *sl);
+
+// csortedlist_type(sl) produces the ctype of the items in sl.
+// requires: sl is not NULL
+const ctype *csortedlist_type(const csortedlist *sl);
+
+// csortedlist_size(sl) produces the number of items in sl.
+// requires: sl is not NULL
+size_t csortedlist_size(const csortedlist *sl);
+
+// csortedlist_empty(sl) produces true if sl is empty and false otherwise.
+// requires: sl is not NULL
+bool csortedlist_empty(const csortedlist *sl);
+
+// csortedlist_insert(sl, item) inserts a deep copy of item into sl after
+//   all items equal to it, and produces its index.
+// requires: sl and item are not NULL
+// effects: modifies sl, allocates heap memory
+// time: O(log n)
+size_t csortedlist_insert(csortedlist *sl, const void *item);
+
+// csortedlist_get(sl, index) produces the item at index of sl, the item
+//   with index smaller items before it.
+// requires: sl is not NULL
+//           0 <= index < csortedlist_size(sl)
+// time: O(log n)
+// note: the item is invalidated by any insertion or removal
+const void *csortedlist_get(const csortedlist *sl, size_t index);
+
+// csortedlist_lower_bound(sl, item) produces the index of the first item
+//   in sl that is not less than item, or csortedlist_size(sl) if there is
+//   none; csortedlist_upper_bound(sl, item) produces the index of the
+//   first item that is greater than item.
+// requires: sl and item are not NULL
+// time: O(log n)
+size_t csortedlist_lower_bound(const csortedlist *sl, const void *item);
+size_t csortedlist_upper_bound(const csortedlist *sl, const void *item);
+
+// csortedlist_equal_range(sl, item, from_index, to_index) stores the
+//   bounds of the items equal to item in sl at from_index and to_index
+//   [see calist_equal_range].
+// requires: sl, item, from_index and to_index are not NULL
+// effects: modifies *from_index and *to_index
+// time: O(log n)
+void csortedlist_equal_range(const csortedlist *sl, const void *item,
+                             size_t *from_index, size_t *to_index);
+
+// csortedlist_index(sl, item) produces the index of the first item in sl
+//   equal to item, or CALIST_INDEX_NOT_FOUND if there is none.
+// requires: sl and item are not NULL
+// time: O(log n)
+size_t csortedlist_index(const csortedlist *sl, const void *item);
+
+// csortedlist_contains(sl, item) produces true if sl contains an item
+//   equal to item, and false otherwise.
+// requires: sl and item are not NULL
+// time: O(log n)
+bool csortedlist_contains(const csortedlist *sl, const void *item);
+
+// csortedlist_count(sl, item) produces the number of items in sl equal to
+//   item.
+// requires: sl and item are not NULL
+// time: O(log n)
+size_t csortedlist_count(const csortedlist *sl, const void *item);
+
+// csortedlist_pop(sl, index) removes the item at index from sl.
+// requires: sl is not NULL
+//           0 <= index < csortedlist_size(sl)
+// effects: modifies sl, frees heap memory
+// time: O(log n)
+void csortedlist_pop(csortedlist *sl, size_t index);
+
+// csortedlist_remove(sl, item) removes the first item in sl equal to item
+//   and produces its index, or CALIST_INDEX_NOT_FOUND if there is none.
+// requires: sl and item are not NULL
+// effects: may modify sl and free heap memory
+// time: O(log n)
+size_t csortedlist_remove(csortedlist *sl, const void *item);
+
+// csortedlist_remove_range(sl, from_index, to_index) removes the items
+//   from from_index (inclusive) to to_index (exclusive) from sl.
+// requires: sl is not NULL
+//           from_index <= to_index <= csortedlist_size(sl)
+// effects: modifies sl, frees heap memory
+// time: O(k log n) for k removed items
+void csortedlist_remove_range(csortedlist *sl, size_t from_index,
+                              size_t to_index);
+
+// csortedlist_foreach_range(sl, from_index, to_index, visit, args) applies
+//   visit to the items of sl from from_index (inclusive) to to_index
+//   (exclusive) in order, where args provides additional arguments to the
+//   visit function.
+// requires: sl and visit are not NULL
+//           from_index <= to_index <= csortedlist_size(sl)
+// time: O(log n + k) for k visited items
+void csortedlist_foreach_range(const csortedlist *sl, size_t from_index,
+                               size_t to_index, csortedlist_visit visit,
+                               const void *args);
+
+// csortedlist_to_calist(sl) produces a calist holding copies of the items
+//   of sl in order.
+// requires: sl is not NULL
+// effects: allocates heap memory [caller must free with calist_destroy]
+calist *csortedlist_to_calist(const csortedlist *sl);
+
+#endif
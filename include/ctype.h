@@ -8,17 +8,48 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include "callocator.h"
 
 // A ctype describes a type for use in generic storage ADTs.
 // attributes:
 //   - size:    the size in bytes of the associated data
+//   - pod:     true if values are fixed-size and trivially copyable
+//              (a value is fully duplicated by copying its size bytes),
+//              allowing storage ADTs to keep them inline
 // methods:
 //   - dup:     creates a deep copy of the given value (heap-allocated),
 //              returns NULL if allocation fails
 //   - destroy: frees a value previously created by dup
 //   - print:   displays a human-readable representation of the value
+//   - format:  (optional) writes the text that print displays into a 
+//              buffer of the given capacity if it fits, and produces its 
+//              length in characters either way [like snprintf, but 
+//              without a null terminator]
 //   - cmp:     compares two items, item1 and item2
 //              returns 0 if equal, <0 if item1 < item2, >0 if item1 > item2
+//   - hash:    (optional) produces a hash code for the given value;
+//              values that are equal under cmp must have equal hash codes
+//   - dup_with:     (optional) like dup, but allocates from the given
+//                   callocator
+//   - destroy_with: (optional) frees a value previously created by 
+//                   dup_with with the same callocator
+//   POD ctypes and the string ctype are allocator-aware without these
+//   methods; other ctypes without them always use dup and destroy
+//   - serialize:   (optional) writes a byte encoding of the given value
+//                  into a buffer of the given capacity if it fits, and 
+//                  produces its length in bytes either way [like snprintf]
+//   - deserialize: (optional) creates a value like dup from an encoding of
+//                  the given length produced by serialize, returns NULL if
+//                  the encoding is invalid or allocation fails
+//   POD ctypes are serialized as their size bytes without these methods,
+//   and the built-in string ctypes as their characters
+// storage support (built-in string ctypes only):
+//   - slots:     a fixed-size slot representation that storage ADTs may
+//                keep inline instead of a pointer to a duplicate
+//                [see data_slot_size]
+//   - canonical: equal values are represented by one canonical pointer,
+//                and the canonical pointer of any value can be looked up
+//                [see data_canonical]
 // note: clients must create only one instance of a given ctype;
 //       all uses of the same type must refer to the same ctype pointer
 typedef struct ctype ctype;
@@ -44,6 +75,65 @@ ctype *ctype_create(size_t size,
                     void (*print)(const void *),
                     int (*cmp)(const void *, const void *));
 
+// ctype_create_pod(size, print, cmp) creates a ctype for fixed-size, 
+//   trivially copyable values of the given size. Values are duplicated by 
+//   copying size bytes and freed with free.
+// requires: size > 0
+//           print, cmp are not NULL
+// effects: allocates heap memory [caller must free with ctype_destroy]
+ctype *ctype_create_pod(size_t size,
+                        void (*print)(const void *),
+                        int (*cmp)(const void *, const void *));
+
+// ctype_create_slab(size, print, cmp) creates a POD ctype like 
+//   ctype_create_pod, whose values are duplicated into a slab owned by 
+//   the ctype instead of separate malloc blocks [see 
+//   callocator_create_slab]. Each value takes size bytes rounded up to a
+//   multiple of sizeof(void *), and freed values are reused by later 
+//   duplicates.
+// requires: size > 0
+//           print, cmp are not NULL
+// effects: allocates heap memory [caller must free with ctype_destroy]
+// note: ctype_destroy frees all values of the ctype, which must no 
+//       longer be used
+//       values of the ctype must not be duplicated or destroyed 
+//       concurrently
+ctype *ctype_create_slab(size_t size,
+                         void (*print)(const void *),
+                         int (*cmp)(const void *, const void *));
+
+// ctype_set_hash(type, hash) sets the hash method of type to hash 
+//   (see ctype documentation above). A NULL hash removes the method.
+// requires: type is not NULL
+// effects: modifies type
+void ctype_set_hash(ctype *type, size_t (*hash)(const void *));
+
+// ctype_set_alloc(type, dup_with, destroy_with) sets the allocator-aware
+//   methods of type (see ctype documentation above). NULL methods remove
+//   them.
+// requires: dup_with and destroy_with are both NULL or both not NULL
+// effects: modifies type
+void ctype_set_alloc(ctype *type,
+                     void *(*dup_with)(const void *, const callocator *),
+                     void (*destroy_with)(void *, const callocator *));
+
+// ctype_set_format(type, format) sets the format method of type to format
+//   (see ctype documentation above). A NULL format removes the method.
+// requires: type is not NULL
+// effects: modifies type
+void ctype_set_format(ctype *type, 
+                      size_t (*format)(const void *, char *, size_t));
+
+// ctype_set_serialize(type, serialize, deserialize) sets the 
+//   serialization methods of type (see ctype documentation above). NULL
+//   methods remove them.
+// requires: type is not NULL
+//           serialize and deserialize are both NULL or both not NULL
+// effects: modifies type
+void ctype_set_serialize(ctype *type,
+                         size_t (*serialize)(const void *, void *, size_t),
+                         void *(*deserialize)(const void *, size_t));
+
 // ctype_destroy(type) frees type from the heap memory.
 // effects: frees heap memory [type becomes invalid]
 void ctype_destroy(ctype *type);
@@ -54,6 +144,33 @@ void ctype_destroy(ctype *type);
 // note: ctype_equals only compares addresses of t1 and t2
 bool ctype_equals(const ctype *t1, const ctype *t2);
 
+// ctype_is_pod(type) produces true if values of type are fixed-size and
+//   trivially copyable, and false otherwise.
+// requires: type is not NULL
+bool ctype_is_pod(const ctype *type);
+
+// ctype_has_hash(type) produces true if type has a hash method, 
+//   and false otherwise.
+// requires: type is not NULL
+bool ctype_has_hash(const ctype *type);
+
+// ctype_has_format(type) produces true if type has a format method, 
+//   and false otherwise.
+// requires: type is not NULL
+bool ctype_has_format(const ctype *type);
+
+// ctype_has_serialize(type) produces true if values of type can be 
+//   serialized [type is POD or has serialization methods], and false 
+//   otherwise.
+// requires: type is not NULL
+bool ctype_has_serialize(const ctype *type);
+
+// ctype_is_string(type) produces true if values of type are 
+//   null-terminated strings, passed as pointers to their first character
+//   [see the string ctypes below], and false otherwise.
+// requires: type is not NULL
+bool ctype_is_string(const ctype *type);
+
 // data_size(type) produces the data size of type in bytes.
 // requires: type is not NULL
 size_t data_size(const ctype *type);
@@ -71,6 +188,24 @@ void *data_dup(const void *value, const ctype *type);
 // effects: frees heap memory [value becomes invalid]
 void data_destroy(void *value, const ctype *type);
 
+// data_dup_with(value, type, alloc) creates a deep copy of value in 
+//   memory from alloc, using the dup_with method of type if it has one.
+//   Values of POD ctypes are copied directly into memory from alloc, and
+//   other values fall back to the dup method. With callocator_default(),
+//   data_dup_with is data_dup.
+// requires: type and alloc are not NULL
+// effects: allocates memory [caller must free with data_destroy_with]
+// note: returns NULL if value is NULL or allocation fails
+void *data_dup_with(const void *value, const ctype *type,
+                    const callocator *alloc);
+
+// data_destroy_with(value, type, alloc) frees value, previously created by
+//   data_dup_with(..., type, alloc).
+// requires: type and alloc are not NULL
+// effects: frees memory [value becomes invalid]
+void data_destroy_with(void *value, const ctype *type,
+                       const callocator *alloc);
+
 // data_print(value, type) displays value using the print method of type.
 // requires: type is not NULL
 // effects: produces output [if value is not NULL]
@@ -82,9 +217,137 @@ void data_print(const void *value, const ctype *type);
 // requires: item1, item2, and type are not NULL
 int data_cmp(const void *item1, const void *item2, const ctype *type);
 
+// CALIST_STATS selects whether the library counts its operations for
+//   ctype_stats and calist_stats: 0 [the default] compiles the counters 
+//   out, and 1 enables them [see "make STATS=1"]. Only the library itself
+//   needs to be built with it.
+#ifndef CALIST_STATS
+#define CALIST_STATS 0
+#endif
+
+// ctype_counters counts the calls of the data functions on values of all
+//   ctypes, from all threads, while CALIST_STATS is enabled.
+// fields:
+//   - dups:     values created by data_dup or data_dup_with
+//   - destroys: values freed by data_destroy or data_destroy_with
+//   - cmps:     comparisons by data_cmp [the specialized kernels for the
+//               built-in ctypes compare without it]
+typedef struct {
+  size_t dups;
+  size_t destroys;
+  size_t cmps;
+} ctype_counters;
+
+// ctype_stats(out) stores the global counters of the data functions in 
+//   out, which are all 0 unless CALIST_STATS is enabled.
+// requires: out is not NULL
+// effects: modifies *out
+void ctype_stats(ctype_counters *out);
+
+// ctype_stats_reset() sets the global counters of the data functions 
+//   to 0.
+// effects: modifies the global counters
+void ctype_stats_reset(void);
+
+// data_format(item, buf, cap, type) writes the text of item into buf if
+//   it takes at most cap characters, and produces its length.
+// requires: item and type are not NULL
+//           buf is not NULL if cap > 0
+//           type has a format method [see ctype_has_format]
+// effects: may modify buf
+size_t data_format(const void *item, char *buf, size_t cap, 
+                   const ctype *type);
+
+// data_hash(item, type) produces the hash code of item using the hash 
+//   method of type.
+// requires: item and type are not NULL
+//           type has a hash method [see ctype_has_hash]
+size_t data_hash(const void *item, const ctype *type);
+
+// data_serialize(item, buf, cap, type) writes the encoding of item into 
+//   buf if it takes at most cap bytes, and produces its length in bytes.
+// requires: item and type are not NULL
+//           buf is not NULL if cap > 0
+//           ctype_has_serialize(type)
+// effects: may modify buf
+size_t data_serialize(const void *item, void *buf, size_t cap,
+                      const ctype *type);
+
+// data_deserialize(buf, len, type) creates a value of type from the 
+//   encoding of len bytes at buf produced by data_serialize.
+// requires: type is not NULL
+//           buf is not NULL if len > 0
+//           ctype_has_serialize(type)
+// effects: allocates heap memory [caller must free with data_destroy]
+// note: returns NULL if the encoding is invalid or allocation fails
+void *data_deserialize(const void *buf, size_t len, const ctype *type);
+
+// data_slot_size(type) produces the size in bytes of the slot 
+//   representation of type, or 0 if type has none. A slot holds a value 
+//   directly and can be moved with memcpy, but must be filled with 
+//   data_slot_store and emptied with data_slot_release.
+// requires: type is not NULL
+size_t data_slot_size(const ctype *type);
+
+// data_slot_store(slot, value, type, alloc) stores a deep copy of value 
+//   into the empty slot, drawing any memory it needs from alloc.
+// requires: slot, value, type and alloc are not NULL
+//           data_slot_size(type) > 0
+// effects: modifies slot, may allocate memory
+// note: returns false if allocation fails [slot remains empty]
+bool data_slot_store(void *slot, const void *value, const ctype *type,
+                     const callocator *alloc);
+
+// data_slot_value(slot, type) produces the value held by slot.
+// requires: slot and type are not NULL
+//           data_slot_size(type) > 0
+// note: the value may point into slot and is invalidated if slot moves
+const void *data_slot_value(const void *slot, const ctype *type);
+
+// data_slot_release(slot, type, alloc) frees the value held by slot, 
+//   previously stored with the same alloc, leaving slot empty.
+// requires: slot, type and alloc are not NULL
+//           data_slot_size(type) > 0
+// effects: may free memory
+void data_slot_release(void *slot, const ctype *type, 
+                       const callocator *alloc);
+
+// data_slot_find(slots, n, value, type) produces the index of the first 
+//   of the n consecutive slots at slots holding a value equal to value, 
+//   or n if there is none; data_slot_find_last(slots, n, value, type) 
+//   produces the index of the last one, and data_slot_count(slots, n, 
+//   value, type) the number of them. Equality matches the cmp method of
+//   type, but uses the slot representation directly.
+// requires: value and type are not NULL
+//           slots is not NULL if n > 0
+//           data_slot_size(type) > 0
+size_t data_slot_find(const void *slots, size_t n, const void *value,
+                      const ctype *type);
+size_t data_slot_find_last(const void *slots, size_t n, const void *value,
+                           const ctype *type);
+size_t data_slot_count(const void *slots, size_t n, const void *value,
+                       const ctype *type);
+
+// ctype_has_canonical(type) produces true if equal values of type are 
+//   represented by one canonical pointer, and false otherwise.
+// requires: type is not NULL
+bool ctype_has_canonical(const ctype *type);
+
+// data_canonical(value, type) produces the canonical pointer of the 
+//   values equal to value, or NULL if no such value currently exists. Two
+//   values created by data_dup are equal exactly if they are the same
+//   pointer.
+// requires: value and type are not NULL
+//           ctype_has_canonical(type)
+const void *data_canonical(const void *value, const ctype *type);
+
 // The following methods each produce a shared singleton ctype ADT
 //   for common built-in C types.
 // note: the returned pointer must not be freed
+//       all built-in ctypes have a hash method; floating-point hashes
+//       treat -0.0 and 0.0 as the same value, and all NaNs as one value
+//       all built-in ctypes have a format method, matching the printf
+//       conversions %d, %ld, %c, %zu and %g, "true"/"false", and %s
 // === Integral types ===
 const ctype *ctype_int(void);
 const ctype *ctype_long(void);
@@ -94,7 +357,16 @@ const ctype *ctype_size_t(void);
 // === Floating-point types ===
 const ctype *ctype_float(void);
 const ctype *ctype_double(void);
-// === String type ===
+// === String types ===
+// ctype_string(): each value is a separate heap copy
+// ctype_sso_string(): strings of up to 22 characters are kept directly in
+//   a slot of inline storage with their length; longer ones are heap 
+//   copies owned by the slot
+// ctype_interned_string(): values are canonical copies in a shared, 
+//   reference-counted intern table, so equal values share storage and 
+//   compare equal by pointer [the intern table is not thread-safe]
 const ctype *ctype_string(void);
+const ctype *ctype_sso_string(void);
+const ctype *ctype_interned_string(void);
 
 #endif
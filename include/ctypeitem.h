@@ -6,21 +6,56 @@
 #include <stdbool.h>
 #include "ctype.h"
 
-#define CTYPEITEM(value, type) (ctypeitem_create(value, type))
+// The largest values of POD ctypes that a ctypeitem holds inline
+#define CTYPEITEM_INLINE_SIZE 16
 
-// A ctypeitem stores a value and its associated ctype.
-typedef struct ctypeitem ctypeitem;
+// CTYPEITEM(value, type) produces a temporary ctypeitem that refers to
+//   value without copying it, for passing values to the valist functions.
+//   The ctypeitem lives until the end of the enclosing block and must not
+//   be destroyed.
+// requires: value and type are not NULL
+#define CTYPEITEM(value, type) \
+  (&(ctypeitem) { (type), CTYPEITEM_BORROWED, { .ptr = (void *) (value) } })
+
+// ctypeitem_storage describes where the value of a ctypeitem lives.
+//   - CTYPEITEM_INLINE:   the value of a POD ctype of at most
+//                         CTYPEITEM_INLINE_SIZE bytes, held in the
+//                         ctypeitem itself
+//   - CTYPEITEM_HEAP:     a heap copy of the value owned by the ctypeitem
+//   - CTYPEITEM_BORROWED: a value owned by the client [see CTYPEITEM]
+typedef enum {
+  CTYPEITEM_INLINE,
+  CTYPEITEM_HEAP,
+  CTYPEITEM_BORROWED,
+} ctypeitem_storage;
 
-// ctypeitem_create(value, type) creates a ctypeitem with the given
+// A ctypeitem stores a value and its associated ctype: the ctype is the
+//   tag of the value, and small scalars are stored in the payload instead
+//   of a separate heap block.
+// note: the layout is public only so that CTYPEITEM can create items on
+//       the stack; use the functions below instead of the fields
+typedef struct ctypeitem {
+  const ctype *type;
+  ctypeitem_storage storage;
+  union {
+    unsigned char bytes[CTYPEITEM_INLINE_SIZE];
+    void *ptr;
+    long double align;  // aligns bytes for any scalar
+  } payload;
+} ctypeitem;
+
+// ctypeitem_create(value, type) creates a ctypeitem with a deep copy of
 //   value and type.
 // requires: value and type are not NULL
 // effects: allocates heap memory [caller must free with ctypeitem_destroy]
 ctypeitem *ctypeitem_create(const void *value, const ctype *type);
 
-// ctypeitem_destroy(item) frees the value of item from the heap memory.
-// requires: item is not NULL
-// effects: frees heap memory
+// ctypeitem_destroy(item) frees item and its value from the heap memory,
+//   and produces NULL.
+// requires: item was created by ctypeitem_create or ctypeitem_dup
+// effects: frees heap memory [item becomes invalid]
 // note: the ctype associated with item will not be freed
+//       if item is NULL, no operation is performed
 ctypeitem *ctypeitem_destroy(ctypeitem *item);
 
 // ctypeitem_dup(item) creates a deep copy of item.
@@ -35,10 +70,22 @@ bool ctypeitem_equals(const ctypeitem *i1, const ctypeitem *i2);
 
 // ctypeitem_value(item) produces a constant pointer to the value of item.
 // requires: item is not NULL
+// note: for inline values, the pointer points into item
 const void *ctypeitem_value(const ctypeitem *item);
 
+// ctypeitem_value_mutable(item) produces a mutable pointer to the value
+//   of item.
+// requires: item is not NULL
+// note: for inline values, the pointer points into item
+void *ctypeitem_value_mutable(ctypeitem *item);
+
 // ctypeitem_type(item) produces the ctype associated with item.
 // requires: item is not NULL
 const ctype *ctypeitem_type(const ctypeitem *item);
 
+// ctypeitem_print(item) displays the value of item using its ctype.
+// requires: item is not NULL
+// effects: produces output
+void ctypeitem_print(const ctypeitem *item);
+
 #endif
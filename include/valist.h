@@ -6,15 +6,22 @@
 #include "ctypeitem.h"
 
 // A valist stores items in a dynamically resizable array,
-// with all items deeply copied into heap memory.
+// with all items deeply copied into memory owned by the valist.
 //
 // A valist may contain values of any types. Each valist item contains both 
 // a value and an associated ctype, achieving similar functionality of 
 // a mixed-type list in Python or other dynamically-typed languages.
 //
+// Layout:
+//   Items are ctypeitem records stored contiguously in the array, each
+//   holding the ctype of the item as its tag. Values of POD ctypes of at
+//   most CTYPEITEM_INLINE_SIZE bytes (all built-in numeric ctypes) are 
+//   stored in the record itself, without a heap allocation; larger and 
+//   non-POD values are deeply copied into the heap.
+//
 // Memory model:
-//   - All inserted items are deeply copied into separately allocated 
-//     heap memory.
+//   - All inserted items are deeply copied into the valist, inline or 
+//     into separately allocated heap memory.
 //   - Stack-allocated or heap-allocated objects are both safe to insert;
 //     the valist duplicates them internally.
 //   - Stored items are automatically freed when individually removed or
@@ -24,7 +31,7 @@
 //
 // Example:
 //   int temp = 10;
-//   // Deep-copied onto heap
+//   // Copied into the record of the new item
 //   valist_append(al, CTYPEITEM(&temp, ctype_int()));
 //
 //   int *ptr = malloc(sizeof(*ptr));
@@ -76,7 +83,7 @@ extern const size_t VALIST_INDEX_NOT_FOUND;
 
 // valist_create() creates an empty valist.
 // effects: allocates heap memory [caller must free with valist_destroy]
-valist *valist_create();
+valist *valist_create(void);
 
 // valist_destroy(al) frees al and its items from the heap memory.
 // effects: frees heap memory [al becomes invalid]
@@ -140,6 +147,8 @@ void valist_reclaim(valist *al);
 //   - valist_get protects the contents of al by returning a 
 //     constant ctypeitem, preventing direct modification
 //   - call valist_get_mutable to modify an item in-place
+//   - the ctypeitem is a view of the record in al, not a copy; it is 
+//     invalidated by any operation that adds, removes or moves items
 const ctypeitem *valist_get(const valist *al, size_t index);
 
 // valist_get_mutable(al, index) produces a mutable ctypeitem to the item 
@@ -148,6 +157,8 @@ const ctypeitem *valist_get(const valist *al, size_t index);
 //           0 <= index < valist_size(al)
 // warning: do not free the returned pointer, as doing so will result
 //          in a double free when removing the item or destroying al
+// note: modify the value through ctypeitem_value_mutable; the ctypeitem
+//       is invalidated like the one from valist_get
 ctypeitem *valist_get_mutable(const valist *al, size_t index);
 
 // valist_set(al, index, new_item) replaces the old item at the given 
@@ -189,7 +200,7 @@ void valist_insert_front(valist *al, const ctypeitem *item);
 
 // valist_insert_all(al, index, src) inserts all items in src before the 
 //   given index position in al.
-// requires: al and src are not NULL and have the same type
+// requires: al and src are not NULL
 //           0 <= index <= valist_size(al)
 // effects: modifies al, allocates heap memory
 void valist_insert_all(valist *al, size_t index, const valist *src);
@@ -271,7 +282,7 @@ valist *valist_index_all_if(const valist *al, valist_pred pred,
 // valist_count(al, item) produces the total number of occurrences 
 //   of item in al.
 // requires: al and item are not NULL
-size_t valist_count(const valist *al, const void *item);
+size_t valist_count(const valist *al, const ctypeitem *item);
 
 // valist_replace(al, old_item, new_item) replaces the first occurrence of 
 //   old_item in al with new_item.
@@ -347,4 +358,59 @@ valist *valist_unique(const valist *al);
 // note: returns the number of duplicate items removed
 size_t valist_remove_dup(valist *al);
 
+// valist_set_columnar(al, columnar) turns the columnar mode of al on or 
+//   off. A columnar valist also keeps the items of each ctype in a column 
+//   of their positions, with dense copies of the values of POD ctypes, so 
+//   that scans for one ctype read only the items of that ctype:
+//   - valist_count, valist_contains, valist_index, valist_index_last and 
+//     valist_index_all compare against the column of the item's ctype, 
+//     with vectorized kernels for the built-in numeric ctypes
+//   - valist_count_type, valist_count_type_if, valist_filter_type and 
+//     valist_foreach_type visit only the column of the given ctype
+// requires: al is not NULL
+// effects: modifies al, may allocate or free heap memory
+// notes:
+//   - the mode affects only speed and memory use, never the results
+//   - appending keeps the columns up to date; any other modification 
+//     makes them stale, and the next such scan rebuilds them in O(n)
+//   - as that rebuild modifies al, a columnar valist must not be read 
+//     from several threads at once
+void valist_set_columnar(valist *al, bool columnar);
+
+// valist_columnar(al) produces true if al is in columnar mode, and false 
+//   otherwise.
+// requires: al is not NULL
+bool valist_columnar(const valist *al);
+
+// valist_count_type(al, type) produces the number of items of type in al.
+// requires: al and type are not NULL
+// time: O(1) in columnar mode with current columns, O(n) otherwise
+size_t valist_count_type(const valist *al, const ctype *type);
+
+// valist_count_type_if(al, type, pred, args) produces the number of items 
+//   of type in al that satisfy pred, where args provides additional 
+//   arguments to the pred function.
+// requires: al, type and pred are not NULL
+// note: in columnar mode, pred receives a temporary view of the value 
+//       that is valid only during the call
+size_t valist_count_type_if(const valist *al, const ctype *type, 
+                            valist_pred pred, const void *args);
+
+// valist_filter_type(al, type, pred, args) produces a valist containing 
+//   the items of type in al that satisfy pred, where args provides 
+//   additional arguments to the pred function.
+// requires: al, type and pred are not NULL
+// effects: allocates heap memory [caller must free with valist_destroy]
+// note: see valist_count_type_if
+valist *valist_filter_type(const valist *al, const ctype *type, 
+                           valist_pred pred, const void *args);
+
+// valist_foreach_type(al, type, map, args) applies map to each item of 
+//   type in al, where args provides additional arguments to the map 
+//   function.
+// requires: al, type and map are not NULL
+// effects: may modify item [see valist_map documentation]
+void valist_foreach_type(const valist *al, const ctype *type, 
+                         valist_map map, const void *args);
+
 #endif
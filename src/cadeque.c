@@ -0,0 +1,434 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "cadeque.h"
+#include "cerror.h"
+#include "ckernel.h"
+
+// The capacity of a cadeque on its first insertion
+#define MIN_CAPACITY 8
+
+struct cadeque {
+  const ctype *type;
+  size_t width;           // the size of a slot in bytes
+  bool boxed;             // true if slots hold pointers to the items
+  ckernel_kind kernel;    // CKERNEL_NONE unless inline with a built-in ctype
+  unsigned char *data;
+  size_t capacity;        // 0 or a power of 2
+  size_t head;            // the slot of index 0
+  size_t size;
+};
+
+// Assertion messages
+static const char *ASSERT_CADEQUE_NOT_EMPTY
+  = "cadeque cannot be empty!";
+static const char *ASSERT_INDEX_BOUNDED
+  = "index must be less than the size of cadeque!";
+static const char *ASSERT_INDEX_BOUNDED_INCLUSIVE
+  = "index must not exceed the size of cadeque!";
+
+// Helper function declaration
+static inline unsigned char *slot_at(const cadeque *dq, size_t index);
+static inline void *slot_item(const cadeque *dq, const void *slot);
+static void store_slot(const cadeque *dq, void *slot, const void *item);
+static void release_slot(const cadeque *dq, void *slot);
+static size_t index_of(const cadeque *dq, const void *p);
+static void resize(cadeque *dq, size_t capacity);
+static const void *make_room(cadeque *dq, const void *item);
+static void move_slots(cadeque *dq, size_t to, size_t from, size_t count);
+
+cadeque *cadeque_create(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+
+  cadeque *dq = malloc(sizeof(*dq));
+  if (!dq) {
+    ALLOC_ERROR("cadeque");
+  }
+  dq->type = type;
+  dq->boxed = !ctype_is_pod(type);
+  dq->width = dq->boxed ? sizeof(void *) : data_size(type);
+  dq->kernel = dq->boxed ? CKERNEL_NONE : ckernel_select(type);
+  dq->data = NULL;
+  dq->capacity = 0;
+  dq->head = 0;
+  dq->size = 0;
+  return dq;
+}
+
+void cadeque_destroy(cadeque *dq) {
+  if (!dq) return;
+
+  cadeque_clear(dq);
+  free(dq->data);
+  free(dq);
+}
+
+void cadeque_clear(cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+
+  if (dq->boxed) {
+    for (size_t i = 0; i < dq->size; ++i) {
+      release_slot(dq, slot_at(dq, i));
+    }
+  }
+  dq->head = 0;
+  dq->size = 0;
+}
+
+void cadeque_print(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+
+  printf("[");
+  for (size_t i = 0; i < dq->size; ++i) {
+    if (i != 0) {
+      printf(", ");
+    }
+    data_print(slot_item(dq, slot_at(dq, i)), dq->type);
+  }
+  printf("]\n");
+}
+
+bool cadeque_equals(const cadeque *d1, const cadeque *d2) {
+  ASSERT_NOT_NULL(d1, "The first cadeque");
+  ASSERT_NOT_NULL(d2, "The second cadeque");
+
+  if (d1->size != d2->size || !ctype_equals(d1->type, d2->type)) {
+    return false;
+  }
+  for (size_t i = 0; i < d1->size; ++i) {
+    if (data_cmp(slot_item(d1, slot_at(d1, i)),
+                 slot_item(d2, slot_at(d2, i)), d1->type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const ctype *cadeque_type(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  return dq->type;
+}
+
+size_t cadeque_size(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  return dq->size;
+}
+
+bool cadeque_empty(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  return dq->size == 0;
+}
+
+size_t cadeque_capacity(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  return dq->capacity;
+}
+
+void cadeque_reserve(cadeque *dq, size_t n) {
+  ASSERT_NOT_NULL(dq, NULL);
+
+  if (n <= dq->capacity) return;
+  size_t capacity = dq->capacity ? dq->capacity : MIN_CAPACITY;
+  while (capacity < n) {
+    if (capacity > SIZE_MAX / 2) {
+      ALLOC_ERROR("cadeque");
+    }
+    capacity *= 2;
+  }
+  resize(dq, capacity);
+}
+
+void cadeque_reclaim(cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+
+  if (dq->size == 0) {
+    free(dq->data);
+    dq->data = NULL;
+    dq->capacity = 0;
+    dq->head = 0;
+    return;
+  }
+  size_t capacity = 1;
+  while (capacity < dq->size) {
+    capacity *= 2;
+  }
+  if (capacity < dq->capacity) {
+    resize(dq, capacity);
+  }
+}
+
+const void *cadeque_get(const cadeque *dq, size_t index) {
+  return cadeque_get_mutable(dq, index);
+}
+
+void *cadeque_get_mutable(const cadeque *dq, size_t index) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_MSG(index < dq->size, ASSERT_INDEX_BOUNDED);
+  return slot_item(dq, slot_at(dq, index));
+}
+
+const void *cadeque_front(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_MSG(dq->size > 0, ASSERT_CADEQUE_NOT_EMPTY);
+  return slot_item(dq, slot_at(dq, 0));
+}
+
+const void *cadeque_back(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_MSG(dq->size > 0, ASSERT_CADEQUE_NOT_EMPTY);
+  return slot_item(dq, slot_at(dq, dq->size - 1));
+}
+
+void cadeque_set(cadeque *dq, size_t index, const void *new_item) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_NOT_NULL(new_item, "The new item");
+  ASSERT_MSG(index < dq->size, ASSERT_INDEX_BOUNDED);
+
+  // new_item may be the item being replaced
+  unsigned char *slot = slot_at(dq, index);
+  if (!dq->boxed) {
+    memmove(slot, new_item, dq->width);
+    return;
+  }
+  void *old = slot_item(dq, slot);
+  store_slot(dq, slot, new_item);
+  data_destroy(old, dq->type);
+}
+
+void cadeque_push_back(cadeque *dq, const void *item) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_NOT_NULL(item, "The item to be inserted");
+
+  item = make_room(dq, item);
+  store_slot(dq, slot_at(dq, dq->size), item);
+  ++dq->size;
+}
+
+void cadeque_push_front(cadeque *dq, const void *item) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_NOT_NULL(item, "The item to be inserted");
+
+  item = make_room(dq, item);
+  dq->head = (dq->head - 1) & (dq->capacity - 1);
+  store_slot(dq, slot_at(dq, 0), item);
+  ++dq->size;
+}
+
+void cadeque_pop_back(cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_MSG(dq->size > 0, ASSERT_CADEQUE_NOT_EMPTY);
+
+  release_slot(dq, slot_at(dq, dq->size - 1));
+  --dq->size;
+}
+
+void cadeque_pop_front(cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_MSG(dq->size > 0, ASSERT_CADEQUE_NOT_EMPTY);
+
+  release_slot(dq, slot_at(dq, 0));
+  dq->head = (dq->head + 1) & (dq->capacity - 1);
+  --dq->size;
+}
+
+void cadeque_insert(cadeque *dq, size_t index, const void *item) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_NOT_NULL(item, "The item to be inserted");
+  ASSERT_MSG(index <= dq->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  item = make_room(dq, item);
+
+  // An inline item of dq keeps its index among the others, though it may
+  //   move to another slot
+  size_t at = index_of(dq, item);
+  if (index < dq->size - index) {
+    dq->head = (dq->head - 1) & (dq->capacity - 1);
+    move_slots(dq, 0, 1, index);
+  } else {
+    move_slots(dq, index + 1, index, dq->size - index);
+  }
+  ++dq->size;
+  if (at != CALIST_INDEX_NOT_FOUND) {
+    item = slot_at(dq, (at < index) ? at : at + 1);
+  }
+  store_slot(dq, slot_at(dq, index), item);
+}
+
+void cadeque_pop(cadeque *dq, size_t index) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_MSG(index < dq->size, ASSERT_INDEX_BOUNDED);
+
+  release_slot(dq, slot_at(dq, index));
+  if (index < dq->size - 1 - index) {
+    move_slots(dq, 1, 0, index);
+    dq->head = (dq->head + 1) & (dq->capacity - 1);
+  } else {
+    move_slots(dq, index, index + 1, dq->size - 1 - index);
+  }
+  --dq->size;
+}
+
+size_t cadeque_index(const cadeque *dq, const void *item) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_NOT_NULL(item, "The item to be searched");
+
+  if (dq->kernel != CKERNEL_NONE && dq->size > 0) {
+    // The items form at most two runs: from head to the end of the array,
+    //   then from its start
+    size_t first = dq->capacity - dq->head;
+    if (first > dq->size) {
+      first = dq->size;
+    }
+    size_t i = ckernel_find(dq->kernel, slot_at(dq, 0), first, item);
+    if (i < first) {
+      return i;
+    }
+    size_t rest = dq->size - first;
+    i = ckernel_find(dq->kernel, dq->data, rest, item);
+    return (i < rest) ? first + i : CALIST_INDEX_NOT_FOUND;
+  }
+
+  for (size_t i = 0; i < dq->size; ++i) {
+    if (data_cmp(slot_item(dq, slot_at(dq, i)), item, dq->type) == 0) {
+      return i;
+    }
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+bool cadeque_contains(const cadeque *dq, const void *item) {
+  return cadeque_index(dq, item) != CALIST_INDEX_NOT_FOUND;
+}
+
+void cadeque_foreach(const cadeque *dq, cadeque_visit visit,
+                     const void *args) {
+  ASSERT_NOT_NULL(dq, NULL);
+  ASSERT_NOT_NULL(visit, NULL);
+
+  for (size_t i = 0; i < dq->size; ++i) {
+    visit(dq, slot_item(dq, slot_at(dq, i)), args);
+  }
+}
+
+cadeque *cadeque_from_calist(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  cadeque *dq = cadeque_create(calist_type(al));
+  size_t n = calist_size(al);
+  cadeque_reserve(dq, n);
+  for (size_t i = 0; i < n; ++i) {
+    store_slot(dq, slot_at(dq, i), calist_get_unchecked(al, i));
+  }
+  dq->size = n;
+  return dq;
+}
+
+calist *cadeque_to_calist(const cadeque *dq) {
+  ASSERT_NOT_NULL(dq, NULL);
+
+  calist *al = calist_create_size(dq->type, dq->size ? dq->size : 1);
+  for (size_t i = 0; i < dq->size; ++i) {
+    calist_append(al, slot_item(dq, slot_at(dq, i)));
+  }
+  return al;
+}
+
+// Helper function implementation
+static inline unsigned char *slot_at(const cadeque *dq, size_t index) {
+  return dq->data + ((dq->head + index) & (dq->capacity - 1)) * dq->width;
+}
+
+static inline void *slot_item(const cadeque *dq, const void *slot) {
+  if (!dq->boxed) {
+    return (void *) slot;
+  }
+  void *item;
+  memcpy(&item, slot, sizeof(item));
+  return item;
+}
+
+// Fill slot with a deep copy of item
+static void store_slot(const cadeque *dq, void *slot, const void *item) {
+  if (!dq->boxed) {
+    memcpy(slot, item, dq->width);
+    return;
+  }
+  void *copy = data_dup(item, dq->type);
+  if (!copy) {
+    ALLOC_ERROR("cadeque item");
+  }
+  memcpy(slot, &copy, sizeof(copy));
+}
+
+static void release_slot(const cadeque *dq, void *slot) {
+  if (dq->boxed) {
+    data_destroy(slot_item(dq, slot), dq->type);
+  }
+}
+
+// Produce the index of the item of dq stored inline at p, or
+//   CALIST_INDEX_NOT_FOUND if p is not in the slots of dq
+static size_t index_of(const cadeque *dq, const void *p) {
+  uintptr_t at = (uintptr_t) p;
+  uintptr_t start = (uintptr_t) dq->data;
+  if (dq->boxed || !dq->data || at < start ||
+      at - start >= dq->capacity * dq->width) {
+    return CALIST_INDEX_NOT_FOUND;
+  }
+  size_t slot = (at - start) / dq->width;
+  size_t index = (slot - dq->head) & (dq->capacity - 1);
+  return (index < dq->size) ? index : CALIST_INDEX_NOT_FOUND;
+}
+
+// Move the items of dq into a new array of capacity slots, from slot 0
+static void resize(cadeque *dq, size_t capacity) {
+  if (capacity > SIZE_MAX / dq->width) {
+    ALLOC_ERROR("cadeque");
+  }
+  unsigned char *data = malloc(capacity * dq->width);
+  if (!data) {
+    ALLOC_ERROR("cadeque");
+  }
+  size_t first = dq->capacity - dq->head;
+  if (first > dq->size) {
+    first = dq->size;
+  }
+  if (dq->size > 0) {
+    memcpy(data, slot_at(dq, 0), first * dq->width);
+    memcpy(data + first * dq->width, dq->data,
+           (dq->size - first) * dq->width);
+  }
+  free(dq->data);
+  dq->data = data;
+  dq->capacity = capacity;
+  dq->head = 0;
+}
+
+// Ensure dq has a free slot, and produce the address of item afterwards,
+//   which moves if it is an item of dq stored inline
+static const void *make_room(cadeque *dq, const void *item) {
+  if (dq->size < dq->capacity) {
+    return item;
+  }
+  size_t at = index_of(dq, item);
+  if (dq->capacity > SIZE_MAX / 2) {
+    ALLOC_ERROR("cadeque");
+  }
+  resize(dq, dq->capacity ? dq->capacity * 2 : MIN_CAPACITY);
+  return (at == CALIST_INDEX_NOT_FOUND) ? item : slot_at(dq, at);
+}
+
+// Move count slots of dq from index from to index to, where the ranges
+//   may overlap and either index may wrap around the array
+static void move_slots(cadeque *dq, size_t to, size_t from, size_t count) {
+  if (to < from) {
+    for (size_t i = 0; i < count; ++i) {
+      memcpy(slot_at(dq, to + i), slot_at(dq, from + i), dq->width);
+    }
+  } else {
+    for (size_t i = count; i > 0; --i) {
+      memcpy(slot_at(dq, to + i - 1), slot_at(dq, from + i - 1), dq->width);
+    }
+  }
+}
@@ -1,20 +1,49 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "calist.h"
 #include "cerror.h"
-
+#include "csort.h"
+#include "ckernel.h"
+#include "cmap.h"
+#include "cstream.h"
+
+// Items are stored in slots of width bytes:
+//   - inline storage: each slot holds the item itself (POD ctypes), or the
+//                     slot representation of the item (slotted ctypes,
+//                     see data_slot_size)
+//   - boxed storage:  each slot holds a pointer to a heap-allocated item
+// The core comes first, where the inline functions of calist.h read it
 struct calist {
-  void **data;
-  const ctype *type;
-  size_t size;
+  calist_core core;  // data, type, size, width, boxed and slotted
   size_t capacity;
+  bool canonical;  // boxed items are canonical pointers [data_canonical]
+  ckernel_kind kernel;  // CKERNEL_NONE unless inline with a built-in ctype
+  const callocator *alloc;  // source of the calist, its slots and items
+  calist_growth growth;
+  cmap *map;  // the file holding the slots, or NULL if they are in memory
+  cpool *pool;  // runs the parallel operations, or NULL for the default
+  size_t *shared;  // the number of calists sharing the slots and items, 
+                   //   or NULL if they belong to this calist alone
+  size_t generation;  // advanced whenever the slots move [see calist_view]
+#if CALIST_STATS
+  calist_counters stats;
+#endif
 };
 
 const size_t CALIST_INDEX_NOT_FOUND = SIZE_MAX;
 
 static const size_t DEFAULT_INIT_CAPACITY = 1;
 
+const calist_growth CALIST_GROWTH_DEFAULT = {
+  .factor = 2.0,
+  .min_capacity = 8,
+  .huge_threshold = (size_t) 4 << 20,
+  .huge_page = (size_t) 2 << 20,
+  .shrink_below = 0.0,
+};
+
 static const char *ASSERT_CALIST_NOT_EMPTY 
   = "calist cannot be empty!";
 static const char *ASSERT_CALIST_SAME_TYPE 
@@ -26,10 +55,144 @@ static const char *ASSERT_INDEX_BOUNDED_INCLUSIVE
 static const char *ASSERT_INDEX_END_AFTER_START
   = "The ending index cannot be less than the starting index!";
 
+static const char *ASSERT_ARRAY_FIXED_SIZE
+  = "Arrays of strings have no fixed item size!";
+
+static const char *ASSERT_VIEW_VALID
+  = "calist_view is used after its calist moved or shrank!";
+
 static const char *ERROR_ITEM_DUP = "Failed to duplicate item!";
 
+// Counting is compiled out unless CALIST_STATS is enabled [see ctype.h]
+#if CALIST_STATS
+#define COUNT(al, field, n) ((al)->stats.field += (n))
+#define COUNT_PEAK(al, field, n) do { \
+  if ((n) > (al)->stats.field) (al)->stats.field = (n); \
+} while (0)
+#else
+#define COUNT(al, field, n) ((void) 0)
+#define COUNT_PEAK(al, field, n) ((void) 0)
+#endif
+
+static calist_stats_hook stats_hook = NULL;
+static void *stats_ctx = NULL;
+
+// The header of a saved calist, followed by its payload: the items 
+//   themselves for POD ctypes [width > 0], and otherwise each serialized 
+//   item preceded by its uint64_t length
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t type_id;   // see saved_type_id
+  uint64_t width;
+  uint64_t count;
+  uint64_t bytes;     // the length of the payload
+  uint64_t checksum;  // of the payload [see cstream]
+} saved_header;
+
+// Text is batched in a buffer of TEXT_BUFFER_SIZE bytes before it reaches
+//   the sink
+#define TEXT_BUFFER_SIZE 4096
+
+// calist_set replaces a slotted item through a stack buffer of 
+//   SLOT_BUFFER_SIZE bytes [the slots of the built-in string ctypes fit]
+#define SLOT_BUFFER_SIZE 64
+
+typedef struct {
+  calist_sink sink;
+  void *ctx;
+  size_t fill;
+  bool ok;
+  char buf[TEXT_BUFFER_SIZE];
+} text_writer;
+
+// The destination of calist_format
+typedef struct {
+  char *buf;
+  size_t cap;
+  size_t len;
+} text_buffer;
+
+// The shared arguments of a parallel operation
+typedef struct {
+  const calist *al;
+  const void *args;
+  calist_map map;
+  calist_pred pred;
+  calist_reduce reduce;
+  size_t grain;
+  bool *keep;              // calist_par_filter: the result of pred per item
+  size_t *counts;          // the number of items kept per chunk
+  unsigned char *parts;    // calist_par_reduce: the accumulator per chunk
+  const void *init;
+  size_t acc_size;
+} par_job;
+
+static const char SAVED_MAGIC[8] = "CALISTB";
+static const uint32_t SAVED_VERSION = 1;
+
 // Helper function declaration
-static void qsort_range(calist *al, size_t first, size_t last);
+static inline void *slot_at(const calist *al, size_t index);
+static inline void *item_at(const calist *al, size_t index);
+static inline void *slot_item(const calist *al, const void *slot);
+static inline bool bitwise(const calist *al);
+static void store_item(calist *al, size_t index, const void *item);
+static void release_item(const calist *al, size_t index);
+static void adopt_item(calist *al, size_t index, void *item);
+static void open_slot(calist *al, size_t index);
+static void swap_slots(calist *al, size_t i, size_t j);
+static void reset_stats(calist *al);
+static void shift_slots(calist *al, size_t from, size_t to, size_t count);
+static bool resize_storage(calist *al, size_t n);
+static size_t scale_capacity(const calist *al, size_t n);
+static size_t plan_capacity(const calist *al, size_t n);
+static void grow_to_fit(calist *al, size_t needed);
+static void shrink_if_sparse(calist *al);
+static void unshare(calist *al);
+static bool release_share(calist *al);
+static void release_storage(calist *al);
+static bool in_storage(const calist *al, const void *item);
+static calist *create_like(const calist *al, size_t init_cap);
+static size_t find_in(const calist *al, size_t from, size_t end,
+                      const void *item);
+static size_t find_last_in(const calist *al, size_t from, size_t end,
+                           const void *item);
+static size_t count_in(const calist *al, size_t from, size_t end,
+                       const void *item);
+static size_t bsearch_in(const calist *al, size_t from, size_t end,
+                         const void *item);
+static size_t lower_in(const calist *al, size_t from, size_t end,
+                       const void *item);
+static size_t upper_in(const calist *al, size_t from, size_t end,
+                       const void *item);
+static bool equal_in(const calist *l1, size_t from1, const calist *l2,
+                     size_t from2, size_t n);
+static bool write_range(const calist *al, size_t from, size_t end,
+                        calist_sink sink, void *ctx);
+static void print_range(const calist *al, size_t from, size_t end);
+static calist *copy_range(const calist *al, size_t from, size_t end);
+static int cmp_slots(const void *a, const void *b, const void *ctx);
+static int cmp_slots_by(const void *a, const void *b, const void *ctx);
+static bool *mark_unique(const calist *al);
+static void mark_unique_hash(const calist *al, bool *keep);
+static void mark_unique_sort(const calist *al, bool *keep);
+static int cmp_indices(const void *a, const void *b, const void *ctx);
+static void write_text(text_writer *w, const char *text, size_t n);
+static void write_item(text_writer *w, const void *item, const ctype *type);
+static void flush_text(text_writer *w);
+static size_t sink_file(const char *buf, size_t n, void *ctx);
+static size_t sink_buffer(const char *buf, size_t n, void *ctx);
+static uint32_t saved_type_id(const ctype *type);
+static void par_job_init(par_job *job, const calist *al, const void *args);
+static size_t par_chunks(const par_job *job);
+static void par_map_chunk(void *ctx, size_t begin, size_t end);
+static void par_pred_chunk(void *ctx, size_t begin, size_t end);
+static void par_reduce_chunk(void *ctx, size_t begin, size_t end);
+static void par_sort_block(void *base, size_t n, const void *ctx);
+static void save_payload(const calist *al, cstream *s, unsigned char **buf, 
+                         size_t *cap);
+static bool load_payload(calist *al, cstream *s, size_t count);
+static void reserve_buffer(unsigned char **buf, size_t *cap, size_t n);
 
 calist *calist_create(const ctype *type) {
   ASSERT_NOT_NULL(type, NULL);
@@ -39,111 +202,314 @@ calist *calist_create(const ctype *type) {
 calist *calist_create_size(const ctype *type, size_t init_cap) {
   ASSERT_NOT_NULL(type, NULL);
   ASSERT_MSG(init_cap, "The initial capacity of calist cannot be zero!");
+  return calist_create_storage(type, init_cap, CALIST_STORAGE_AUTO);
+}
+
+calist *calist_create_storage(const ctype *type, size_t init_cap,
+                              calist_storage storage) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(init_cap, "The initial capacity of calist cannot be zero!");
+  return calist_create_alloc(type, init_cap, storage, callocator_default());
+}
+
+calist *calist_create_alloc(const ctype *type, size_t init_cap,
+                            calist_storage storage, 
+                            const callocator *alloc) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(init_cap, "The initial capacity of calist cannot be zero!");
+  ASSERT_MSG(storage != CALIST_STORAGE_INLINE || ctype_is_pod(type) ||
+             data_slot_size(type), 
+             "Inline storage requires a POD or slotted ctype!");
+  ASSERT_NOT_NULL(alloc, NULL);
 
-  calist *al = malloc(sizeof(*al));
+  calist *al = callocator_alloc(alloc, sizeof(*al));
   if (!al) {
     ALLOC_ERROR("calist");
   }
 
-  al->data = malloc(sizeof(*al->data) * init_cap);
-  if (!al->data) {
+  if (storage == CALIST_STORAGE_AUTO) {
+    storage = (ctype_is_pod(type) || data_slot_size(type)) 
+              ? CALIST_STORAGE_INLINE : CALIST_STORAGE_BOXED;
+  }
+  al->core.boxed = (storage == CALIST_STORAGE_BOXED);
+  al->core.slotted = !al->core.boxed && !ctype_is_pod(type);
+  al->canonical = al->core.boxed && ctype_has_canonical(type);
+  al->core.width = al->core.boxed ? sizeof(void *) 
+            : al->core.slotted ? data_slot_size(type) : data_size(type);
+  al->kernel = al->core.boxed ? CKERNEL_NONE : ckernel_select(type);
+
+  if (init_cap > SIZE_MAX / al->core.width) {
+    ALLOC_ERROR("calist with the given capacity");
+  }
+  al->alloc = alloc;
+  al->core.data = callocator_alloc(alloc, al->core.width * init_cap);
+  if (!al->core.data) {
     ALLOC_ERROR("calist with the given capacity");
   }
   
-  al->type = type;
-  al->size = 0;
+  al->core.type = type;
+  al->core.size = 0;
   al->capacity = init_cap;
+  al->growth = CALIST_GROWTH_DEFAULT;
+  al->map = NULL;
+  al->pool = NULL;
+  al->shared = NULL;
+  al->generation = 0;
+  reset_stats(al);
+  return al;
+}
+
+calist *calist_create_from_array(const ctype *type, const void *base,
+                                 size_t n) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(base || n == 0, "base cannot be NULL if n > 0!");
+
+  calist *al = calist_create_size(type, n ? n : DEFAULT_INIT_CAPACITY);
+  calist_insert_array(al, 0, base, n);
+  return al;
+}
+
+calist *calist_create_mapped(const ctype *type, const char *path, 
+                             int flags) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(path, NULL);
+  ASSERT_MSG(ctype_is_pod(type), "Mapped storage requires a POD ctype!");
+  ASSERT_MSG(!(flags & CALIST_MAPPED_SEQUENTIAL) || 
+             !(flags & CALIST_MAPPED_RANDOM),
+             "Sequential and random access hints are exclusive!");
+
+  size_t size = 0;
+  size_t capacity = 0;
+  cmap *map = cmap_open(path, data_size(type), flags & CALIST_MAPPED_TRUNCATE,
+                        &size, &capacity);
+  if (!map) {
+    return NULL;
+  }
+  if (flags & CALIST_MAPPED_SEQUENTIAL) {
+    cmap_advise(map, CMAP_ADVICE_SEQUENTIAL);
+  } else if (flags & CALIST_MAPPED_RANDOM) {
+    cmap_advise(map, CMAP_ADVICE_RANDOM);
+  }
+
+  // The slots move from the heap to the file
+  calist *al = calist_create_storage(type, 1, CALIST_STORAGE_INLINE);
+  callocator_release(al->alloc, al->core.data, al->core.width * al->capacity);
+  al->map = map;
+  al->core.data = cmap_data(map);
+  al->core.size = size;
+  al->capacity = capacity;
   return al;
 }
 
+bool calist_sync(calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return !al->map || cmap_sync(al->map, al->core.size);
+}
+
 void calist_destroy(calist *al) {
   if (!al) return;
 
-  for (size_t i = 0; i < al->size; ++i) {
-    data_destroy(al->data[i], al->type);
+#if CALIST_STATS
+  if (stats_hook) {
+    calist_counters stats;
+    calist_stats(al, &stats);
+    stats_hook(al, &stats, stats_ctx);
   }
-  free(al->data);
-  free(al);
+#endif
+
+  if (!al->shared || release_share(al)) {
+    release_storage(al);
+  }
+  callocator_release(al->alloc, al, sizeof(*al));
 }
 
 void calist_clear(calist *al) {
   ASSERT_NOT_NULL(al, NULL);
+  unshare(al);
 
-  for (size_t i = 0; i < al->size; ++i) {
-    data_destroy(al->data[i], al->type);
+  if (!bitwise(al)) {
+    for (size_t i = 0; i < al->core.size; ++i) {
+      release_item(al, i);
+    }
   }
-  al->size = 0;
+  al->core.size = 0;
+  shrink_if_sparse(al);
 }
 
 calist *calist_dup(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
 
-  calist *al_copy = malloc(sizeof(*al_copy));
-  if (!al_copy) {
-    ALLOC_ERROR("calist");
+  calist *al_copy = create_like(al, al->capacity);
+  if (!bitwise(al)) {
+    for (size_t i = 0; i < al->core.size; ++i) {
+      store_item(al_copy, i, item_at(al, i));
+    }
+  } else {
+    memcpy(al_copy->core.data, al->core.data, al->core.width * al->core.size);
   }
+  al_copy->core.size = al->core.size;
+  return al_copy;
+}
 
-  al_copy->data = malloc(sizeof(*al_copy->data) * al->capacity);
-  if (!al_copy->data) {
-    ALLOC_ERROR("calist with the given capacity");
+calist *calist_snapshot(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  if (al->map) {
+    return calist_dup(al);
   }
 
-  for (size_t i = 0; i < al->size; ++i) {
-    void *item = data_dup(al->data[i], al->type);
-    if (!item) {
-      FATAL_ERROR(ERROR_ITEM_DUP);
+  // The first snapshot creates the count; racing snapshots keep one
+  calist *owner = (calist *) al;
+  size_t *shared = __atomic_load_n(&owner->shared, __ATOMIC_ACQUIRE);
+  if (!shared) {
+    size_t *fresh = malloc(sizeof(*fresh));
+    if (!fresh) {
+      ALLOC_ERROR("snapshot count");
+    }
+    *fresh = 1;
+    if (__atomic_compare_exchange_n(&owner->shared, &shared, fresh, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      shared = fresh;
+    } else {
+      free(fresh);
     }
-    al_copy->data[i] = item;
   }
+  __atomic_add_fetch(shared, 1, __ATOMIC_RELAXED);
 
-  al_copy->type = al->type;
-  al_copy->size = al->size;
-  al_copy->capacity = al->capacity;
-  return al_copy;
+  calist *snapshot = callocator_alloc(al->alloc, sizeof(*snapshot));
+  if (!snapshot) {
+    ALLOC_ERROR("calist");
+  }
+  *snapshot = *al;
+  snapshot->shared = shared;
+  reset_stats(snapshot);
+  return snapshot;
+}
+
+bool calist_shares_storage(const calist *l1, const calist *l2) {
+  ASSERT_NOT_NULL(l1, "The first calist");
+  ASSERT_NOT_NULL(l2, "The second calist");
+  return l1->shared && l1->shared == l2->shared;
 }
 
 void calist_print(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
+  print_range(al, 0, al->core.size);
+}
 
-  printf("[");
-  for (size_t i = 0; i < al->size; ++i) {
-    if (i != 0) {
-      printf(", ");
-    }
-    data_print(al->data[i], al->type);
+bool calist_write(const calist *al, calist_sink sink, void *ctx) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(sink, NULL);
+  ASSERT_MSG(ctype_has_format(al->core.type), "ctype has no format method!");
+  return write_range(al, 0, al->core.size, sink, ctx);
+}
+
+size_t calist_format(const calist *al, char *buf, size_t cap) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(buf || cap == 0, "buf cannot be NULL if cap > 0!");
+
+  text_buffer text = {buf, cap, 0};
+  calist_write(al, sink_buffer, &text);
+  if (cap > 0) {
+    buf[(text.len < cap) ? text.len : cap - 1] = '\0';
   }
-  printf("]\n");
+  return text.len;
+}
+
+bool calist_save(const calist *al, FILE *out) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(out, NULL);
+  ASSERT_MSG(ctype_has_serialize(al->core.type), "ctype cannot be serialized!");
+
+  saved_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SAVED_MAGIC, sizeof(SAVED_MAGIC));
+  header.version = SAVED_VERSION;
+  header.type_id = saved_type_id(al->core.type);
+  header.width = ctype_is_pod(al->core.type) ? data_size(al->core.type) : 0;
+  header.count = al->core.size;
+
+  // The payload is streamed once for its length and checksum, then again
+  //   to out after the header
+  unsigned char *buf = NULL;
+  size_t cap = 0;
+  cstream s;
+  cstream_open_write(&s, NULL);
+  save_payload(al, &s, &buf, &cap);
+  cstream_close_write(&s);
+  header.bytes = cstream_bytes(&s);
+  header.checksum = cstream_checksum(&s);
+
+  bool ok = (fwrite(&header, sizeof(header), 1, out) == 1);
+  if (ok) {
+    cstream_open_write(&s, out);
+    save_payload(al, &s, &buf, &cap);
+    ok = cstream_close_write(&s);
+  }
+  free(buf);
+  return ok;
+}
+
+calist *calist_load(const ctype *type, FILE *in) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(in, NULL);
+  ASSERT_MSG(ctype_has_serialize(type), "ctype cannot be serialized!");
+
+  saved_header header;
+  size_t width = ctype_is_pod(type) ? data_size(type) : 0;
+  if (fread(&header, sizeof(header), 1, in) != 1 ||
+      memcmp(header.magic, SAVED_MAGIC, sizeof(SAVED_MAGIC)) ||
+      header.version != SAVED_VERSION || 
+      header.type_id != saved_type_id(type) || header.width != width ||
+      header.count > SIZE_MAX || header.bytes > SIZE_MAX) {
+    return NULL;
+  }
+  size_t count = (size_t) header.count;
+  size_t bytes = (size_t) header.bytes;
+
+  // Every item takes at least its width, or the 8 bytes of its length
+  size_t least = width ? width : sizeof(uint64_t);
+  if (count > bytes / least || (width && bytes != count * width)) {
+    return NULL;
+  }
+
+  calist *al = calist_create_size(type, count ? count : DEFAULT_INIT_CAPACITY);
+  cstream s;
+  cstream_open_read(&s, in, bytes);
+  bool ok = load_payload(al, &s, count);
+  if (!cstream_close_read(&s, header.checksum) || !ok) {
+    calist_destroy(al);
+    return NULL;
+  }
+  return al;
 }
 
 bool calist_equals(const calist *l1, const calist *l2) {
   ASSERT_NOT_NULL(l1, "The first calist");
   ASSERT_NOT_NULL(l2, "The second calist");
 
-  if (l1->size != l2->size || !ctype_equals(l1->type, l2->type)) {
+  if (l1->core.size != l2->core.size || 
+      !ctype_equals(l1->core.type, l2->core.type)) {
     return false;
   }
-
-  for (size_t i = 0; i < l1->size; ++i) {
-    if (data_cmp(l1->data[i], l2->data[i], l1->type)) {
-      return false;
-    }
+  if (l1->core.data == l2->core.data) {
+    return true;
   }
-  return true;
+  return equal_in(l1, 0, l2, 0, l1->core.size);
 }
 
 const ctype *calist_type(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
-  return al->type;
+  return al->core.type;
 }
 
 size_t calist_size(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
-  return al->size;
+  return al->core.size;
 }
 
 bool calist_empty(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
-  return (al->size == 0);
+  return (al->core.size == 0);
 }
 
 size_t calist_capacity(const calist *al) {
@@ -151,118 +517,215 @@ size_t calist_capacity(const calist *al) {
   return al->capacity;
 }
 
-void calist_reserve(calist *al, size_t n) {
+const callocator *calist_allocator(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
+  return al->alloc;
+}
+
+calist_storage calist_storage_mode(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->core.boxed ? CALIST_STORAGE_BOXED : CALIST_STORAGE_INLINE;
+}
+
+calist_growth calist_growth_policy(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->growth;
+}
+
+void calist_set_growth_policy(calist *al, const calist_growth *growth) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(growth, NULL);
+  ASSERT_MSG(growth->factor > 1, "The growth factor must exceed 1!");
+  ASSERT_MSG(growth->min_capacity, "The minimum capacity cannot be zero!");
+  ASSERT_MSG(!growth->huge_threshold || growth->huge_page,
+             "The huge page size cannot be zero!");
+  ASSERT_MSG(growth->shrink_below >= 0 && 
+             growth->shrink_below * growth->factor < 1,
+             "The shrink threshold must be below 1 / factor!");
+
+  al->growth = *growth;
+  shrink_if_sparse(al);
+}
 
+void calist_reserve(calist *al, size_t n) {
+  ASSERT_NOT_NULL(al, NULL);
   if (n <= al->capacity) return;
 
-  void **new_data = realloc(al->data, sizeof(void *) * n);
-  if (!new_data) {
+  unshare(al);
+  if (!resize_storage(al, n)) {
     FATAL_ERROR("Failed to reserve the given capacity!");
   }
-
-  al->data = new_data;
-  al->capacity = n;
 }
 
 void calist_reclaim(calist *al) {
   ASSERT_NOT_NULL(al, NULL);
   
-  if (al->size == al->capacity) return;
+  // An empty calist keeps one slot so that its storage stays valid
+  size_t n = al->core.size ? al->core.size : 1;
+  if (n == al->capacity) return;
   
-  void **new_data = realloc(al->data, sizeof(void *) * al->size);
-  if (!new_data) {
+  unshare(al);
+  if (!resize_storage(al, n)) {
     FATAL_ERROR("Failed to reclaim the unused storage!");
   }
+}
+
+void calist_stats(const calist *al, calist_counters *out) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(out, NULL);
+#if CALIST_STATS
+  *out = al->stats;
+  // Lists filled without growing [loaded or mapped] reach their size 
+  //   directly
+  if (al->core.size > out->peak_size) {
+    out->peak_size = al->core.size;
+  }
+#else
+  memset(out, 0, sizeof(*out));
+#endif
+}
+
+void calist_stats_reset(calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  reset_stats(al);
+}
 
-  al->data = new_data;
-  al->capacity = al->size;
+void calist_set_stats_hook(calist_stats_hook hook, void *ctx) {
+  stats_hook = hook;
+  stats_ctx = ctx;
 }
 
 const void *calist_get(const calist *al, size_t index) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
-  return al->data[index];
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->core.size, ASSERT_INDEX_BOUNDED);
+  return item_at(al, index);
 }
 
 void *calist_get_mutable(const calist *al, size_t index) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
-  return al->data[index];
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->core.size, ASSERT_INDEX_BOUNDED);
+  unshare((calist *) al);
+  return item_at(al, index);
 }
 
 void calist_set(calist *al, size_t index, const void *new_item) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->core.size, ASSERT_INDEX_BOUNDED);
   ASSERT_NOT_NULL(new_item, "The new item");
-
-  void *item_copy = data_dup(new_item, al->type);
-  if (!item_copy) {
-    FATAL_ERROR(ERROR_ITEM_DUP);
+  unshare(al);
+
+  if (al->core.boxed) {
+    void *old_item = item_at(al, index);
+    store_item(al, index, new_item);
+    data_destroy_with(old_item, al->core.type, al->alloc);
+    COUNT(al, destroys, 1);
+  } else if (al->core.slotted) {
+    // new_item may point into the old item, so it is stored aside first,
+    //   on the stack unless the slot is unusually wide
+    unsigned char buffer[SLOT_BUFFER_SIZE];
+    unsigned char *new_slot = buffer;
+    if (al->core.width > sizeof(buffer)) {
+      new_slot = malloc(al->core.width);
+      if (!new_slot) {
+        ALLOC_ERROR("slot of calist");
+      }
+    }
+    if (!data_slot_store(new_slot, new_item, al->core.type, al->alloc)) {
+      FATAL_ERROR(ERROR_ITEM_DUP);
+    }
+    COUNT(al, dups, 1);
+    release_item(al, index);
+    memcpy(slot_at(al, index), new_slot, al->core.width);
+    if (new_slot != buffer) {
+      free(new_slot);
+    }
+  } else {
+    // new_item may alias the slot being replaced
+    memmove(slot_at(al, index), new_item, al->core.width);
   }
+}
+
+void calist_set_owned(calist *al, size_t index, void *new_item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->core.size, ASSERT_INDEX_BOUNDED);
+  ASSERT_NOT_NULL(new_item, "The new item");
+  unshare(al);
 
-  data_destroy(al->data[index], al->type);
-  al->data[index] = item_copy;
+  release_item(al, index);
+  adopt_item(al, index, new_item);
 }
 
 void calist_swap(calist *al, size_t i, size_t j) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(i < al->size, ASSERT_INDEX_BOUNDED);
-  ASSERT_MSG(j < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(i < al->core.size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(j < al->core.size, ASSERT_INDEX_BOUNDED);
+  unshare(al);
 
-  void *temp = al->data[i];
-  al->data[i] = al->data[j];
-  al->data[j] = temp;
+  swap_slots(al, i, j);
 }
 
 void calist_append(calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(item, NULL);
-
-  void *item_copy = data_dup(item, al->type);
-  if (!item_copy) {
-    FATAL_ERROR(ERROR_ITEM_DUP);
-  }
-
-  if (al->size == al->capacity) {
-    calist_reserve(al, al->capacity * 2);
-  }
-  al->data[al->size] = item_copy;
-  ++al->size;
+  calist_insert(al, al->core.size, item);
 }
 
 void calist_append_all(calist *al, const calist *src) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(src, NULL);
-  ASSERT_MSG(ctype_equals(src->type, al->type), ASSERT_CALIST_SAME_TYPE);
+  ASSERT_MSG(ctype_equals(src->core.type, al->core.type), 
+             ASSERT_CALIST_SAME_TYPE);
+  calist_insert_all(al, al->core.size, src);
+}
 
-  for (size_t i = 0; i < src->size; ++i) {
-    calist_append(al, src->data[i]);
-  }
+void calist_append_array(calist *al, const void *base, size_t n) {
+  ASSERT_NOT_NULL(al, NULL);
+  calist_insert_array(al, al->core.size, base, n);
 }
 
-void calist_insert(calist *al, size_t index, const void *item) {
+void calist_append_owned(calist *al, void *item) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(item, NULL);
-  ASSERT_MSG(index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  calist_insert_owned(al, al->core.size, item);
+}
 
-  void *item_copy = data_dup(item, al->type);
-  if (!item_copy) {
-    FATAL_ERROR(ERROR_ITEM_DUP);
+void calist_insert(calist *al, size_t index, const void *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_MSG(index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  unshare(al);
+
+  // An inline item aliasing the storage would move on growth or shifting
+  void *alias_copy = NULL;
+  if (!al->core.boxed && in_storage(al, item)) {
+    alias_copy = data_dup(item, al->core.type);
+    if (!alias_copy) {
+      FATAL_ERROR(ERROR_ITEM_DUP);
+    }
+    item = alias_copy;
   }
 
-  if (al->size == al->capacity) {
-    calist_reserve(al, al->capacity * 2);
-  }
-  for (size_t i = al->size; i > index; --i) {
-    al->data[i] = al->data[i - 1];
-  }
-  al->data[index] = item_copy;
-  ++al->size;
+  open_slot(al, index);
+  store_item(al, index, item);
+  ++al->core.size;
+
+  data_destroy(alias_copy, al->core.type);
+}
+
+void calist_insert_owned(calist *al, size_t index, void *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_MSG(index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  unshare(al);
+
+  open_slot(al, index);
+  adopt_item(al, index, item);
+  ++al->core.size;
 }
 
 void calist_insert_front(calist *al, const void *item) {
@@ -274,109 +737,217 @@ void calist_insert_front(calist *al, const void *item) {
 void calist_insert_all(calist *al, size_t index, const calist *src) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(src, NULL);
-  ASSERT_MSG(ctype_equals(src->type, al->type), ASSERT_CALIST_SAME_TYPE);
-  ASSERT_MSG(index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  ASSERT_MSG(ctype_equals(src->core.type, al->core.type), 
+             ASSERT_CALIST_SAME_TYPE);
+  ASSERT_MSG(index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  unshare(al);
+
+  // Inserting al into itself reads from a stable copy
+  calist *self_copy = NULL;
+  if (src == al) {
+    self_copy = calist_dup(al);
+    src = self_copy;
+  }
 
-  calist_reserve(al, al->size + src->size);
+  size_t n = src->core.size;
+  if (n > SIZE_MAX - al->core.size) {
+    FATAL_ERROR("Failed to reserve the given capacity!");
+  }
+  grow_to_fit(al, al->core.size + n);
   // Shift elements backwards to make room
-  for (size_t i = al->size; i-- > index;) {
-    al->data[i + src->size] = al->data[i];
+  shift_slots(al, index, index + n, al->core.size - index);
+
+  if (!bitwise(al) || !bitwise(src)) {
+    for (size_t i = 0; i < n; ++i) {
+      store_item(al, index + i, item_at(src, i));
+    }
+  } else {
+    memcpy(slot_at(al, index), src->core.data, al->core.width * n);
   }
+  al->core.size += n;
 
-  for (size_t i = 0; i < src->size; ++i) {
-    al->data[index + i] = data_dup(src->data[i], al->type);
-    if (!al->data[index + i]) {
-      FATAL_ERROR(ERROR_ITEM_DUP);
+  calist_destroy(self_copy);
+}
+
+void calist_insert_array(calist *al, size_t index, const void *base, 
+                         size_t n) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(base || n == 0, "base cannot be NULL if n > 0!");
+  ASSERT_MSG(index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  ASSERT_MSG(!ctype_is_string(al->core.type), ASSERT_ARRAY_FIXED_SIZE);
+  unshare(al);
+
+  if (n == 0) return;
+
+  size_t item_size = data_size(al->core.type);
+  if (n > SIZE_MAX - al->core.size || n > SIZE_MAX / item_size) {
+    FATAL_ERROR("Failed to reserve the given capacity!");
+  }
+
+  // An array aliasing the inline storage would move on growth or shifting
+  void *alias_copy = NULL;
+  if (!al->core.boxed && in_storage(al, base)) {
+    alias_copy = malloc(item_size * n);
+    if (!alias_copy) {
+      ALLOC_ERROR("copy of array");
     }
+    memcpy(alias_copy, base, item_size * n);
+    base = alias_copy;
   }
-  al->size += src->size;
+
+  // Repeated bulk appends still grow the capacity geometrically
+  grow_to_fit(al, al->core.size + n);
+  shift_slots(al, index, index + n, al->core.size - index);
+  if (!bitwise(al)) {
+    const unsigned char *item = base;
+    for (size_t i = 0; i < n; ++i, item += item_size) {
+      store_item(al, index + i, item);
+    }
+  } else {
+    memcpy(slot_at(al, index), base, item_size * n);
+  }
+  al->core.size += n;
+
+  free(alias_copy);
 }
 
 void calist_pop(calist *al, size_t index) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->core.size, ASSERT_INDEX_BOUNDED);
+  unshare(al);
+
+  release_item(al, index);
+  shift_slots(al, index + 1, index, al->core.size - index - 1);
+  --al->core.size;
+  shrink_if_sparse(al);
+}
+
+void *calist_take(calist *al, size_t index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->core.size, ASSERT_INDEX_BOUNDED);
+  unshare(al);
 
-  data_destroy(al->data[index], al->type);
-  for (size_t i = index; i < al->size - 1; ++i) {
-    al->data[i] = al->data[i + 1];
+  void *item = item_at(al, index);
+  if (!al->core.boxed) {
+    item = data_dup_with(item, al->core.type, al->alloc);
+    if (!item) {
+      FATAL_ERROR(ERROR_ITEM_DUP);
+    }
+    release_item(al, index);
   }
-  --al->size;
+  shift_slots(al, index + 1, index, al->core.size - index - 1);
+  --al->core.size;
+  shrink_if_sparse(al);
+  return item;
+}
+
+void *calist_pop_back_take(calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  return calist_take(al, al->core.size - 1);
 }
 
 size_t calist_remove(calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
   ASSERT_NOT_NULL(item, NULL);
 
-  for (size_t i = 0; i < al->size; ++i) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      calist_pop(al, i);
-      return i;
-    }
+  size_t index = calist_index(al, item);
+  if (index != CALIST_INDEX_NOT_FOUND) {
+    calist_pop(al, index);
   }
-  return CALIST_INDEX_NOT_FOUND;
+  return index;
 }
 
 size_t calist_remove_last(calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
   ASSERT_NOT_NULL(item, NULL);
 
-  for (size_t i = al->size; i-- > 0;) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      calist_pop(al, i);
-      return i;
-    }
+  size_t index = calist_index_last(al, item);
+  if (index != CALIST_INDEX_NOT_FOUND) {
+    calist_pop(al, index);
   }
-  return CALIST_INDEX_NOT_FOUND;
+  return index;
 }
 
 size_t calist_remove_all(calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
   ASSERT_NOT_NULL(item, NULL);
 
-  size_t total = 0;
-  for (size_t i = al->size; i-- > 0;) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      calist_pop(al, i);
-      ++total;
+  size_t write = find_in(al, 0, al->core.size, item);
+  if (write == CALIST_INDEX_NOT_FOUND) {
+    return 0;
+  }
+  unshare(al);
+
+  // item may be an item of al, which is released or moved while compacting
+  void *item_copy = NULL;
+  if (!bitwise(al) || in_storage(al, item)) {
+    item_copy = data_dup(item, al->core.type);
+    if (!item_copy) {
+      FATAL_ERROR(ERROR_ITEM_DUP);
     }
+    item = item_copy;
   }
+
+  // Each match is released and the run of items after it moves down
+  for (size_t read = write; read < al->core.size;) {
+    release_item(al, read++);
+    size_t next = find_in(al, read, al->core.size, item);
+    size_t end = (next == CALIST_INDEX_NOT_FOUND) ? al->core.size : next;
+    shift_slots(al, read, write, end - read);
+    write += end - read;
+    read = end;
+  }
+  data_destroy(item_copy, al->core.type);
+
+  size_t total = al->core.size - write;
+  al->core.size = write;
+  shrink_if_sparse(al);
   return total;
 }
 
 size_t calist_remove_if(calist *al, calist_pred pred, const void *args) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
   ASSERT_NOT_NULL(pred, NULL);
-
-  size_t total = 0;
-  for (size_t i = al->size; i-- > 0;) {
-    if (pred(al, al->data[i], args)) {
-      calist_pop(al, i);
-      ++total;
+  unshare(al);
+
+  // While pred runs, al holds only the items kept so far
+  size_t n = al->core.size;
+  size_t write = 0;
+  for (size_t read = 0; read < n; ++read) {
+    al->core.size = write;
+    if (pred(al, item_at(al, read), args)) {
+      release_item(al, read);
+    } else {
+      shift_slots(al, read, write++, 1);
     }
   }
-  return total;
+  al->core.size = write;
+  shrink_if_sparse(al);
+  return n - write;
 }
 
 void calist_remove_range(calist *al, size_t from_index, size_t to_index) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(from_index < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(from_index < al->core.size, ASSERT_INDEX_BOUNDED);
   ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
-  ASSERT_MSG(to_index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  ASSERT_MSG(to_index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  unshare(al);
 
   size_t range = to_index - from_index;
   for (size_t i = from_index; i < to_index; ++i) {
-    data_destroy(al->data[i], al->type);
+    release_item(al, i);
   }
-  for (size_t i = to_index; i < al->size; ++i) {
-    al->data[i - range] = al->data[i];
-  }
-  al->size -= range;
+  shift_slots(al, to_index, from_index, al->core.size - to_index);
+  al->core.size -= range;
+  shrink_if_sparse(al);
 }
 
 bool calist_contains(const calist *al, const void *item) {
@@ -388,29 +959,14 @@ bool calist_contains(const calist *al, const void *item) {
 size_t calist_index(const calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(item, NULL);
-
-  for (size_t i = 0; i < al->size; ++i) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      return i;
-    }
-  }
-  return CALIST_INDEX_NOT_FOUND;
+  return find_in(al, 0, al->core.size, item);
 }
 
 size_t calist_index_last(const calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(item, NULL);
 
-  if (al->size == 0) {
-    return CALIST_INDEX_NOT_FOUND;
-  }
-
-  for (size_t i = al->size; i-- > 0;) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      return i;
-    }
-  }
-  return CALIST_INDEX_NOT_FOUND;
+  return find_last_in(al, 0, al->core.size, item);
 }
 
 calist *calist_index_all(const calist *al, const void *item) {
@@ -418,10 +974,10 @@ calist *calist_index_all(const calist *al, const void *item) {
   ASSERT_NOT_NULL(item, NULL);
 
   calist *indices = calist_create(ctype_size_t());
-  for (size_t i = 0; i < al->size; ++i) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      calist_append(indices, &i);
-    }
+  for (size_t i = find_in(al, 0, al->core.size, item); 
+       i != CALIST_INDEX_NOT_FOUND;
+       i = find_in(al, i + 1, al->core.size, item)) {
+    calist_append(indices, &i);
   }
   return indices;
 }
@@ -432,8 +988,8 @@ calist *calist_index_all_if(const calist *al, calist_pred pred,
   ASSERT_NOT_NULL(pred, NULL);
 
   calist *indices = calist_create(ctype_size_t());
-  for (size_t i = 0; i < al->size; ++i) {
-    if (pred(al, al->data[i], args)) {
+  for (size_t i = 0; i < al->core.size; ++i) {
+    if (pred(al, item_at(al, i), args)) {
       calist_append(indices, &i);
     }
   }
@@ -443,14 +999,45 @@ calist *calist_index_all_if(const calist *al, calist_pred pred,
 size_t calist_count(const calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(item, NULL);
+  return count_in(al, 0, al->core.size, item);
+}
 
-  size_t total = 0;
-  for (size_t i = 0; i < al->size; ++i) {
-    if (!data_cmp(item, al->data[i], al->type)) {
-      ++total;
+size_t calist_index_min(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  if (al->core.size == 0) {
+    return CALIST_INDEX_NOT_FOUND;
+  }
+  if (al->kernel != CKERNEL_NONE) {
+    return ckernel_min(al->kernel, al->core.data, al->core.size);
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i < al->core.size; ++i) {
+    if (data_cmp(item_at(al, i), item_at(al, best), al->core.type) < 0) {
+      best = i;
     }
   }
-  return total;
+  return best;
+}
+
+size_t calist_index_max(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  if (al->core.size == 0) {
+    return CALIST_INDEX_NOT_FOUND;
+  }
+  if (al->kernel != CKERNEL_NONE) {
+    return ckernel_max(al->kernel, al->core.data, al->core.size);
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i < al->core.size; ++i) {
+    if (data_cmp(item_at(al, i), item_at(al, best), al->core.type) > 0) {
+      best = i;
+    }
+  }
+  return best;
 }
 
 size_t calist_replace(calist *al, const void *old_item, 
@@ -486,11 +1073,11 @@ size_t calist_replace_all(calist *al, const void *old_item,
   ASSERT_NOT_NULL(new_item, "The new item");
 
   size_t total = 0;
-  for (size_t i = 0; i < al->size; ++i) {
-    if (!data_cmp(old_item, al->data[i], al->type)) {
-      calist_set(al, i, new_item);
-      ++total;
-    }
+  for (size_t i = find_in(al, 0, al->core.size, old_item); 
+       i != CALIST_INDEX_NOT_FOUND;
+       i = find_in(al, i + 1, al->core.size, old_item)) {
+    calist_set(al, i, new_item);
+    ++total;
   }
   return total;
 }
@@ -502,8 +1089,8 @@ size_t calist_replace_if(calist *al, const void *new_item,
   ASSERT_NOT_NULL(pred, NULL);
 
   size_t total = 0;
-  for (size_t i = 0; i < al->size; ++i) {
-    if (pred(al, al->data[i], args)) {
+  for (size_t i = 0; i < al->core.size; ++i) {
+    if (pred(al, item_at(al, i), args)) {
       calist_set(al, i, new_item);
       ++total;
     }
@@ -511,69 +1098,228 @@ size_t calist_replace_if(calist *al, const void *new_item,
   return total;
 }
 
-void calist_qsort(calist *al) {
+void calist_sort(calist *al) {
   ASSERT_NOT_NULL(al, NULL);
-
-  if (al->size > 0) {
-    qsort_range(al, 0, al->size - 1);
+  unshare(al);
+  if (al->kernel != CKERNEL_NONE) {
+    ckernel_sort(al->kernel, al->core.data, al->core.size);
+    return;
   }
+  csort_intro(al->core.data, al->core.size, al->core.width, cmp_slots, al);
 }
 
-size_t calist_bsearch(const calist *al, const void *item) {
+void calist_stable_sort(calist *al) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_NOT_NULL(item, NULL);
-
-  if (al->size == 0) {
-    return CALIST_INDEX_NOT_FOUND;
+  unshare(al);
+  if (al->kernel != CKERNEL_NONE) {
+    ckernel_stable_sort(al->kernel, al->core.data, al->core.size);
+    return;
   }
+  csort_tim(al->core.data, al->core.size, al->core.width, cmp_slots, al);
+}
 
-  size_t low = 0;
-  size_t high = al->size - 1;
+// The context of cmp_slots_by
+typedef struct {
+  const calist *al;
+  calist_cmp cmp;
+} sort_by_ctx;
 
-  while (low <= high) {
-    size_t mid = (low + high) / 2;
-    int cmp = data_cmp(al->data[mid], item, al->type);
-    if (!cmp) {
-      return mid;
-    } else if (cmp < 0) {
-      low = mid + 1;
-    } else {
-      high = mid - 1;
-    }
-  }
-  return CALIST_INDEX_NOT_FOUND;
+void calist_sort_by(calist *al, calist_cmp cmp) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(cmp, NULL);
+  unshare(al);
+  sort_by_ctx ctx = { .al = al, .cmp = cmp };
+  csort_tim(al->core.data, al->core.size, al->core.width, cmp_slots_by, &ctx);
 }
 
-void calist_reverse(calist *al) {
+void calist_qsort(calist *al) {
   ASSERT_NOT_NULL(al, NULL);
-  for (size_t i = 0; i < al->size / 2; ++i) {
-    calist_swap(al, i, al->size - i - 1);
-  }
+  calist_sort(al);
 }
 
-calist *calist_slice(const calist *al, size_t from_index, size_t to_index) {
+size_t calist_bsearch(const calist *al, const void *item) {
   ASSERT_NOT_NULL(al, NULL);
-  ASSERT_MSG(al->size > 0, ASSERT_CALIST_NOT_EMPTY);
-  ASSERT_MSG(from_index < al->size, ASSERT_INDEX_BOUNDED);
-  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
-  ASSERT_MSG(to_index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  ASSERT_NOT_NULL(item, NULL);
+  return bsearch_in(al, 0, al->core.size, item);
+}
 
-  calist *sub = calist_create(al->type);
-  calist_reserve(sub, to_index - from_index);
-  for (size_t i = from_index; i < to_index; ++i) {
-    calist_append(sub, al->data[i]);
+size_t calist_lower_bound(const calist *al, const void *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  return lower_in(al, 0, al->core.size, item);
+}
+
+size_t calist_upper_bound(const calist *al, const void *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  return upper_in(al, 0, al->core.size, item);
+}
+
+void calist_equal_range(const calist *al, const void *item,
+                        size_t *from_index, size_t *to_index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(from_index, "The start index");
+  ASSERT_NOT_NULL(to_index, "The end index");
+
+  *from_index = calist_lower_bound(al, item);
+  *to_index = calist_upper_bound(al, item);
+}
+
+void calist_reverse(calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  unshare(al);
+
+  for (size_t i = 0; i < al->core.size / 2; ++i) {
+    swap_slots(al, i, al->core.size - i - 1);
   }
-  return sub;
+}
+
+calist *calist_slice(const calist *al, size_t from_index, size_t to_index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->core.size > 0, ASSERT_CALIST_NOT_EMPTY);
+  ASSERT_MSG(from_index < al->core.size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  return copy_range(al, from_index, to_index);
+}
+
+calist_view calist_view_of(const calist *al, size_t from_index, 
+                           size_t to_index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= al->core.size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  calist_view view;
+  view.parent = al;
+  view.offset = from_index;
+  view.length = to_index - from_index;
+  view.generation = al->generation;
+  return view;
+}
+
+calist_view calist_view_slice(calist_view view, size_t from_index, 
+                              size_t to_index) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= view.length, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  view.offset += from_index;
+  view.length = to_index - from_index;
+  return view;
+}
+
+bool calist_view_valid(calist_view view) {
+  ASSERT_NOT_NULL(view.parent, NULL);
+  return view.generation == view.parent->generation &&
+         view.offset + view.length <= view.parent->core.size;
+}
+
+const calist *calist_view_parent(calist_view view) {
+  return view.parent;
+}
+
+const ctype *calist_view_type(calist_view view) {
+  ASSERT_NOT_NULL(view.parent, NULL);
+  return view.parent->core.type;
+}
+
+size_t calist_view_size(calist_view view) {
+  return view.length;
+}
+
+bool calist_view_empty(calist_view view) {
+  return view.length == 0;
+}
+
+const void *calist_view_get(calist_view view, size_t index) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_MSG(index < view.length, ASSERT_INDEX_BOUNDED);
+  return item_at(view.parent, view.offset + index);
+}
+
+size_t calist_view_index(calist_view view, const void *item) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t i = find_in(view.parent, view.offset, view.offset + view.length,
+                     item);
+  return (i == CALIST_INDEX_NOT_FOUND) ? i : i - view.offset;
+}
+
+size_t calist_view_index_last(calist_view view, const void *item) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t i = find_last_in(view.parent, view.offset, 
+                          view.offset + view.length, item);
+  return (i == CALIST_INDEX_NOT_FOUND) ? i : i - view.offset;
+}
+
+bool calist_view_contains(calist_view view, const void *item) {
+  return calist_view_index(view, item) != CALIST_INDEX_NOT_FOUND;
+}
+
+size_t calist_view_count(calist_view view, const void *item) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_NOT_NULL(item, NULL);
+  return count_in(view.parent, view.offset, view.offset + view.length, item);
+}
+
+size_t calist_view_bsearch(calist_view view, const void *item) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t i = bsearch_in(view.parent, view.offset, view.offset + view.length,
+                        item);
+  return (i == CALIST_INDEX_NOT_FOUND) ? i : i - view.offset;
+}
+
+size_t calist_view_lower_bound(calist_view view, const void *item) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_NOT_NULL(item, NULL);
+  return lower_in(view.parent, view.offset, view.offset + view.length, 
+                  item) - view.offset;
+}
+
+size_t calist_view_upper_bound(calist_view view, const void *item) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  ASSERT_NOT_NULL(item, NULL);
+  return upper_in(view.parent, view.offset, view.offset + view.length, 
+                  item) - view.offset;
+}
+
+bool calist_view_equals(calist_view v1, calist_view v2) {
+  ASSERT_MSG(calist_view_valid(v1), ASSERT_VIEW_VALID);
+  ASSERT_MSG(calist_view_valid(v2), ASSERT_VIEW_VALID);
+
+  if (v1.length != v2.length || 
+      !ctype_equals(v1.parent->core.type, v2.parent->core.type)) {
+    return false;
+  }
+  return equal_in(v1.parent, v1.offset, v2.parent, v2.offset, v1.length);
+}
+
+void calist_view_print(calist_view view) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+  print_range(view.parent, view.offset, view.offset + view.length);
+}
+
+calist *calist_view_to_calist(calist_view view) {
+  ASSERT_MSG(calist_view_valid(view), ASSERT_VIEW_VALID);
+
+  return copy_range(view.parent, view.offset, view.offset + view.length);
 }
 
 calist *calist_filter(const calist *al, calist_pred pred, const void *args) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(pred, NULL);
 
-  calist *filtered = calist_create(al->type);
-  for (size_t i = 0; i < al->size; ++i) {
-    if (pred(al, al->data[i], args)) {
-      calist_append(filtered, al->data[i]);
+  calist *filtered = create_like(al, DEFAULT_INIT_CAPACITY);
+  for (size_t i = 0; i < al->core.size; ++i) {
+    if (pred(al, item_at(al, i), args)) {
+      calist_append(filtered, item_at(al, i));
     }
   }
   return filtered;
@@ -582,61 +1328,998 @@ calist *calist_filter(const calist *al, calist_pred pred, const void *args) {
 void calist_foreach(const calist *al, calist_map map, const void *args) {
   ASSERT_NOT_NULL(al, NULL);
   ASSERT_NOT_NULL(map, NULL);
+  unshare((calist *) al);
 
-  for (size_t i = 0; i < al->size; ++i) {
-    map(al, al->data[i], args);
+  for (size_t i = 0; i < al->core.size; ++i) {
+    map(al, item_at(al, i), args);
   }
 }
 
 calist *calist_unique(const calist *al) {
   ASSERT_NOT_NULL(al, NULL);
 
-  calist *unique = calist_create(al->type);
-  for (size_t i = 0; i < al->size; ++i) {
-    if (!calist_contains(unique, al->data[i])) {
-      calist_append(unique, al->data[i]);
+  bool *keep = mark_unique(al);
+  size_t kept = 0;
+  for (size_t i = 0; i < al->core.size; ++i) {
+    kept += keep[i];
+  }
+
+  calist *unique = create_like(al, kept ? kept : DEFAULT_INIT_CAPACITY);
+  for (size_t i = 0; i < al->core.size; ++i) {
+    if (keep[i]) {
+      store_item(unique, unique->core.size++, item_at(al, i));
     }
   }
+  free(keep);
   return unique;
 }
 
 size_t calist_remove_dup(calist *al) {
   ASSERT_NOT_NULL(al, NULL);
+  unshare(al);
 
-  size_t total = 0;
-  for (size_t i = 0; i < al->size; ++i) {
-    for (size_t j = al->size; j-- > i + 1;) {
-      if (!data_cmp(al->data[j], al->data[i], al->type)) {
-        calist_pop(al, j);
-        ++total;
-      }
+  bool *keep = mark_unique(al);
+  size_t kept = 0;
+  for (size_t i = 0; i < al->core.size; ++i) {
+    if (keep[i]) {
+      shift_slots(al, i, kept++, 1);
+    } else {
+      release_item(al, i);
     }
   }
+  free(keep);
+
+  size_t total = al->core.size - kept;
+  al->core.size = kept;
+  shrink_if_sparse(al);
   return total;
 }
 
-// Helper function implementation
-static void qsort_range(calist *al, size_t first, size_t last) {
+cpool *calist_pool(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->pool ? al->pool : cpool_default();
+}
+
+void calist_set_pool(calist *al, cpool *pool) {
+  ASSERT_NOT_NULL(al, NULL);
+  al->pool = pool;
+}
+
+void calist_par_foreach(const calist *al, calist_map map, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(map, NULL);
+  unshare((calist *) al);
+
+  par_job job;
+  par_job_init(&job, al, args);
+  job.map = map;
+  cpool_for(calist_pool(al), al->core.size, par_map_chunk, &job);
+}
+
+calist *calist_par_filter(const calist *al, calist_pred pred, 
+                          const void *args) {
   ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
 
-  if (last <= first) {
+  par_job job;
+  par_job_init(&job, al, args);
+  job.pred = pred;
+  job.keep = malloc(sizeof(*job.keep) * (al->core.size ? al->core.size : 1));
+  job.counts = calloc(par_chunks(&job) + 1, sizeof(*job.counts));
+  if (!job.keep || !job.counts) {
+    ALLOC_ERROR("filter marks");
+  }
+  cpool_for(calist_pool(al), al->core.size, par_pred_chunk, &job);
+
+  // Items are copied in order [ctypes and allocators need not be 
+  //   thread-safe]
+  size_t kept = 0;
+  for (size_t c = 0; c < par_chunks(&job); ++c) {
+    kept += job.counts[c];
+  }
+  calist *filtered = create_like(al, kept ? kept : DEFAULT_INIT_CAPACITY);
+  for (size_t i = 0; i < al->core.size; ++i) {
+    if (job.keep[i]) {
+      store_item(filtered, filtered->core.size++, item_at(al, i));
+    }
+  }
+  free(job.keep);
+  free(job.counts);
+  return filtered;
+}
+
+size_t calist_par_count_if(const calist *al, calist_pred pred, 
+                           const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  par_job job;
+  par_job_init(&job, al, args);
+  job.pred = pred;
+  job.counts = calloc(par_chunks(&job) + 1, sizeof(*job.counts));
+  if (!job.counts) {
+    ALLOC_ERROR("chunk counts");
+  }
+  cpool_for(calist_pool(al), al->core.size, par_pred_chunk, &job);
+
+  size_t count = 0;
+  for (size_t c = 0; c < par_chunks(&job); ++c) {
+    count += job.counts[c];
+  }
+  free(job.counts);
+  return count;
+}
+
+void calist_par_reduce(const calist *al, void *acc, size_t acc_size,
+                       calist_reduce reduce, calist_combine combine,
+                       const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(acc, NULL);
+  ASSERT_MSG(acc_size, "The accumulator size cannot be zero!");
+  ASSERT_NOT_NULL(reduce, NULL);
+  ASSERT_NOT_NULL(combine, NULL);
+
+  par_job job;
+  par_job_init(&job, al, args);
+  job.reduce = reduce;
+  job.init = acc;
+  job.acc_size = acc_size;
+  size_t chunks = par_chunks(&job);
+  if (chunks > SIZE_MAX / acc_size) {
+    ALLOC_ERROR("chunk accumulators");
+  }
+  job.parts = malloc(acc_size * (chunks ? chunks : 1));
+  if (!job.parts) {
+    ALLOC_ERROR("chunk accumulators");
+  }
+  cpool_for(calist_pool(al), al->core.size, par_reduce_chunk, &job);
+
+  for (size_t c = 0; c < chunks; ++c) {
+    combine(acc, job.parts + c * acc_size, args);
+  }
+  free(job.parts);
+}
+
+void calist_par_sort(calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  unshare(al);
+  csort_cmp cmp = (al->kernel != CKERNEL_NONE) ? 
+                  ckernel_slot_cmp(al->kernel) : cmp_slots;
+  csort_par(calist_pool(al), al->core.data, al->core.size, al->core.width, 
+            cmp, al, par_sort_block);
+}
+
+// Helper function implementation
+static inline void *slot_at(const calist *al, size_t index) {
+  return al->core.data + index * al->core.width;
+}
+
+static inline void *item_at(const calist *al, size_t index) {
+  return slot_item(al, slot_at(al, index));
+}
+
+// Produce the item held by slot
+static inline void *slot_item(const calist *al, const void *slot) {
+  if (al->core.boxed) {
+    return *(void *const *) slot;
+  }
+  if (al->core.slotted) {
+    return (void *) data_slot_value(slot, al->core.type);
+  }
+  return (void *) slot;
+}
+
+// Check if the items of al are copied, moved and freed as plain bytes
+static inline bool bitwise(const calist *al) {
+  return !al->core.boxed && !al->core.slotted;
+}
+
+// Copy item into the slot at index [the slot must not hold a live item]
+static void store_item(calist *al, size_t index, const void *item) {
+  if (al->core.slotted) {
+    if (!data_slot_store(slot_at(al, index), item, al->core.type, al->alloc)) {
+      FATAL_ERROR(ERROR_ITEM_DUP);
+    }
+    COUNT(al, dups, 1);
+    return;
+  }
+  if (!al->core.boxed) {
+    memcpy(slot_at(al, index), item, al->core.width);
     return;
   }
 
-  void *pivot = al->data[first];
-  size_t pos = last;
+  void *item_copy = data_dup_with(item, al->core.type, al->alloc);
+  if (!item_copy) {
+    FATAL_ERROR(ERROR_ITEM_DUP);
+  }
+  COUNT(al, dups, 1);
+  *(void **) slot_at(al, index) = item_copy;
+}
+
+// Free the item at index [inline POD items own no memory]
+static void release_item(const calist *al, size_t index) {
+  if (bitwise(al)) return;
+
+  if (al->core.boxed) {
+    data_destroy_with(item_at(al, index), al->core.type, al->alloc);
+  } else {
+    data_slot_release(slot_at(al, index), al->core.type, al->alloc);
+  }
+  // The items of a calist are its own even where it is const
+  COUNT((calist *) al, destroys, 1);
+}
+
+// Move the owned item into the slot at index [the slot must not hold a 
+//   live item]
+static void adopt_item(calist *al, size_t index, void *item) {
+  if (al->core.boxed) {
+    *(void **) slot_at(al, index) = item;
+  } else {
+    store_item(al, index, item);
+    data_destroy_with(item, al->core.type, al->alloc);
+    COUNT(al, destroys, 1);
+  }
+}
+
+// Make the slot at index free for one more item, growing al if it is full
+//   and shifting the following slots to the right
+static void open_slot(calist *al, size_t index) {
+  grow_to_fit(al, al->core.size + 1);
+  shift_slots(al, index, index + 1, al->core.size - index);
+}
 
-  for (size_t i = last; i > first; --i) {
-    if (data_cmp(al->data[i], pivot, al->type) > 0) {
-      calist_swap(al, i, pos);
-      --pos;
+static void swap_slots(calist *al, size_t i, size_t j) {
+  csort_swap(slot_at(al, i), slot_at(al, j), al->core.width);
+}
+
+// Set the counters of al to 0, with its current size and capacity as the
+//   peaks
+static void reset_stats(calist *al) {
+#if CALIST_STATS
+  memset(&al->stats, 0, sizeof(al->stats));
+  al->stats.peak_size = al->core.size;
+  al->stats.peak_capacity = al->capacity;
+#else
+  (void) al;
+#endif
+}
+
+// Move count slots starting at index from to index to
+static void shift_slots(calist *al, size_t from, size_t to, size_t count) {
+  if (count > 0 && from != to) {
+    memmove(slot_at(al, to), slot_at(al, from), al->core.width * count);
+    COUNT(al, shifted, count);
+  }
+}
+
+// Resize the storage of al to n slots, producing false if allocation fails
+//   [al is unchanged]
+static bool resize_storage(calist *al, size_t n) {
+  if (n > SIZE_MAX / al->core.width) {
+    return false;
+  }
+  if (al->map) {
+    if (!cmap_resize(al->map, n)) {
+      return false;
     }
+    al->core.data = cmap_data(al->map);
+    al->capacity = n;
+    ++al->generation;
+    COUNT(al, reallocs, 1);
+    COUNT_PEAK(al, peak_capacity, n);
+    return true;
+  }
+  unsigned char *new_data = callocator_resize(al->alloc, al->core.data,
+                                             al->core.width * al->capacity,
+                                             al->core.width * n);
+  if (!new_data) {
+    return false;
+  }
+  al->core.data = new_data;
+  al->capacity = n;
+  ++al->generation;
+  COUNT(al, reallocs, 1);
+  COUNT(al, bytes_moved, al->core.width * al->core.size);
+  COUNT_PEAK(al, peak_capacity, n);
+  return true;
+}
+
+// Produce n times the growth factor of al, which is more than n unless n
+//   is SIZE_MAX
+static size_t scale_capacity(const calist *al, size_t n) {
+  double scaled = (double) n * al->growth.factor;
+  if (scaled >= (double) SIZE_MAX) {
+    return SIZE_MAX;
   }
-  calist_swap(al, first, pos);
+  size_t capacity = (size_t) scaled;
+  return (capacity > n || n == SIZE_MAX) ? capacity : n + 1;
+}
 
-  // Prevent underflow when pos == 0
-  if (pos > 0) {
-    qsort_range(al, first, pos - 1);
+// Produce the capacity the growth policy of al picks for at least n slots
+static size_t plan_capacity(const calist *al, size_t n) {
+  const calist_growth *growth = &al->growth;
+  if (n < growth->min_capacity) {
+    n = growth->min_capacity;
+  }
+  size_t limit = SIZE_MAX / al->core.width;
+  if (n > limit || !growth->huge_threshold || 
+      n * al->core.width < growth->huge_threshold) {
+    return n;
+  }
+
+  // Large storage is rounded up to a whole number of huge pages
+  size_t bytes = n * al->core.width;
+  size_t extra = (growth->huge_page - bytes % growth->huge_page) 
+                 % growth->huge_page;
+  return (extra > SIZE_MAX - bytes) ? n : (bytes + extra) / al->core.width;
+}
+
+// Grow al by its growth factor, or further if needed, until it can hold
+//   needed items
+static void grow_to_fit(calist *al, size_t needed) {
+  COUNT_PEAK(al, peak_size, needed);
+  if (needed <= al->capacity) return;
+
+  size_t limit = SIZE_MAX / al->core.width;
+  size_t capacity = scale_capacity(al, al->capacity);
+  if (capacity < needed) {
+    capacity = needed;
+  }
+  if (capacity > limit && needed <= limit) {
+    capacity = limit;
+  }
+  calist_reserve(al, plan_capacity(al, capacity));
+}
+
+// Shrink al to its growth factor times its size once it is sparse enough
+//   under its growth policy [shrinking is best-effort and never fails]
+static void shrink_if_sparse(calist *al) {
+  double below = al->growth.shrink_below;
+  if (below <= 0 || al->capacity <= al->growth.min_capacity ||
+      (double) al->core.size >= below * (double) al->capacity) {
+    return;
+  }
+  size_t capacity = plan_capacity(al, scale_capacity(al, al->core.size));
+  if (capacity < al->capacity) {
+    // Snapshots may still read the shared storage [see 
+    //   calist_set_growth_policy]
+    unshare(al);
+    resize_storage(al, capacity);
+  }
+}
+
+// Give al slots and items of its own if it shares them with snapshots,
+//   by copying them [items may still point into the shared storage, which
+//   the other sharers keep alive]
+static void unshare(calist *al) {
+  if (!al->shared) return;
+
+  if (__atomic_load_n(al->shared, __ATOMIC_ACQUIRE) > 1) {
+    calist *copy = calist_dup(al);
+    if (release_share(al)) {
+      // The other sharers were destroyed meanwhile, so the shared storage
+      //   is al's own after all
+      calist_destroy(copy);
+      return;
+    }
+    al->core.data = copy->core.data;
+    al->capacity = copy->capacity;
+    ++al->generation;
+    COUNT(al, dups, copy->stats.dups);
+    callocator_release(al->alloc, copy, sizeof(*copy));
+  } else {
+    free(al->shared);
+  }
+  al->shared = NULL;
+}
+
+// Drop the share of al in its shared storage, producing true if al was 
+//   the last sharer [al then owns the storage alone]
+static bool release_share(calist *al) {
+  if (__atomic_sub_fetch(al->shared, 1, __ATOMIC_ACQ_REL) > 0) {
+    al->shared = NULL;
+    return false;
+  }
+  free(al->shared);
+  al->shared = NULL;
+  return true;
+}
+
+// Free the items and slots of al
+static void release_storage(calist *al) {
+  if (!bitwise(al)) {
+    for (size_t i = 0; i < al->core.size; ++i) {
+      release_item(al, i);
+    }
+  }
+  if (al->map) {
+    cmap_close(al->map, al->core.size);
+  } else {
+    callocator_release(al->alloc, al->core.data, al->core.width * al->capacity);
+  }
+}
+
+// Check if item points into the storage of al
+static bool in_storage(const calist *al, const void *item) {
+  uintptr_t begin = (uintptr_t) al->core.data;
+  uintptr_t addr = (uintptr_t) item;
+  return (addr >= begin && addr < begin + al->core.width * al->capacity);
+}
+
+// Create an empty calist with the same type and storage as al
+static calist *create_like(const calist *al, size_t init_cap) {
+  calist *like = calist_create_alloc(al->core.type, init_cap, 
+                                     calist_storage_mode(al), al->alloc);
+  like->growth = al->growth;
+  like->pool = al->pool;
+  return like;
+}
+
+// Produce the first index position in [from, end) of item in al, 
+//   or CALIST_INDEX_NOT_FOUND
+static size_t find_in(const calist *al, size_t from, size_t end,
+                      const void *item) {
+  if (al->kernel != CKERNEL_NONE) {
+    size_t n = end - from;
+    size_t i = ckernel_find(al->kernel, slot_at(al, from), n, item);
+    return (i == n) ? CALIST_INDEX_NOT_FOUND : from + i;
+  }
+  if (al->canonical) {
+    const void *canon = data_canonical(item, al->core.type);
+    void *const *items = (void *const *) al->core.data;
+    for (size_t i = from; canon && i < end; ++i) {
+      if (items[i] == canon) {
+        return i;
+      }
+    }
+    return CALIST_INDEX_NOT_FOUND;
+  }
+  if (al->core.slotted) {
+    size_t n = end - from;
+    size_t i = data_slot_find(slot_at(al, from), n, item, al->core.type);
+    return (i == n) ? CALIST_INDEX_NOT_FOUND : from + i;
+  }
+
+  for (size_t i = from; i < end; ++i) {
+    if (!data_cmp(item, item_at(al, i), al->core.type)) {
+      return i;
+    }
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+// Produce the last index position in [from, end) of item in al,
+//   or CALIST_INDEX_NOT_FOUND
+static size_t find_last_in(const calist *al, size_t from, size_t end,
+                           const void *item) {
+  if (al->kernel != CKERNEL_NONE) {
+    size_t n = end - from;
+    size_t i = ckernel_find_last(al->kernel, slot_at(al, from), n, item);
+    return (i == n) ? CALIST_INDEX_NOT_FOUND : from + i;
+  }
+  if (al->canonical) {
+    const void *canon = data_canonical(item, al->core.type);
+    void *const *items = (void *const *) al->core.data;
+    for (size_t i = end; canon && i-- > from;) {
+      if (items[i] == canon) {
+        return i;
+      }
+    }
+    return CALIST_INDEX_NOT_FOUND;
+  }
+  if (al->core.slotted) {
+    size_t n = end - from;
+    size_t i = data_slot_find_last(slot_at(al, from), n, item, al->core.type);
+    return (i == n) ? CALIST_INDEX_NOT_FOUND : from + i;
+  }
+
+  for (size_t i = end; i-- > from;) {
+    if (!data_cmp(item, item_at(al, i), al->core.type)) {
+      return i;
+    }
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+// Produce the number of items in [from, end) of al equal to item
+static size_t count_in(const calist *al, size_t from, size_t end,
+                       const void *item) {
+  size_t n = end - from;
+  if (al->kernel != CKERNEL_NONE) {
+    return ckernel_count(al->kernel, slot_at(al, from), n, item);
+  }
+  if (al->canonical) {
+    const void *canon = data_canonical(item, al->core.type);
+    void *const *items = (void *const *) al->core.data;
+    size_t total = 0;
+    for (size_t i = from; canon && i < end; ++i) {
+      total += (items[i] == canon);
+    }
+    return total;
+  }
+  if (al->core.slotted) {
+    return data_slot_count(slot_at(al, from), n, item, al->core.type);
+  }
+
+  size_t total = 0;
+  for (size_t i = from; i < end; ++i) {
+    if (!data_cmp(item, item_at(al, i), al->core.type)) {
+      ++total;
+    }
+  }
+  return total;
+}
+
+// Produce an index position in [from, end) of item in the sorted range of
+//   al, or CALIST_INDEX_NOT_FOUND
+static size_t bsearch_in(const calist *al, size_t from, size_t end,
+                         const void *item) {
+  if (from == end) {
+    return CALIST_INDEX_NOT_FOUND;
+  }
+
+  if (al->kernel != CKERNEL_NONE) {
+    size_t n = end - from;
+    size_t index = ckernel_bsearch(al->kernel, slot_at(al, from), n, item);
+    return (index == n) ? CALIST_INDEX_NOT_FOUND : from + index;
+  }
+
+  size_t low = from;
+  size_t high = end - 1;
+
+  while (low <= high) {
+    size_t mid = low + (high - low) / 2;
+    int cmp = data_cmp(item_at(al, mid), item, al->core.type);
+    if (!cmp) {
+      return mid;
+    } else if (cmp < 0) {
+      low = mid + 1;
+    } else {
+      // Prevent underflow when mid == from == 0
+      if (mid == from) break;
+      high = mid - 1;
+    }
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+// Produce the first index position in [from, end] of the sorted range of
+//   al at which item may be inserted
+static size_t lower_in(const calist *al, size_t from, size_t end,
+                       const void *item) {
+  if (al->kernel != CKERNEL_NONE) {
+    return from + ckernel_lower_bound(al->kernel, slot_at(al, from),
+                                      end - from, item);
+  }
+
+  size_t low = from;
+  size_t n = end - from;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (data_cmp(item_at(al, low + half), item, al->core.type) < 0) {
+      low += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return low;
+}
+
+// Produce the last index position in [from, end] of the sorted range of
+//   al at which item may be inserted
+static size_t upper_in(const calist *al, size_t from, size_t end,
+                       const void *item) {
+  if (al->kernel != CKERNEL_NONE) {
+    return from + ckernel_upper_bound(al->kernel, slot_at(al, from),
+                                      end - from, item);
+  }
+
+  size_t low = from;
+  size_t n = end - from;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (data_cmp(item_at(al, low + half), item, al->core.type) <= 0) {
+      low += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return low;
+}
+
+// Produce true if the n items of l1 from from1 equal those of l2 from
+//   from2, where l1 and l2 have the same type
+static bool equal_in(const calist *l1, size_t from1, const calist *l2,
+                     size_t from2, size_t n) {
+  if (l1->kernel != CKERNEL_NONE && l2->kernel != CKERNEL_NONE) {
+    return ckernel_equal(l1->kernel, slot_at(l1, from1), slot_at(l2, from2),
+                         n);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (data_cmp(item_at(l1, from1 + i), item_at(l2, from2 + i), 
+                 l1->core.type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Write the items in [from, end) of al as text to sink [see calist_write]
+static bool write_range(const calist *al, size_t from, size_t end,
+                        calist_sink sink, void *ctx) {
+  text_writer w;
+  w.sink = sink;
+  w.ctx = ctx;
+  w.fill = 0;
+  w.ok = true;
+
+  write_text(&w, "[", 1);
+  for (size_t i = from; i < end && w.ok; ++i) {
+    if (i != from) {
+      write_text(&w, ", ", 2);
+    }
+    write_item(&w, item_at(al, i), al->core.type);
+  }
+  write_text(&w, "]", 1);
+  flush_text(&w);
+  return w.ok;
+}
+
+// Display the items in [from, end) of al [see calist_print]
+static void print_range(const calist *al, size_t from, size_t end) {
+  if (ctype_has_format(al->core.type)) {
+    write_range(al, from, end, sink_file, stdout);
+    putchar('\n');
+    return;
+  }
+
+  printf("[");
+  for (size_t i = from; i < end; ++i) {
+    if (i != from) {
+      printf(", ");
+    }
+    data_print(item_at(al, i), al->core.type);
+  }
+  printf("]\n");
+}
+
+// Create a calist like al holding copies of the items in [from, end) of al
+static calist *copy_range(const calist *al, size_t from, size_t end) {
+  size_t range = end - from;
+  calist *sub = create_like(al, range ? range : DEFAULT_INIT_CAPACITY);
+  if (!bitwise(al)) {
+    for (size_t i = 0; i < range; ++i) {
+      store_item(sub, i, item_at(al, from + i));
+    }
+  } else {
+    memcpy(sub->core.data, slot_at(al, from), al->core.width * range);
+  }
+  sub->core.size = range;
+  return sub;
+}
+
+// Compare the items held by slots a and b of the calist ctx
+static int cmp_slots(const void *a, const void *b, const void *ctx) {
+  const calist *al = ctx;
+  return data_cmp(slot_item(al, a), slot_item(al, b), al->core.type);
+}
+
+// Compare the items held by slots a and b with a client comparator
+static int cmp_slots_by(const void *a, const void *b, const void *ctx) {
+  const sort_by_ctx *by = ctx;
+  return by->cmp(slot_item(by->al, a), slot_item(by->al, b));
+}
+
+// Produce a heap-allocated array of al->core.size flags, where flag i is true
+//   if the item at i is the first occurrence of its value in al
+//   [caller must free the array]
+static bool *mark_unique(const calist *al) {
+  bool *keep = malloc(al->core.size ? al->core.size * sizeof(*keep) : 1);
+  if (!keep) {
+    ALLOC_ERROR("unique flags of calist");
+  }
+  if (al->core.size > 0) {
+    if (ctype_has_hash(al->core.type)) {
+      mark_unique_hash(al, keep);
+    } else {
+      mark_unique_sort(al, keep);
+    }
+  }
+  return keep;
+}
+
+// An entry of the open-addressing table used by mark_unique_hash
+//   [index is SIZE_MAX if the entry is empty]
+typedef struct {
+  size_t hash;
+  size_t index;
+} unique_entry;
+
+// Spread the bits of hash over the low bits used for the table position
+static inline size_t mix_hash(size_t hash) {
+  hash ^= hash >> (sizeof(size_t) * 4);
+  hash *= (size_t) 0x9E3779B97F4A7C15ULL;
+  return hash ^ (hash >> (sizeof(size_t) * 4));
+}
+
+// Mark first occurrences in O(n) expected time with the hash method,
+//   keeping the index of each first occurrence in a linear-probing table
+static void mark_unique_hash(const calist *al, bool *keep) {
+  if (al->core.size > SIZE_MAX / 4 / sizeof(unique_entry)) {
+    ALLOC_ERROR("hash table of calist");
+  }
+  size_t capacity = 2;
+  while (capacity < al->core.size * 2) {
+    capacity *= 2;
+  }
+  unique_entry *table = malloc(capacity * sizeof(*table));
+  if (!table) {
+    ALLOC_ERROR("hash table of calist");
+  }
+  for (size_t i = 0; i < capacity; ++i) {
+    table[i].index = SIZE_MAX;
+  }
+
+  size_t mask = capacity - 1;
+  for (size_t i = 0; i < al->core.size; ++i) {
+    const void *item = item_at(al, i);
+    size_t hash = data_hash(item, al->core.type);
+    size_t pos = mix_hash(hash) & mask;
+    keep[i] = true;
+    for (; table[pos].index != SIZE_MAX; pos = (pos + 1) & mask) {
+      if (table[pos].hash == hash &&
+          !data_cmp(item, item_at(al, table[pos].index), al->core.type)) {
+        keep[i] = false;
+        break;
+      }
+    }
+    if (keep[i]) {
+      table[pos].hash = hash;
+      table[pos].index = i;
+    }
+  }
+  free(table);
+}
+
+// Mark first occurrences in O(n log n) time without a hash method: 
+//   stably sorting the indices by item places each first occurrence at 
+//   the front of its run of equal items
+static void mark_unique_sort(const calist *al, bool *keep) {
+  size_t *order = malloc(al->core.size * sizeof(*order));
+  if (!order) {
+    ALLOC_ERROR("index order of calist");
+  }
+  for (size_t i = 0; i < al->core.size; ++i) {
+    order[i] = i;
+  }
+  csort_tim(order, al->core.size, sizeof(*order), cmp_indices, al);
+
+  for (size_t run = 0; run < al->core.size;) {
+    const void *first = item_at(al, order[run]);
+    keep[order[run]] = true;
+    size_t next = run + 1;
+    for (; next < al->core.size; ++next) {
+      if (data_cmp(item_at(al, order[next]), first, al->core.type)) break;
+      keep[order[next]] = false;
+    }
+    run = next;
+  }
+  free(order);
+}
+
+// Compare the items of the calist ctx at the indices a and b
+static int cmp_indices(const void *a, const void *b, const void *ctx) {
+  const calist *al = ctx;
+  return data_cmp(item_at(al, *(const size_t *) a), 
+                  item_at(al, *(const size_t *) b), al->core.type);
+}
+
+// Append n characters of text to w
+static void write_text(text_writer *w, const char *text, size_t n) {
+  if (n > TEXT_BUFFER_SIZE - w->fill) {
+    flush_text(w);
+  }
+  if (n > TEXT_BUFFER_SIZE) {
+    w->ok = w->ok && (w->sink(text, n, w->ctx) == n);
+    return;
+  }
+  memcpy(w->buf + w->fill, text, n);
+  w->fill += n;
+}
+
+// Append the text of item to w, formatting it straight into the buffer
+//   when it fits
+static void write_item(text_writer *w, const void *item, const ctype *type) {
+  size_t space = TEXT_BUFFER_SIZE - w->fill;
+  size_t len = data_format(item, w->buf + w->fill, space, type);
+  if (len <= space) {
+    w->fill += len;
+    return;
+  }
+  flush_text(w);
+  if (len <= TEXT_BUFFER_SIZE) {
+    w->fill = data_format(item, w->buf, TEXT_BUFFER_SIZE, type);
+    return;
+  }
+
+  // Text longer than the whole buffer is formatted on its own
+  char *text = malloc(len);
+  if (!text) {
+    ALLOC_ERROR("text of item");
+  }
+  data_format(item, text, len, type);
+  w->ok = w->ok && (w->sink(text, len, w->ctx) == len);
+  free(text);
+}
+
+static void flush_text(text_writer *w) {
+  if (w->fill > 0) {
+    w->ok = w->ok && (w->sink(w->buf, w->fill, w->ctx) == w->fill);
+    w->fill = 0;
+  }
+}
+
+static size_t sink_file(const char *buf, size_t n, void *ctx) {
+  return fwrite(buf, 1, n, ctx);
+}
+
+// Keep as much of the text as fits, leaving room for a null terminator,
+//   while counting all of it
+static size_t sink_buffer(const char *buf, size_t n, void *ctx) {
+  text_buffer *text = ctx;
+  if (text->len + 1 < text->cap) {
+    size_t room = text->cap - 1 - text->len;
+    memcpy(text->buf + text->len, buf, (n < room) ? n : room);
+  }
+  text->len += n;
+  return n;
+}
+
+// Produce the id recorded for type in saved calists: the built-in numeric
+//   ctypes and the string ctypes [which share one encoding] have their 
+//   own ids, and all other ctypes have id 0
+static uint32_t saved_type_id(const ctype *type) {
+  switch (ckernel_select(type)) {
+    case CKERNEL_INT: return 1;
+    case CKERNEL_LONG: return 2;
+    case CKERNEL_CHAR: return 3;
+    case CKERNEL_BOOL: return 4;
+    case CKERNEL_SIZE_T: return 5;
+    case CKERNEL_FLOAT: return 6;
+    case CKERNEL_DOUBLE: return 7;
+    case CKERNEL_NONE: break;
+  }
+  return ctype_is_string(type) ? 8 : 0;
+}
+
+// Write the payload of al to s, serializing items into *buf [of *cap bytes,
+//   grown as needed]
+static void save_payload(const calist *al, cstream *s, unsigned char **buf, 
+                         size_t *cap) {
+  if (ctype_is_pod(al->core.type)) {
+    if (bitwise(al)) {
+      cstream_write(s, al->core.data, al->core.width * al->core.size);
+    } else {
+      for (size_t i = 0; i < al->core.size; ++i) {
+        cstream_write(s, item_at(al, i), data_size(al->core.type));
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < al->core.size; ++i) {
+    const void *item = item_at(al, i);
+    size_t len = data_serialize(item, *buf, *cap, al->core.type);
+    if (len > *cap) {
+      reserve_buffer(buf, cap, len);
+      data_serialize(item, *buf, *cap, al->core.type);
+    }
+    uint64_t saved_len = len;
+    cstream_write(s, &saved_len, sizeof(saved_len));
+    cstream_write(s, *buf, len);
+  }
+}
+
+// Read count items from s into the empty al, producing false if s ends 
+//   early or an item cannot be deserialized
+static bool load_payload(calist *al, cstream *s, size_t count) {
+  if (ctype_is_pod(al->core.type)) {
+    // The items are read straight into the inline storage
+    if (!cstream_read(s, al->core.data, al->core.width * count)) {
+      return false;
+    }
+    al->core.size = count;
+    return true;
+  }
+
+  unsigned char *buf = NULL;
+  size_t cap = 0;
+  bool ok = true;
+  for (size_t i = 0; i < count && ok; ++i) {
+    uint64_t saved_len = 0;
+    ok = cstream_read(s, &saved_len, sizeof(saved_len)) && 
+         saved_len <= SIZE_MAX;
+    size_t len = (size_t) saved_len;
+    if (ok && len > cap) {
+      reserve_buffer(&buf, &cap, len);
+    }
+    void *item = NULL;
+    ok = ok && cstream_read(s, buf, len) &&
+         (item = data_deserialize(buf, len, al->core.type)) != NULL;
+    if (ok) {
+      calist_append_owned(al, item);
+    }
+  }
+  free(buf);
+  return ok;
+}
+
+static void reserve_buffer(unsigned char **buf, size_t *cap, size_t n) {
+  size_t new_cap = (*cap > SIZE_MAX / 2) ? SIZE_MAX : *cap * 2;
+  if (new_cap < n) {
+    new_cap = n;
+  }
+  unsigned char *new_buf = realloc(*buf, new_cap);
+  if (!new_buf) {
+    ALLOC_ERROR("serialization buffer");
+  }
+  *buf = new_buf;
+  *cap = new_cap;
+}
+
+static void par_job_init(par_job *job, const calist *al, const void *args) {
+  memset(job, 0, sizeof(*job));
+  job->al = al;
+  job->args = args;
+  job->grain = cpool_grain(calist_pool(al));
+}
+
+// Produce the number of chunks that cpool_for splits the items of the 
+//   calist of job into
+static size_t par_chunks(const par_job *job) {
+  size_t n = job->al->core.size;
+  return n / job->grain + (n % job->grain != 0);
+}
+
+static void par_map_chunk(void *ctx, size_t begin, size_t end) {
+  par_job *job = ctx;
+  for (size_t i = begin; i < end; ++i) {
+    job->map(job->al, item_at(job->al, i), job->args);
+  }
+}
+
+// Count the items in the chunk that satisfy pred, recording each result 
+//   if job keeps them
+static void par_pred_chunk(void *ctx, size_t begin, size_t end) {
+  par_job *job = ctx;
+  size_t count = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bool satisfied = job->pred(job->al, item_at(job->al, i), job->args);
+    if (job->keep) {
+      job->keep[i] = satisfied;
+    }
+    count += satisfied;
+  }
+  job->counts[begin / job->grain] = count;
+}
+
+static void par_reduce_chunk(void *ctx, size_t begin, size_t end) {
+  par_job *job = ctx;
+  unsigned char *part = job->parts + (begin / job->grain) * job->acc_size;
+  memcpy(part, job->init, job->acc_size);
+  for (size_t i = begin; i < end; ++i) {
+    job->reduce(job->al, part, item_at(job->al, i), job->args);
+  }
+}
+
+// Sort a block of the slots of the calist ctx like calist_stable_sort
+static void par_sort_block(void *base, size_t n, const void *ctx) {
+  const calist *al = ctx;
+  if (al->kernel != CKERNEL_NONE) {
+    ckernel_stable_sort(al->kernel, base, n);
+    return;
   }
-  qsort_range(al, pos + 1, last);
+  csort_tim(base, n, al->core.width, cmp_slots, al);
 }
@@ -0,0 +1,632 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "callocator.h"
+#include "cerror.h"
+
+struct callocator {
+  void *(*alloc)(void *, size_t);
+  void *(*resize)(void *, void *, size_t, size_t);
+  void (*release)(void *, void *, size_t);
+  void *ctx;
+  void (*reset)(void *);    // NULL unless the allocator owns its memory
+  void (*destroy)(void *);  // frees ctx and everything allocated from it
+};
+
+// A type with the strictest alignment among the built-in types
+typedef union {
+  long double ld;
+  long long ll;
+  double d;
+  void *p;
+  void (*f)(void);
+} max_align;
+
+#define ALIGNMENT sizeof(max_align)
+
+// Round n up to a multiple of ALIGNMENT
+#define ALIGN_UP(n) (((n) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT)
+
+// === Arena ===
+// A block of an arena, followed by capacity bytes of memory
+typedef struct arena_block {
+  struct arena_block *next;
+  size_t capacity;
+  size_t used;
+} arena_block;
+
+#define ARENA_HEADER ALIGN_UP(sizeof(arena_block))
+
+// Blocks are kept across resets and reused in order
+typedef struct {
+  arena_block *first;
+  arena_block *current;
+  unsigned char *last;  // the most recent allocation in current, or NULL
+  size_t block_size;
+} arena;
+
+// === Pool ===
+// Allocations of at most POOL_SMALL_MAX bytes are served by size class
+#define POOL_SMALL_MAX 256
+#define POOL_CLASSES (POOL_SMALL_MAX / ALIGNMENT)
+static const size_t POOL_SLAB_SIZE = 64 * 1024;
+
+// A free chunk of a size class
+typedef struct pool_chunk {
+  struct pool_chunk *next;
+} pool_chunk;
+
+// A slab that small chunks are carved from
+typedef struct pool_slab {
+  struct pool_slab *next;
+} pool_slab;
+
+// A large allocation, followed by its memory
+typedef struct pool_large {
+  struct pool_large *prev;
+  struct pool_large *next;
+} pool_large;
+
+#define POOL_SLAB_HEADER ALIGN_UP(sizeof(pool_slab))
+#define POOL_LARGE_HEADER ALIGN_UP(sizeof(pool_large))
+
+typedef struct {
+  pool_chunk *free_lists[POOL_CLASSES];
+  pool_slab *slabs;
+  unsigned char *cursor;  // the unused part of the newest slab
+  unsigned char *limit;
+  pool_large *large;
+} pool;
+
+// === Slab ===
+// Slabs hold SLAB_MIN_OBJECTS objects at first and double while they
+//   stay within SLAB_MAX_BYTES bytes
+static const size_t SLAB_MIN_OBJECTS = 64;
+static const size_t SLAB_MAX_BYTES = 64 * 1024;
+
+// A slab of objects [the objects follow the header]
+typedef struct slab_block {
+  struct slab_block *next;
+} slab_block;
+
+#define SLAB_HEADER ALIGN_UP(sizeof(slab_block))
+
+// A slab allocator [large allocations are tracked like those of a pool]
+typedef struct {
+  size_t object_size;     // the size served from slabs
+  size_t stride;          // the bytes taken by each object
+  size_t batch;           // the number of objects in the next slab
+  pool_chunk *free_list;
+  slab_block *slabs;
+  unsigned char *cursor;  // the unused part of the newest slab
+  unsigned char *limit;
+  pool_large *large;
+} slab;
+
+// Helper function declaration
+static callocator *create_owning(void *ctx, void (*reset)(void *),
+                                 void (*destroy)(void *));
+// === Default ===
+static void *default_alloc(void *ctx, size_t size);
+static void *default_resize(void *ctx, void *ptr, size_t old_size,
+                            size_t new_size);
+static void default_release(void *ctx, void *ptr, size_t size);
+// === Arena ===
+static void *arena_alloc(void *ctx, size_t size);
+static void *arena_resize(void *ctx, void *ptr, size_t old_size,
+                          size_t new_size);
+static void arena_release(void *ctx, void *ptr, size_t size);
+static void arena_reset(void *ctx);
+static void arena_destroy(void *ctx);
+static inline unsigned char *block_data(arena_block *block);
+// === Pool ===
+static void *pool_alloc(void *ctx, size_t size);
+static void *pool_resize(void *ctx, void *ptr, size_t old_size,
+                         size_t new_size);
+static void pool_release(void *ctx, void *ptr, size_t size);
+static void pool_reset(void *ctx);
+static void pool_destroy(void *ctx);
+static inline size_t pool_class(size_t size);
+static void *large_alloc(pool_large **list, size_t size);
+static void *large_resize(pool_large **list, void *ptr, size_t new_size);
+static void large_release(pool_large **list, void *ptr);
+static void large_release_all(pool_large **list);
+// === Slab ===
+static void *slab_alloc(void *ctx, size_t size);
+static void *slab_resize(void *ctx, void *ptr, size_t old_size,
+                         size_t new_size);
+static void slab_release(void *ctx, void *ptr, size_t size);
+static void slab_reset(void *ctx);
+static void slab_destroy(void *ctx);
+
+callocator *callocator_create(void *(*alloc)(void *ctx, size_t size),
+                              void *(*resize)(void *ctx, void *ptr,
+                                              size_t old_size,
+                                              size_t new_size),
+                              void (*release)(void *ctx, void *ptr,
+                                              size_t size),
+                              void *ctx) {
+  ASSERT_NOT_NULL(alloc, NULL);
+  ASSERT_NOT_NULL(resize, NULL);
+  ASSERT_NOT_NULL(release, NULL);
+
+  callocator *allocator = malloc(sizeof(*allocator));
+  if (!allocator) {
+    ALLOC_ERROR("callocator");
+  }
+
+  allocator->alloc = alloc;
+  allocator->resize = resize;
+  allocator->release = release;
+  allocator->ctx = ctx;
+  allocator->reset = NULL;
+  allocator->destroy = NULL;
+  return allocator;
+}
+
+callocator *callocator_create_arena(size_t block_size) {
+  ASSERT_MSG(block_size, "The block size of an arena cannot be zero!");
+
+  arena *a = malloc(sizeof(*a));
+  if (!a) {
+    ALLOC_ERROR("arena");
+  }
+  a->first = NULL;
+  a->current = NULL;
+  a->last = NULL;
+  a->block_size = ALIGN_UP(block_size);
+
+  callocator *allocator = create_owning(a, arena_reset, arena_destroy);
+  allocator->alloc = arena_alloc;
+  allocator->resize = arena_resize;
+  allocator->release = arena_release;
+  return allocator;
+}
+
+callocator *callocator_create_pool(void) {
+  pool *p = calloc(1, sizeof(*p));
+  if (!p) {
+    ALLOC_ERROR("pool");
+  }
+
+  callocator *allocator = create_owning(p, pool_reset, pool_destroy);
+  allocator->alloc = pool_alloc;
+  allocator->resize = pool_resize;
+  allocator->release = pool_release;
+  return allocator;
+}
+
+callocator *callocator_create_slab(size_t size) {
+  ASSERT_MSG(size, "The object size of a slab cannot be zero!");
+
+  slab *sl = calloc(1, sizeof(*sl));
+  if (!sl) {
+    ALLOC_ERROR("slab");
+  }
+  size_t stride = (size > sizeof(pool_chunk)) ? size : sizeof(pool_chunk);
+  sl->object_size = size;
+  sl->stride = (stride + sizeof(void *) - 1) / sizeof(void *) 
+               * sizeof(void *);
+  sl->batch = SLAB_MIN_OBJECTS;
+
+  callocator *allocator = create_owning(sl, slab_reset, slab_destroy);
+  allocator->alloc = slab_alloc;
+  allocator->resize = slab_resize;
+  allocator->release = slab_release;
+  return allocator;
+}
+
+void callocator_destroy(callocator *alloc) {
+  if (!alloc) return;
+
+  ASSERT_MSG(alloc != callocator_default(),
+             "The default callocator cannot be destroyed!");
+  if (alloc->destroy) {
+    alloc->destroy(alloc->ctx);
+  }
+  free(alloc);
+}
+
+void callocator_reset(callocator *alloc) {
+  ASSERT_NOT_NULL(alloc, NULL);
+  ASSERT_MSG(alloc->reset, "callocator does not support reset!");
+  alloc->reset(alloc->ctx);
+}
+
+bool callocator_resettable(const callocator *alloc) {
+  ASSERT_NOT_NULL(alloc, NULL);
+  return alloc->reset != NULL;
+}
+
+const callocator *callocator_default(void) {
+  static const callocator default_allocator = {
+    .alloc = default_alloc,
+    .resize = default_resize,
+    .release = default_release,
+    .ctx = NULL,
+    .reset = NULL,
+    .destroy = NULL,
+  };
+  return &default_allocator;
+}
+
+void *callocator_alloc(const callocator *alloc, size_t size) {
+  ASSERT_NOT_NULL(alloc, NULL);
+  return alloc->alloc(alloc->ctx, size);
+}
+
+void *callocator_resize(const callocator *alloc, void *ptr,
+                        size_t old_size, size_t new_size) {
+  ASSERT_NOT_NULL(alloc, NULL);
+  ASSERT_NOT_NULL(ptr, NULL);
+  return alloc->resize(alloc->ctx, ptr, old_size, new_size);
+}
+
+void callocator_release(const callocator *alloc, void *ptr, size_t size) {
+  ASSERT_NOT_NULL(alloc, NULL);
+  if (ptr) {
+    alloc->release(alloc->ctx, ptr, size);
+  }
+}
+
+// Helper function implementation
+// Create a callocator that owns ctx and the memory allocated from it
+static callocator *create_owning(void *ctx, void (*reset)(void *),
+                                 void (*destroy)(void *)) {
+  callocator *allocator = malloc(sizeof(*allocator));
+  if (!allocator) {
+    ALLOC_ERROR("callocator");
+  }
+  allocator->ctx = ctx;
+  allocator->reset = reset;
+  allocator->destroy = destroy;
+  return allocator;
+}
+
+// === Default ===
+static void *default_alloc(void *ctx, size_t size) {
+  (void) ctx;
+  return malloc(size);
+}
+
+static void *default_resize(void *ctx, void *ptr, size_t old_size,
+                            size_t new_size) {
+  (void) ctx;
+  (void) old_size;
+  return realloc(ptr, new_size);
+}
+
+static void default_release(void *ctx, void *ptr, size_t size) {
+  (void) ctx;
+  (void) size;
+  free(ptr);
+}
+
+// === Arena ===
+static inline unsigned char *block_data(arena_block *block) {
+  return (unsigned char *) block + ARENA_HEADER;
+}
+
+static void *arena_alloc(void *ctx, size_t size) {
+  arena *a = ctx;
+  if (size > SIZE_MAX - ARENA_HEADER - ALIGNMENT) {
+    return NULL;
+  }
+  size = ALIGN_UP(size ? size : 1);
+
+  // Use the first block from current on that has room, or add a block
+  arena_block *prev = NULL;
+  arena_block *block = a->current;
+  for (; block; prev = block, block = block->next) {
+    if (block->capacity - block->used >= size) break;
+  }
+  if (!block) {
+    size_t capacity = (size > a->block_size) ? size : a->block_size;
+    block = malloc(ARENA_HEADER + capacity);
+    if (!block) {
+      return NULL;
+    }
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    if (prev) {
+      prev->next = block;
+    } else {
+      a->first = block;
+    }
+  }
+
+  a->current = block;
+  a->last = block_data(block) + block->used;
+  block->used += size;
+  return a->last;
+}
+
+static void *arena_resize(void *ctx, void *ptr, size_t old_size,
+                          size_t new_size) {
+  arena *a = ctx;
+
+  // The most recent allocation grows or shrinks in place if it fits
+  if (ptr == a->last && new_size <= SIZE_MAX - ALIGNMENT) {
+    size_t offset = a->last - block_data(a->current);
+    size_t size = ALIGN_UP(new_size ? new_size : 1);
+    if (size <= a->current->capacity - offset) {
+      a->current->used = offset + size;
+      return ptr;
+    }
+  }
+
+  if (new_size <= old_size) {
+    return ptr;
+  }
+  void *new_ptr = arena_alloc(a, new_size);
+  if (new_ptr) {
+    memcpy(new_ptr, ptr, old_size);
+  }
+  return new_ptr;
+}
+
+static void arena_release(void *ctx, void *ptr, size_t size) {
+  arena *a = ctx;
+  (void) size;
+  if (ptr == a->last) {
+    a->current->used = a->last - block_data(a->current);
+    a->last = NULL;
+  }
+}
+
+static void arena_reset(void *ctx) {
+  arena *a = ctx;
+  for (arena_block *block = a->first; block; block = block->next) {
+    block->used = 0;
+  }
+  a->current = a->first;
+  a->last = NULL;
+}
+
+static void arena_destroy(void *ctx) {
+  arena *a = ctx;
+  for (arena_block *block = a->first; block;) {
+    arena_block *next = block->next;
+    free(block);
+    block = next;
+  }
+  free(a);
+}
+
+// === Pool ===
+// Produce the size class of a small allocation of size bytes
+static inline size_t pool_class(size_t size) {
+  return (size ? size - 1 : 0) / ALIGNMENT;
+}
+
+static void *pool_alloc(void *ctx, size_t size) {
+  pool *p = ctx;
+
+  if (size > POOL_SMALL_MAX) {
+    return large_alloc(&p->large, size);
+  }
+
+  size_t class = pool_class(size);
+  pool_chunk *chunk = p->free_lists[class];
+  if (chunk) {
+    p->free_lists[class] = chunk->next;
+    return chunk;
+  }
+
+  size_t chunk_size = (class + 1) * ALIGNMENT;
+  if (!p->cursor || (size_t) (p->limit - p->cursor) < chunk_size) {
+    pool_slab *slab = malloc(POOL_SLAB_SIZE);
+    if (!slab) {
+      return NULL;
+    }
+    slab->next = p->slabs;
+    p->slabs = slab;
+    p->cursor = (unsigned char *) slab + POOL_SLAB_HEADER;
+    p->limit = (unsigned char *) slab + POOL_SLAB_SIZE;
+  }
+  void *ptr = p->cursor;
+  p->cursor += chunk_size;
+  return ptr;
+}
+
+static void *pool_resize(void *ctx, void *ptr, size_t old_size,
+                         size_t new_size) {
+  pool *p = ctx;
+
+  if (old_size <= POOL_SMALL_MAX && new_size <= POOL_SMALL_MAX &&
+      pool_class(old_size) == pool_class(new_size)) {
+    return ptr;
+  }
+
+  if (old_size > POOL_SMALL_MAX && new_size > POOL_SMALL_MAX) {
+    return large_resize(&p->large, ptr, new_size);
+  }
+
+  void *new_ptr = pool_alloc(p, new_size);
+  if (new_ptr) {
+    memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+    pool_release(p, ptr, old_size);
+  }
+  return new_ptr;
+}
+
+static void pool_release(void *ctx, void *ptr, size_t size) {
+  pool *p = ctx;
+
+  if (size > POOL_SMALL_MAX) {
+    large_release(&p->large, ptr);
+    return;
+  }
+
+  size_t class = pool_class(size);
+  pool_chunk *chunk = ptr;
+  chunk->next = p->free_lists[class];
+  p->free_lists[class] = chunk;
+}
+
+static void pool_reset(void *ctx) {
+  pool *p = ctx;
+  for (pool_slab *slab = p->slabs; slab;) {
+    pool_slab *next = slab->next;
+    free(slab);
+    slab = next;
+  }
+  large_release_all(&p->large);
+  memset(p, 0, sizeof(*p));
+}
+
+static void pool_destroy(void *ctx) {
+  pool_reset(ctx);
+  free(ctx);
+}
+
+// Allocate size bytes with malloc and link them into list
+static void *large_alloc(pool_large **list, size_t size) {
+  if (size > SIZE_MAX - POOL_LARGE_HEADER) {
+    return NULL;
+  }
+  pool_large *large = malloc(POOL_LARGE_HEADER + size);
+  if (!large) {
+    return NULL;
+  }
+  large->prev = NULL;
+  large->next = *list;
+  if (*list) {
+    (*list)->prev = large;
+  }
+  *list = large;
+  return (unsigned char *) large + POOL_LARGE_HEADER;
+}
+
+// Resize a large allocation in list to new_size bytes
+static void *large_resize(pool_large **list, void *ptr, size_t new_size) {
+  if (new_size > SIZE_MAX - POOL_LARGE_HEADER) {
+    return NULL;
+  }
+  pool_large *old_large = (pool_large *)
+    ((unsigned char *) ptr - POOL_LARGE_HEADER);
+  pool_large *large = realloc(old_large, POOL_LARGE_HEADER + new_size);
+  if (!large) {
+    return NULL;
+  }
+  if (large->prev) {
+    large->prev->next = large;
+  } else {
+    *list = large;
+  }
+  if (large->next) {
+    large->next->prev = large;
+  }
+  return (unsigned char *) large + POOL_LARGE_HEADER;
+}
+
+// Unlink a large allocation from list and free it
+static void large_release(pool_large **list, void *ptr) {
+  pool_large *large = (pool_large *)
+    ((unsigned char *) ptr - POOL_LARGE_HEADER);
+  if (large->prev) {
+    large->prev->next = large->next;
+  } else {
+    *list = large->next;
+  }
+  if (large->next) {
+    large->next->prev = large->prev;
+  }
+  free(large);
+}
+
+// Free every large allocation in list
+static void large_release_all(pool_large **list) {
+  for (pool_large *large = *list; large;) {
+    pool_large *next = large->next;
+    free(large);
+    large = next;
+  }
+  *list = NULL;
+}
+
+// === Slab ===
+static void *slab_alloc(void *ctx, size_t size) {
+  slab *sl = ctx;
+
+  if (size > sl->object_size) {
+    return large_alloc(&sl->large, size);
+  }
+
+  pool_chunk *chunk = sl->free_list;
+  if (chunk) {
+    sl->free_list = chunk->next;
+    return chunk;
+  }
+
+  // Refill with a new slab, larger than the last up to SLAB_MAX_BYTES
+  if (!sl->cursor || (size_t) (sl->limit - sl->cursor) < sl->stride) {
+    size_t bytes = SLAB_HEADER + sl->batch * sl->stride;
+    slab_block *block = malloc(bytes);
+    if (!block) {
+      return NULL;
+    }
+    block->next = sl->slabs;
+    sl->slabs = block;
+    sl->cursor = (unsigned char *) block + SLAB_HEADER;
+    sl->limit = (unsigned char *) block + bytes;
+    if (SLAB_HEADER + 2 * sl->batch * sl->stride <= SLAB_MAX_BYTES) {
+      sl->batch *= 2;
+    }
+  }
+  void *ptr = sl->cursor;
+  sl->cursor += sl->stride;
+  return ptr;
+}
+
+static void *slab_resize(void *ctx, void *ptr, size_t old_size,
+                         size_t new_size) {
+  slab *sl = ctx;
+
+  if (old_size <= sl->object_size && new_size <= sl->object_size) {
+    return ptr;
+  }
+  if (old_size > sl->object_size && new_size > sl->object_size) {
+    return large_resize(&sl->large, ptr, new_size);
+  }
+
+  void *new_ptr = slab_alloc(sl, new_size);
+  if (new_ptr) {
+    memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+    slab_release(sl, ptr, old_size);
+  }
+  return new_ptr;
+}
+
+static void slab_release(void *ctx, void *ptr, size_t size) {
+  slab *sl = ctx;
+
+  if (size > sl->object_size) {
+    large_release(&sl->large, ptr);
+    return;
+  }
+  pool_chunk *chunk = ptr;
+  chunk->next = sl->free_list;
+  sl->free_list = chunk;
+}
+
+static void slab_reset(void *ctx) {
+  slab *sl = ctx;
+  for (slab_block *block = sl->slabs; block;) {
+    slab_block *next = block->next;
+    free(block);
+    block = next;
+  }
+  large_release_all(&sl->large);
+  sl->free_list = NULL;
+  sl->slabs = NULL;
+  sl->cursor = NULL;
+  sl->limit = NULL;
+  sl->batch = SLAB_MIN_OBJECTS;
+}
+
+static void slab_destroy(void *ctx) {
+  slab_reset(ctx);
+  free(ctx);
+}
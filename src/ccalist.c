@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "ccalist.h"
+#include "cerror.h"
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "ccalist requires the __atomic builtins of GCC or Clang"
+#endif
+
+// Segment k holds FIRST_SEGMENT << k slots, so that FIRST_SEGMENT + i has
+//   its highest bit at FIRST_SEGMENT_SHIFT + k for every index i in it
+#define FIRST_SEGMENT_SHIFT 6
+#define FIRST_SEGMENT ((size_t) 1 << FIRST_SEGMENT_SHIFT)
+
+// Enough segments for any index below SIZE_MAX - FIRST_SEGMENT
+#define SEGMENT_COUNT (sizeof(size_t) * CHAR_BIT - FIRST_SEGMENT_SHIFT)
+
+// Keeps the counters written by every append off the cache lines that
+//   readers load
+#define CACHE_LINE 64
+
+// A segment of len slots, followed by a published flag per slot
+typedef unsigned char segment;
+
+struct ccalist {
+  const ctype *type;
+  size_t width;   // the size of a slot in bytes
+  bool boxed;     // true if slots hold pointers to the items
+  segment *segments[SEGMENT_COUNT];  // set once, when first needed
+  unsigned char pad1[CACHE_LINE];
+  size_t reserved;   // the number of indices handed out to appends
+  unsigned char pad2[CACHE_LINE];
+  size_t published;  // the number of items readers can see
+  unsigned char pad3[CACHE_LINE];
+};
+
+// Helper function declaration
+static inline size_t segment_of(size_t index, size_t *offset);
+static inline size_t segment_len(size_t k);
+static segment *load_segment(const ccalist *cl, size_t k);
+static segment *ensure_segment(ccalist *cl, size_t k);
+static inline const void *slot_item(const ccalist *cl, const void *slot);
+static void publish(ccalist *cl);
+
+ccalist *ccalist_create(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(!ctype_has_canonical(type),
+             "Interned ctypes cannot be shared between threads!");
+
+  ccalist *cl = malloc(sizeof(*cl));
+  if (!cl) {
+    ALLOC_ERROR("ccalist");
+  }
+  cl->type = type;
+  cl->boxed = !ctype_is_pod(type);
+  cl->width = cl->boxed ? sizeof(void *) : data_size(type);
+  for (size_t k = 0; k < SEGMENT_COUNT; ++k) {
+    cl->segments[k] = NULL;
+  }
+  cl->reserved = 0;
+  cl->published = 0;
+  return cl;
+}
+
+void ccalist_destroy(ccalist *cl) {
+  if (!cl) return;
+
+  size_t n = cl->reserved;
+  for (size_t k = 0; k < SEGMENT_COUNT && cl->segments[k]; ++k) {
+    if (cl->boxed) {
+      size_t first = segment_len(k) - FIRST_SEGMENT;
+      size_t len = segment_len(k);
+      for (size_t i = 0; i < len && first + i < n; ++i) {
+        void *item;
+        memcpy(&item, cl->segments[k] + i * cl->width, sizeof(item));
+        data_destroy(item, cl->type);
+      }
+    }
+    free(cl->segments[k]);
+  }
+  free(cl);
+}
+
+const ctype *ccalist_type(const ccalist *cl) {
+  ASSERT_NOT_NULL(cl, NULL);
+  return cl->type;
+}
+
+size_t ccalist_append(ccalist *cl, const void *item) {
+  ASSERT_NOT_NULL(cl, NULL);
+  ASSERT_NOT_NULL(item, "The item to be appended");
+
+  size_t index = __atomic_fetch_add(&cl->reserved, 1, __ATOMIC_RELAXED);
+  ASSERT_MSG(index < SIZE_MAX - FIRST_SEGMENT, "ccalist is full!");
+  size_t offset;
+  size_t k = segment_of(index, &offset);
+  segment *seg = ensure_segment(cl, k);
+
+  unsigned char *slot = seg + offset * cl->width;
+  if (cl->boxed) {
+    void *copy = data_dup(item, cl->type);
+    if (!copy) {
+      ALLOC_ERROR("ccalist item");
+    }
+    memcpy(slot, &copy, sizeof(copy));
+  } else {
+    memcpy(slot, item, cl->width);
+  }
+
+  unsigned char *flags = seg + segment_len(k) * cl->width;
+  __atomic_store_n(&flags[offset], 1, __ATOMIC_SEQ_CST);
+  publish(cl);
+  return index;
+}
+
+size_t ccalist_size(const ccalist *cl) {
+  ASSERT_NOT_NULL(cl, NULL);
+  return __atomic_load_n(&cl->published, __ATOMIC_ACQUIRE);
+}
+
+const void *ccalist_get(const ccalist *cl, size_t index) {
+  ASSERT_NOT_NULL(cl, NULL);
+  ASSERT_MSG(index < ccalist_size(cl), "Index out of bounds!");
+
+  size_t offset;
+  size_t k = segment_of(index, &offset);
+  return slot_item(cl, load_segment(cl, k) + offset * cl->width);
+}
+
+size_t ccalist_index(const ccalist *cl, const void *item) {
+  ASSERT_NOT_NULL(cl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t n = ccalist_size(cl);
+  for (size_t k = 0, first = 0; first < n; first += segment_len(k++)) {
+    const segment *seg = load_segment(cl, k);
+    size_t len = segment_len(k);
+    for (size_t i = 0; i < len && first + i < n; ++i) {
+      if (data_cmp(slot_item(cl, seg + i * cl->width), item,
+                   cl->type) == 0) {
+        return first + i;
+      }
+    }
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+bool ccalist_contains(const ccalist *cl, const void *item) {
+  return ccalist_index(cl, item) != CALIST_INDEX_NOT_FOUND;
+}
+
+size_t ccalist_bsearch(const ccalist *cl, const void *item) {
+  ASSERT_NOT_NULL(cl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t lo = 0;
+  size_t hi = ccalist_size(cl);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    int cmp = data_cmp(ccalist_get(cl, mid), item, cl->type);
+    if (cmp == 0) {
+      return mid;
+    } else if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+calist *ccalist_snapshot(const ccalist *cl) {
+  ASSERT_NOT_NULL(cl, NULL);
+
+  size_t n = ccalist_size(cl);
+  calist *al = calist_create_size(cl->type, n ? n : 1);
+  for (size_t k = 0, first = 0; first < n; first += segment_len(k++)) {
+    const segment *seg = load_segment(cl, k);
+    size_t len = segment_len(k);
+    if (len > n - first) {
+      len = n - first;
+    }
+    if (!cl->boxed) {
+      calist_append_array(al, seg, len);
+      continue;
+    }
+    for (size_t i = 0; i < len; ++i) {
+      calist_append(al, slot_item(cl, seg + i * cl->width));
+    }
+  }
+  return al;
+}
+
+// Helper function implementation
+// Produce the segment holding index, and store the position of index in it
+//   at offset
+static inline size_t segment_of(size_t index, size_t *offset) {
+  unsigned long long j = (unsigned long long) index + FIRST_SEGMENT;
+  size_t high = sizeof(j) * CHAR_BIT - 1 - (size_t) __builtin_clzll(j);
+  size_t k = high - FIRST_SEGMENT_SHIFT;
+  *offset = (size_t) (j - ((unsigned long long) 1 << high));
+  return k;
+}
+
+static inline size_t segment_len(size_t k) {
+  return FIRST_SEGMENT << k;
+}
+
+static segment *load_segment(const ccalist *cl, size_t k) {
+  return __atomic_load_n(&cl->segments[k], __ATOMIC_ACQUIRE);
+}
+
+// Produce segment k, allocating it if no other append has; when two
+//   appends race, the loser frees its copy
+static segment *ensure_segment(ccalist *cl, size_t k) {
+  segment *seg = load_segment(cl, k);
+  if (seg) {
+    return seg;
+  }
+
+  size_t len = segment_len(k);
+  if (len > (SIZE_MAX - len) / cl->width) {
+    ALLOC_ERROR("ccalist segment");
+  }
+  segment *fresh = calloc(len * cl->width + len, 1);
+  if (!fresh) {
+    ALLOC_ERROR("ccalist segment");
+  }
+  segment *expected = NULL;
+  if (__atomic_compare_exchange_n(&cl->segments[k], &expected, fresh, false,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    return fresh;
+  }
+  free(fresh);
+  return expected;
+}
+
+static inline const void *slot_item(const ccalist *cl, const void *slot) {
+  if (!cl->boxed) {
+    return slot;
+  }
+  const void *item;
+  memcpy(&item, slot, sizeof(item));
+  return item;
+}
+
+// Advance the published count past every consecutive published item. The
+//   append that publishes the last item of a run always advances past it:
+//   flags and the count are sequentially consistent, so either this call
+//   sees that item's flag or that append sees the advanced count.
+static void publish(ccalist *cl) {
+  size_t n = __atomic_load_n(&cl->published, __ATOMIC_SEQ_CST);
+  for (;;) {
+    size_t offset;
+    size_t k = segment_of(n, &offset);
+    segment *seg = load_segment(cl, k);
+    if (!seg) return;
+    unsigned char *flags = seg + segment_len(k) * cl->width;
+    if (!__atomic_load_n(&flags[offset], __ATOMIC_SEQ_CST)) return;
+    // On failure n is reloaded, as another append has advanced past it
+    if (__atomic_compare_exchange_n(&cl->published, &n, n + 1, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+      ++n;
+    }
+  }
+}
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+#include "cformat.h"
+
+// Pairs of decimal digits, so that integers are converted two digits at a
+//   time
+static const char DIGIT_PAIRS[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// "%g" prints 6 significant digits, in fixed notation for decimal
+//   exponents from -4 to 5
+#define GENERAL_DIGITS 6
+#define GENERAL_MIN_EXP (-4)
+#define GENERAL_MAX_EXP 5
+
+static const uint64_t POW10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+};
+
+// The smallest values with decimal exponents -4 to 6 [approximately]
+static const double EXP_BOUNDS[] = {
+  1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+};
+
+// Helper function declaration
+static size_t general_fallback(double value, char *buf);
+static bool round_scaled(uint64_t m, unsigned k, unsigned p, uint64_t *q);
+
+size_t cformat_unsigned(uintmax_t value, char *buf) {
+  char text[CFORMAT_MAX];
+  char *end = text + sizeof(text);
+  char *p = end;
+  while (value >= 100) {
+    size_t pair = (size_t) (value % 100) * 2;
+    value /= 100;
+    p -= 2;
+    memcpy(p, DIGIT_PAIRS + pair, 2);
+  }
+  if (value >= 10) {
+    p -= 2;
+    memcpy(p, DIGIT_PAIRS + value * 2, 2);
+  } else {
+    *--p = (char) ('0' + value);
+  }
+  size_t len = (size_t) (end - p);
+  memcpy(buf, p, len);
+  return len;
+}
+
+size_t cformat_signed(intmax_t value, char *buf) {
+  if (value >= 0) {
+    return cformat_unsigned((uintmax_t) value, buf);
+  }
+  // The magnitude is taken in unsigned arithmetic, which also covers
+  //   INTMAX_MIN
+  buf[0] = '-';
+  return 1 + cformat_unsigned(-(uintmax_t) value, buf + 1);
+}
+
+size_t cformat_general(double value, char *buf) {
+#if DBL_MANT_DIG != 53 || FLT_RADIX != 2
+  return general_fallback(value, buf);
+#else
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bool negative = bits >> 63;
+  unsigned biased = (unsigned) (bits >> 52) & 0x7FF;
+  uint64_t fraction = bits & ((1ULL << 52) - 1);
+
+  size_t len = 0;
+  if (negative) {
+    buf[len++] = '-';
+  }
+  if (biased == 0 && fraction == 0) {
+    buf[len++] = '0';
+    return len;
+  }
+  // value is m * 2^-k; subnormals, infinities, NaNs and values of at
+  //   least 2^52 are never printed in fixed notation
+  if (biased == 0 || biased == 0x7FF || biased >= 1075) {
+    return general_fallback(value, buf);
+  }
+  uint64_t m = fraction | (1ULL << 52);
+  unsigned k = 1075 - biased;
+
+  // Find the decimal exponent of the value once rounded to 6 digits,
+  //   starting from an estimate that is off by at most one
+  double magnitude = negative ? -value : value;
+  int exp = GENERAL_MIN_EXP - 1;
+  while (exp <= GENERAL_MAX_EXP && 
+         magnitude >= EXP_BOUNDS[exp - GENERAL_MIN_EXP + 1]) {
+    ++exp;
+  }
+  uint64_t q = 0;
+  for (;;) {
+    if (exp < GENERAL_MIN_EXP - 1 || exp > GENERAL_MAX_EXP) {
+      return general_fallback(value, buf);
+    }
+    if (!round_scaled(m, k, (unsigned) (GENERAL_DIGITS - 1 - exp), &q)) {
+      return general_fallback(value, buf);
+    }
+    if (q >= POW10[GENERAL_DIGITS]) {
+      ++exp;
+    } else if (q < POW10[GENERAL_DIGITS - 1]) {
+      --exp;
+    } else {
+      break;
+    }
+  }
+  if (exp < GENERAL_MIN_EXP) {
+    return general_fallback(value, buf);
+  }
+
+  // The 6 digits of q, with trailing zeros removed
+  char digits[GENERAL_DIGITS];
+  for (int i = GENERAL_DIGITS - 1; i >= 0; --i) {
+    digits[i] = (char) ('0' + q % 10);
+    q /= 10;
+  }
+  int n = GENERAL_DIGITS;
+  while (n > 1 && digits[n - 1] == '0') {
+    --n;
+  }
+
+  if (exp >= 0) {
+    int whole = exp + 1;
+    memcpy(buf + len, digits, (size_t) whole);
+    len += (size_t) whole;
+    if (n > whole) {
+      buf[len++] = '.';
+      memcpy(buf + len, digits + whole, (size_t) (n - whole));
+      len += (size_t) (n - whole);
+    }
+  } else {
+    buf[len++] = '0';
+    buf[len++] = '.';
+    for (int i = -1; i > exp; --i) {
+      buf[len++] = '0';
+    }
+    memcpy(buf + len, digits, (size_t) n);
+    len += (size_t) n;
+  }
+  return len;
+#endif
+}
+
+// Helper function implementation
+static size_t general_fallback(double value, char *buf) {
+  char text[CFORMAT_MAX];
+  int len = snprintf(text, sizeof(text), "%g", value);
+  if (len < 0) {
+    return 0;
+  }
+  memcpy(buf, text, (size_t) len);
+  return (size_t) len;
+}
+
+// Store m * 10^p / 2^k rounded to the nearest integer, ties to even, at q
+//   [the value is exact, so this matches printf], producing false if the
+//   computation does not fit
+static bool round_scaled(uint64_t m, unsigned k, unsigned p, uint64_t *q) {
+  if (p >= sizeof(POW10) / sizeof(POW10[0]) || k == 0 || k > 100) {
+    return false;
+  }
+  // The 128-bit product m * 10^p as hi:lo [m < 2^53, 10^p < 2^37]
+  uint64_t pow = POW10[p];
+  uint64_t m_hi = m >> 26;
+  uint64_t m_lo = m & ((1ULL << 26) - 1);
+  uint64_t a = m_hi * pow;
+  uint64_t b = m_lo * pow;
+  uint64_t lo = (a << 26) + b;
+  uint64_t hi = (a >> 38) + (lo < b);
+
+  // Split the product at bit k into the quotient and the remainder, and
+  //   compare the remainder with half of 2^k
+  uint64_t rem_hi, rem_lo, half_hi, half_lo;
+  if (k < 64) {
+    if (hi >> k) {
+      return false;
+    }
+    *q = (hi << (64 - k)) | (lo >> k);
+    rem_hi = 0;
+    rem_lo = lo & ((1ULL << k) - 1);
+    half_hi = 0;
+    half_lo = 1ULL << (k - 1);
+  } else {
+    unsigned shift = k - 64;
+    *q = hi >> shift;
+    rem_hi = shift ? hi & ((1ULL << shift) - 1) : 0;
+    rem_lo = lo;
+    half_hi = shift ? 1ULL << (shift - 1) : 0;
+    half_lo = shift ? 0 : 1ULL << 63;
+  }
+
+  bool above = (rem_hi > half_hi) || (rem_hi == half_hi && rem_lo > half_lo);
+  bool tie = (rem_hi == half_hi && rem_lo == half_lo);
+  if (above || (tie && (*q & 1))) {
+    ++*q;
+  }
+  return true;
+}
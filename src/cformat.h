@@ -0,0 +1,33 @@
+// The cformat module provides fast conversions of numbers to text for the
+//   format methods of the built-in ctypes. Each conversion produces
+//   exactly the text of the printf conversion it names.
+// note: cformat is internal to the library and is not part of the public API
+
+#ifndef CFORMAT_H
+#define CFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The size of a buffer that holds the text of any conversion [no
+//   conversion writes a null terminator]
+#define CFORMAT_MAX 32
+
+// cformat_unsigned(value, buf) writes value to buf like "%ju" and
+//   produces the number of characters written.
+// requires: buf has room for CFORMAT_MAX characters
+size_t cformat_unsigned(uintmax_t value, char *buf);
+
+// cformat_signed(value, buf) writes value to buf like "%jd" and produces
+//   the number of characters written.
+// requires: buf has room for CFORMAT_MAX characters
+size_t cformat_signed(intmax_t value, char *buf);
+
+// cformat_general(value, buf) writes value to buf like "%g" and produces
+//   the number of characters written.
+// requires: buf has room for CFORMAT_MAX characters
+// note: values printed in fixed notation are converted without printf;
+//       others, and infinities and NaNs, fall back to snprintf
+size_t cformat_general(double value, char *buf);
+
+#endif
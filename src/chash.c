@@ -0,0 +1,285 @@
+#include <stdlib.h>
+#include <string.h>
+#include "chash.h"
+#include "csimd.h"
+#include "cerror.h"
+
+#if defined(CSIMD_X86)
+#include <emmintrin.h>
+#elif defined(CSIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// The number of control bytes probed at once
+#define GROUP_WIDTH 16
+
+// Control bytes of free slots have the high bit set; a full slot holds
+//   seven bits of the hash of its key
+#define CTRL_EMPTY ((uint8_t) 0x80)
+#define CTRL_DELETED ((uint8_t) 0xFE)
+#define CTRL_FREE(c) ((c) & 0x80)
+
+// A group mask has LANE_BITS bits per control byte of a group, of which
+//   only the lowest may be set
+#if defined(CSIMD_NEON)
+#define LANE_BITS 4
+#else
+#define LANE_BITS 1
+#endif
+typedef uint64_t group_mask;
+
+// Helper function declaration
+static inline size_t mix_hash(size_t hash);
+static inline group_mask match_byte(const uint8_t *group, uint8_t byte);
+static inline group_mask match_free(const uint8_t *group);
+static inline size_t lowest_lane(group_mask mask);
+static inline size_t growth_of(size_t capacity);
+static size_t capacity_for(size_t n);
+static inline void set_ctrl(chash *t, size_t i, uint8_t c);
+static size_t find_free(const chash *t, size_t hash);
+static void resize(chash *t, size_t capacity, chash_hash rehash,
+                   const void *ctx);
+
+void chash_init(chash *t, size_t width) {
+  t->ctrl = NULL;
+  t->slots = NULL;
+  t->width = width;
+  t->capacity = 0;
+  t->size = 0;
+  t->growth_left = 0;
+}
+
+void chash_free(chash *t) {
+  free(t->ctrl);
+  free(t->slots);
+}
+
+void chash_clear(chash *t) {
+  if (t->capacity > 0) {
+    memset(t->ctrl, CTRL_EMPTY, t->capacity + GROUP_WIDTH);
+  }
+  t->size = 0;
+  t->growth_left = growth_of(t->capacity);
+}
+
+size_t chash_find(const chash *t, const void *key, size_t hash, chash_eq eq,
+                  const void *ctx) {
+  if (t->capacity == 0) {
+    return CHASH_NOT_FOUND;
+  }
+
+  size_t h = mix_hash(hash);
+  uint8_t h2 = (uint8_t) (h & 0x7F);
+  size_t mask = t->capacity - 1;
+  size_t pos = (h >> 7) & mask;
+
+  // Groups are visited at triangular offsets, which reach every group of
+  //   a power-of-2 table; an empty slot ends the probe sequence of a key
+  for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+    const uint8_t *group = t->ctrl + pos;
+    for (group_mask m = match_byte(group, h2); m; m &= m - 1) {
+      size_t i = (pos + lowest_lane(m)) & mask;
+      if (eq(chash_slot(t, i), key, ctx)) {
+        return i;
+      }
+    }
+    if (match_byte(group, CTRL_EMPTY)) {
+      return CHASH_NOT_FOUND;
+    }
+    pos = (pos + step) & mask;
+  }
+}
+
+size_t chash_insert(chash *t, size_t hash, chash_hash rehash,
+                    const void *ctx) {
+  if (t->capacity == 0) {
+    resize(t, capacity_for(1), rehash, ctx);
+  }
+
+  size_t i = find_free(t, hash);
+  if (t->growth_left == 0 && t->ctrl[i] == CTRL_EMPTY) {
+    // Deleted slots are reclaimed in place when they make up at least
+    //   half of the table's load; otherwise the table doubles
+    size_t capacity = (t->size * 2 <= growth_of(t->capacity))
+                      ? t->capacity : t->capacity * 2;
+    if (capacity < t->capacity) {
+      ALLOC_ERROR("hash table");
+    }
+    resize(t, capacity, rehash, ctx);
+    i = find_free(t, hash);
+  }
+
+  t->growth_left -= (t->ctrl[i] == CTRL_EMPTY);
+  set_ctrl(t, i, (uint8_t) (mix_hash(hash) & 0x7F));
+  ++t->size;
+  return i;
+}
+
+void chash_erase(chash *t, size_t i) {
+  set_ctrl(t, i, CTRL_DELETED);
+  --t->size;
+}
+
+void chash_reserve(chash *t, size_t n, chash_hash rehash, const void *ctx) {
+  if (n > t->size + t->growth_left) {
+    // Tombstones use up growth_left, so n may already fit in the current
+    //   capacity; rehashing at that capacity clears them without shrinking
+    size_t capacity = capacity_for(n);
+    resize(t, capacity > t->capacity ? capacity : t->capacity, rehash, ctx);
+  }
+}
+
+void chash_rehash(chash *t, size_t n, chash_hash rehash, const void *ctx) {
+  if (n < t->size) {
+    n = t->size;
+  }
+  if (n == 0) {
+    chash_free(t);
+    chash_init(t, t->width);
+    return;
+  }
+  resize(t, capacity_for(n), rehash, ctx);
+}
+
+size_t chash_next(const chash *t, size_t i) {
+  for (; i < t->capacity; ++i) {
+    if (!CTRL_FREE(t->ctrl[i])) break;
+  }
+  return i;
+}
+
+// Helper function implementation
+// Spread the bits of hash, as built-in hash methods may leave the high
+//   bits empty
+static inline size_t mix_hash(size_t hash) {
+  hash ^= hash >> (sizeof(size_t) * 4);
+  hash *= (size_t) 0x9E3779B97F4A7C15ULL;
+  return hash ^ (hash >> (sizeof(size_t) * 4));
+}
+
+#if defined(CSIMD_X86)
+
+static inline group_mask match_byte(const uint8_t *group, uint8_t byte) {
+  __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+  __m128i eq = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) byte));
+  return (group_mask) (unsigned) _mm_movemask_epi8(eq);
+}
+
+static inline group_mask match_free(const uint8_t *group) {
+  __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+  return (group_mask) (unsigned) _mm_movemask_epi8(ctrl);
+}
+
+#elif defined(CSIMD_NEON)
+
+// Narrow each byte of a comparison to 4 bits, keeping one bit per lane
+static inline group_mask neon_mask(uint8x16_t eq) {
+  uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrow), 0)
+         & 0x8888888888888888ULL;
+}
+
+static inline group_mask match_byte(const uint8_t *group, uint8_t byte) {
+  return neon_mask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(byte)));
+}
+
+static inline group_mask match_free(const uint8_t *group) {
+  return neon_mask(vcltzq_s8(vreinterpretq_s8_u8(vld1q_u8(group))));
+}
+
+#else
+
+static inline group_mask match_byte(const uint8_t *group, uint8_t byte) {
+  group_mask mask = 0;
+  for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+    mask |= (group_mask) (group[i] == byte) << i;
+  }
+  return mask;
+}
+
+static inline group_mask match_free(const uint8_t *group) {
+  group_mask mask = 0;
+  for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+    mask |= (group_mask) (CTRL_FREE(group[i]) != 0) << i;
+  }
+  return mask;
+}
+
+#endif
+
+static inline size_t lowest_lane(group_mask mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (size_t) __builtin_ctzll(mask) / LANE_BITS;
+#else
+  size_t bit = 0;
+  for (; !(mask & 1); mask >>= 1) {
+    ++bit;
+  }
+  return bit / LANE_BITS;
+#endif
+}
+
+// The most keys a table of capacity may hold: a load factor of 7/8
+static inline size_t growth_of(size_t capacity) {
+  return capacity - capacity / 8;
+}
+
+// Produce the smallest capacity holding n keys
+static size_t capacity_for(size_t n) {
+  size_t capacity = GROUP_WIDTH;
+  while (growth_of(capacity) < n) {
+    if (capacity > SIZE_MAX / 2) {
+      ALLOC_ERROR("hash table");
+    }
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+// Set the control byte of slot i, and its copy after the last slot
+static inline void set_ctrl(chash *t, size_t i, uint8_t c) {
+  t->ctrl[i] = c;
+  if (i < GROUP_WIDTH) {
+    t->ctrl[t->capacity + i] = c;
+  }
+}
+
+// Produce the first empty or deleted slot in the probe sequence of hash
+static size_t find_free(const chash *t, size_t hash) {
+  size_t mask = t->capacity - 1;
+  size_t pos = (mix_hash(hash) >> 7) & mask;
+  for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+    group_mask m = match_free(t->ctrl + pos);
+    if (m) {
+      return (pos + lowest_lane(m)) & mask;
+    }
+    pos = (pos + step) & mask;
+  }
+}
+
+// Move the full slots of t into new arrays of capacity slots
+static void resize(chash *t, size_t capacity, chash_hash rehash,
+                   const void *ctx) {
+  if (capacity > (SIZE_MAX - GROUP_WIDTH) / t->width) {
+    ALLOC_ERROR("hash table");
+  }
+  chash old = *t;
+  t->ctrl = malloc(capacity + GROUP_WIDTH);
+  t->slots = malloc(capacity * t->width);
+  if (!t->ctrl || !t->slots) {
+    ALLOC_ERROR("hash table");
+  }
+  memset(t->ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+  t->capacity = capacity;
+
+  for (size_t i = chash_next(&old, 0); i < old.capacity;
+       i = chash_next(&old, i + 1)) {
+    const void *slot = chash_slot(&old, i);
+    size_t hash = rehash(slot, ctx);
+    size_t j = find_free(t, hash);
+    set_ctrl(t, j, (uint8_t) (mix_hash(hash) & 0x7F));
+    memcpy(chash_slot(t, j), slot, t->width);
+  }
+  t->growth_left = growth_of(capacity) - t->size;
+  chash_free(&old);
+}
@@ -0,0 +1,120 @@
+// The chash module provides the open-addressing table shared by chashset
+//   and chashmap. Slots of a fixed width are stored in one array, beside an
+//   array of control bytes recording for each slot whether it is empty,
+//   deleted, or full, and then seven bits of the hash of its key. Lookups
+//   probe groups of 16 control bytes at once [with SSE2 or NEON where
+//   csimd is available] and compare keys only in slots whose control byte
+//   matches, in the manner of SwissTable.
+//
+// The table stores raw bytes and knows nothing of ctypes: callers fill and
+//   release slots, and pass the hash and equality functions of their keys.
+// note: chash is internal to the library and is not part of the public API
+
+#ifndef CHASH_H
+#define CHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// The index produced for a missing key (SIZE_MAX)
+#define CHASH_NOT_FOUND SIZE_MAX
+
+// chash_hash produces the hash of the key in slot, where ctx is the
+//   context passed with it.
+typedef size_t (*chash_hash)(const void *slot, const void *ctx);
+
+// chash_eq produces true if the key in slot equals key, where ctx is the
+//   context passed with it.
+typedef bool (*chash_eq)(const void *slot, const void *key, const void *ctx);
+
+// A chash table; the fields are read by the owning module only through
+//   the functions below, apart from capacity and size.
+typedef struct {
+  uint8_t *ctrl;          // capacity control bytes, then a copy of the first
+                          //   group so that groups may wrap around
+  unsigned char *slots;
+  size_t width;           // the size of a slot in bytes
+  size_t capacity;        // 0 or a power of 2 of at least one group
+  size_t size;            // the number of full slots
+  size_t growth_left;     // empty slots that may be filled before a rehash
+} chash;
+
+// chash_init(t, width) makes t an empty table of slots of width bytes,
+//   without allocating memory.
+// requires: t is not NULL
+//           width > 0
+// effects: modifies t
+void chash_init(chash *t, size_t width);
+
+// chash_free(t) frees the arrays of t.
+// requires: t is not NULL
+//           the slots of t hold nothing that must be released
+// effects: frees heap memory [t becomes invalid]
+void chash_free(chash *t);
+
+// chash_clear(t) marks every slot of t empty, keeping its capacity.
+// requires: t is not NULL
+//           the slots of t hold nothing that must be released
+// effects: modifies t
+void chash_clear(chash *t);
+
+// chash_slot(t, i) produces the address of slot i of t.
+// requires: t is not NULL
+//           i < t->capacity
+static inline void *chash_slot(const chash *t, size_t i) {
+  return t->slots + i * t->width;
+}
+
+// chash_owns(t, p) produces true if p points into the slots of t, so that
+//   it is invalidated when t grows.
+// requires: t is not NULL
+static inline bool chash_owns(const chash *t, const void *p) {
+  uintptr_t at = (uintptr_t) p;
+  uintptr_t start = (uintptr_t) t->slots;
+  return t->slots && at >= start && at - start < t->capacity * t->width;
+}
+
+// chash_find(t, key, hash, eq, ctx) produces the index of the full slot of
+//   t whose key equals key, or CHASH_NOT_FOUND if there is none.
+// requires: t, key and eq are not NULL
+//           hash is the hash of key
+size_t chash_find(const chash *t, const void *key, size_t hash, chash_eq eq,
+                  const void *ctx);
+
+// chash_insert(t, hash, rehash, ctx) marks a free slot full for a new key
+//   with hash, and produces its index for the caller to fill; the table
+//   grows first if it is full, rehashing the full slots with rehash.
+// requires: t and rehash are not NULL
+//           the key is not in t [see chash_find]
+// effects: modifies t, may allocate and free heap memory [slot addresses
+//          of t become invalid]
+size_t chash_insert(chash *t, size_t hash, chash_hash rehash,
+                    const void *ctx);
+
+// chash_erase(t, i) marks the full slot i of t deleted.
+// requires: t is not NULL
+//           slot i is full, and holds nothing that must be released
+// effects: modifies t
+void chash_erase(chash *t, size_t i);
+
+// chash_reserve(t, n, rehash, ctx) grows t, if needed, so that it holds
+//   n keys without growing again. t never shrinks; if deleted slots are
+//   what keeps n keys from fitting, t is rehashed at its capacity.
+// requires: t and rehash are not NULL
+// effects: may modify t, allocate and free heap memory
+void chash_reserve(chash *t, size_t n, chash_hash rehash, const void *ctx);
+
+// chash_rehash(t, n, rehash, ctx) rebuilds t with the smallest capacity
+//   holding max(n, t->size) keys, which may shrink t and clears the slots
+//   left by deletions; the arrays are freed if t is empty and n is 0.
+// requires: t and rehash are not NULL
+// effects: modifies t, may allocate and free heap memory
+void chash_rehash(chash *t, size_t n, chash_hash rehash, const void *ctx);
+
+// chash_next(t, i) produces the index of the first full slot of t at or
+//   after i, or t->capacity if there is none.
+// requires: t is not NULL
+size_t chash_next(const chash *t, size_t i);
+
+#endif
@@ -0,0 +1,327 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "chashmap.h"
+#include "chash.h"
+#include "cerror.h"
+
+// The part of a slot holding a key or a value
+typedef struct {
+  const ctype *type;
+  bool boxed;     // true if the part holds a pointer to the key or value
+  size_t width;
+  size_t offset;  // from the start of the slot
+} slot_part;
+
+// A slot holds the key, then the value at an offset aligned for it
+struct chashmap {
+  slot_part key;
+  slot_part value;
+  chash table;
+};
+
+// Assertion messages
+static const char *ASSERT_TYPE_HAS_HASH
+  = "The key ctype of chashmap must have a hash method!";
+static const char *ASSERT_SAME_SIZE
+  = "The calists of keys and values must have the same size!";
+
+// Helper function declaration
+static void init_part(slot_part *part, const ctype *type, size_t offset);
+static inline size_t align_of(size_t width);
+static inline size_t align_up(size_t n, size_t align);
+static inline void *part_item(const slot_part *part, void *slot);
+static void store_part(const slot_part *part, void *slot, const void *item);
+static void release_part(const slot_part *part, void *slot);
+static size_t hash_slot(const void *slot, const void *ctx);
+static bool slot_equals(const void *slot, const void *key, const void *ctx);
+
+chashmap *chashmap_create(const ctype *key_type, const ctype *value_type) {
+  ASSERT_NOT_NULL(key_type, "The key ctype");
+  ASSERT_NOT_NULL(value_type, "The value ctype");
+  ASSERT_MSG(ctype_has_hash(key_type), ASSERT_TYPE_HAS_HASH);
+
+  chashmap *map = malloc(sizeof(*map));
+  if (!map) {
+    ALLOC_ERROR("chashmap");
+  }
+  init_part(&map->key, key_type, 0);
+  init_part(&map->value, value_type, 0);
+  map->value.offset = align_up(map->key.width, align_of(map->value.width));
+
+  // Slots are laid out back to back, so each must keep both parts aligned
+  size_t align = align_of(map->key.width);
+  if (align_of(map->value.width) > align) {
+    align = align_of(map->value.width);
+  }
+  chash_init(&map->table,
+             align_up(map->value.offset + map->value.width, align));
+  return map;
+}
+
+void chashmap_destroy(chashmap *map) {
+  if (!map) return;
+
+  chashmap_clear(map);
+  chash_free(&map->table);
+  free(map);
+}
+
+void chashmap_clear(chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+
+  const chash *t = &map->table;
+  if (map->key.boxed || map->value.boxed) {
+    for (size_t i = chash_next(t, 0); i < t->capacity;
+         i = chash_next(t, i + 1)) {
+      release_part(&map->key, chash_slot(t, i));
+      release_part(&map->value, chash_slot(t, i));
+    }
+  }
+  chash_clear(&map->table);
+}
+
+void chashmap_print(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+
+  const chash *t = &map->table;
+  printf("{");
+  for (size_t i = chash_next(t, 0), k = 0; i < t->capacity;
+       i = chash_next(t, i + 1), ++k) {
+    if (k != 0) {
+      printf(", ");
+    }
+    void *slot = chash_slot(t, i);
+    data_print(part_item(&map->key, slot), map->key.type);
+    printf(": ");
+    data_print(part_item(&map->value, slot), map->value.type);
+  }
+  printf("}\n");
+}
+
+const ctype *chashmap_key_type(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+  return map->key.type;
+}
+
+const ctype *chashmap_value_type(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+  return map->value.type;
+}
+
+size_t chashmap_size(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+  return map->table.size;
+}
+
+bool chashmap_empty(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+  return map->table.size == 0;
+}
+
+size_t chashmap_capacity(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+  return map->table.capacity;
+}
+
+void chashmap_reserve(chashmap *map, size_t n) {
+  ASSERT_NOT_NULL(map, NULL);
+  chash_reserve(&map->table, n, hash_slot, map);
+}
+
+void chashmap_rehash(chashmap *map, size_t n) {
+  ASSERT_NOT_NULL(map, NULL);
+  chash_rehash(&map->table, n, hash_slot, map);
+}
+
+bool chashmap_put(chashmap *map, const void *key, const void *value) {
+  ASSERT_NOT_NULL(map, NULL);
+  ASSERT_NOT_NULL(key, "The key");
+  ASSERT_NOT_NULL(value, "The value");
+
+  size_t hash = data_hash(key, map->key.type);
+  size_t i = chash_find(&map->table, key, hash, slot_equals, map);
+  if (i != CHASH_NOT_FOUND) {
+    // value may be the value being replaced
+    void *slot = chash_slot(&map->table, i);
+    if (!map->value.boxed) {
+      memmove(part_item(&map->value, slot), value, map->value.width);
+      return false;
+    }
+    void *old = part_item(&map->value, slot);
+    store_part(&map->value, slot, value);
+    data_destroy(old, map->value.type);
+    return false;
+  }
+
+  // key or value may be the POD part of another entry, which moves if the
+  //   table grows, so the new entry is then built aside first
+  unsigned char *entry = NULL;
+  if (chash_owns(&map->table, key) || chash_owns(&map->table, value)) {
+    entry = malloc(map->table.width);
+    if (!entry) {
+      ALLOC_ERROR("chashmap entry");
+    }
+    store_part(&map->key, entry, key);
+    store_part(&map->value, entry, value);
+  }
+
+  i = chash_insert(&map->table, hash, hash_slot, map);
+  void *slot = chash_slot(&map->table, i);
+  if (entry) {
+    memcpy(slot, entry, map->table.width);
+    free(entry);
+  } else {
+    store_part(&map->key, slot, key);
+    store_part(&map->value, slot, value);
+  }
+  return true;
+}
+
+const void *chashmap_get(const chashmap *map, const void *key) {
+  return chashmap_get_mutable((chashmap *) map, key);
+}
+
+void *chashmap_get_mutable(chashmap *map, const void *key) {
+  ASSERT_NOT_NULL(map, NULL);
+  ASSERT_NOT_NULL(key, "The key");
+
+  size_t i = chash_find(&map->table, key, data_hash(key, map->key.type),
+                        slot_equals, map);
+  return (i == CHASH_NOT_FOUND)
+         ? NULL : part_item(&map->value, chash_slot(&map->table, i));
+}
+
+bool chashmap_contains(const chashmap *map, const void *key) {
+  return chashmap_get(map, key) != NULL;
+}
+
+bool chashmap_remove(chashmap *map, const void *key) {
+  ASSERT_NOT_NULL(map, NULL);
+  ASSERT_NOT_NULL(key, "The key");
+
+  size_t i = chash_find(&map->table, key, data_hash(key, map->key.type),
+                        slot_equals, map);
+  if (i == CHASH_NOT_FOUND) {
+    return false;
+  }
+  void *slot = chash_slot(&map->table, i);
+  release_part(&map->key, slot);
+  release_part(&map->value, slot);
+  chash_erase(&map->table, i);
+  return true;
+}
+
+void chashmap_foreach(const chashmap *map, chashmap_visit visit,
+                      const void *args) {
+  ASSERT_NOT_NULL(map, NULL);
+  ASSERT_NOT_NULL(visit, NULL);
+
+  const chash *t = &map->table;
+  for (size_t i = chash_next(t, 0); i < t->capacity;
+       i = chash_next(t, i + 1)) {
+    void *slot = chash_slot(t, i);
+    visit(map, part_item(&map->key, slot), part_item(&map->value, slot),
+          args);
+  }
+}
+
+chashmap *chashmap_from_calists(const calist *keys, const calist *values) {
+  ASSERT_NOT_NULL(keys, "The calist of keys");
+  ASSERT_NOT_NULL(values, "The calist of values");
+  ASSERT_MSG(calist_size(keys) == calist_size(values), ASSERT_SAME_SIZE);
+
+  chashmap *map = chashmap_create(calist_type(keys), calist_type(values));
+  size_t n = calist_size(keys);
+  chashmap_reserve(map, n);
+  for (size_t i = 0; i < n; ++i) {
+    chashmap_put(map, calist_get_unchecked(keys, i),
+                 calist_get_unchecked(values, i));
+  }
+  return map;
+}
+
+calist *chashmap_keys(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+
+  const chash *t = &map->table;
+  calist *al = calist_create_size(map->key.type, t->size ? t->size : 1);
+  for (size_t i = chash_next(t, 0); i < t->capacity;
+       i = chash_next(t, i + 1)) {
+    calist_append(al, part_item(&map->key, chash_slot(t, i)));
+  }
+  return al;
+}
+
+calist *chashmap_values(const chashmap *map) {
+  ASSERT_NOT_NULL(map, NULL);
+
+  const chash *t = &map->table;
+  calist *al = calist_create_size(map->value.type, t->size ? t->size : 1);
+  for (size_t i = chash_next(t, 0); i < t->capacity;
+       i = chash_next(t, i + 1)) {
+    calist_append(al, part_item(&map->value, chash_slot(t, i)));
+  }
+  return al;
+}
+
+// Helper function implementation
+static void init_part(slot_part *part, const ctype *type, size_t offset) {
+  part->type = type;
+  part->boxed = !ctype_is_pod(type);
+  part->width = part->boxed ? sizeof(void *) : data_size(type);
+  part->offset = offset;
+}
+
+// The alignment assumed for a value of width bytes: the largest power of 2
+//   dividing width, which divides the alignment of any C type of that size
+static inline size_t align_of(size_t width) {
+  size_t align = width & (~width + 1);
+  return (align > 16) ? 16 : align;
+}
+
+static inline size_t align_up(size_t n, size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+// Produce the key or value stored in the part of slot
+static inline void *part_item(const slot_part *part, void *slot) {
+  unsigned char *at = (unsigned char *) slot + part->offset;
+  if (!part->boxed) {
+    return at;
+  }
+  void *item;
+  memcpy(&item, at, sizeof(item));
+  return item;
+}
+
+// Fill the part of slot with a deep copy of item
+static void store_part(const slot_part *part, void *slot, const void *item) {
+  unsigned char *at = (unsigned char *) slot + part->offset;
+  if (!part->boxed) {
+    memcpy(at, item, part->width);
+    return;
+  }
+  void *copy = data_dup(item, part->type);
+  if (!copy) {
+    ALLOC_ERROR("chashmap entry");
+  }
+  memcpy(at, &copy, sizeof(copy));
+}
+
+static void release_part(const slot_part *part, void *slot) {
+  if (part->boxed) {
+    data_destroy(part_item(part, slot), part->type);
+  }
+}
+
+static size_t hash_slot(const void *slot, const void *ctx) {
+  const chashmap *map = ctx;
+  return data_hash(part_item(&map->key, (void *) slot), map->key.type);
+}
+
+static bool slot_equals(const void *slot, const void *key, const void *ctx) {
+  const chashmap *map = ctx;
+  return data_cmp(part_item(&map->key, (void *) slot), key,
+                  map->key.type) == 0;
+}
@@ -0,0 +1,252 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "chashset.h"
+#include "chash.h"
+#include "cerror.h"
+
+struct chashset {
+  const ctype *type;
+  bool boxed;   // true if slots hold pointers to the items
+  chash table;
+};
+
+// Assertion messages
+static const char *ASSERT_TYPE_HAS_HASH
+  = "The ctype of chashset must have a hash method!";
+static const char *ASSERT_SAME_TYPE
+  = "chashset and calist must have the same type!";
+
+// Helper function declaration
+static inline const void *slot_item(const chashset *set, const void *slot);
+static void store_slot(const chashset *set, void *slot, const void *item);
+static void release_slot(const chashset *set, void *slot);
+static size_t hash_slot(const void *slot, const void *ctx);
+static bool slot_equals(const void *slot, const void *item, const void *ctx);
+
+chashset *chashset_create(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(ctype_has_hash(type), ASSERT_TYPE_HAS_HASH);
+
+  chashset *set = malloc(sizeof(*set));
+  if (!set) {
+    ALLOC_ERROR("chashset");
+  }
+  set->type = type;
+  set->boxed = !ctype_is_pod(type);
+  chash_init(&set->table, set->boxed ? sizeof(void *) : data_size(type));
+  return set;
+}
+
+void chashset_destroy(chashset *set) {
+  if (!set) return;
+
+  chashset_clear(set);
+  chash_free(&set->table);
+  free(set);
+}
+
+void chashset_clear(chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+
+  const chash *t = &set->table;
+  if (set->boxed) {
+    for (size_t i = chash_next(t, 0); i < t->capacity;
+         i = chash_next(t, i + 1)) {
+      release_slot(set, chash_slot(t, i));
+    }
+  }
+  chash_clear(&set->table);
+}
+
+void chashset_print(const chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+
+  const chash *t = &set->table;
+  printf("{");
+  for (size_t i = chash_next(t, 0), k = 0; i < t->capacity;
+       i = chash_next(t, i + 1), ++k) {
+    if (k != 0) {
+      printf(", ");
+    }
+    data_print(slot_item(set, chash_slot(t, i)), set->type);
+  }
+  printf("}\n");
+}
+
+bool chashset_equals(const chashset *s1, const chashset *s2) {
+  ASSERT_NOT_NULL(s1, "The first chashset");
+  ASSERT_NOT_NULL(s2, "The second chashset");
+
+  if (!ctype_equals(s1->type, s2->type) ||
+      s1->table.size != s2->table.size) {
+    return false;
+  }
+  const chash *t = &s1->table;
+  for (size_t i = chash_next(t, 0); i < t->capacity;
+       i = chash_next(t, i + 1)) {
+    if (!chashset_contains(s2, slot_item(s1, chash_slot(t, i)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const ctype *chashset_type(const chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+  return set->type;
+}
+
+size_t chashset_size(const chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+  return set->table.size;
+}
+
+bool chashset_empty(const chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+  return set->table.size == 0;
+}
+
+size_t chashset_capacity(const chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+  return set->table.capacity;
+}
+
+void chashset_reserve(chashset *set, size_t n) {
+  ASSERT_NOT_NULL(set, NULL);
+  chash_reserve(&set->table, n, hash_slot, set);
+}
+
+void chashset_rehash(chashset *set, size_t n) {
+  ASSERT_NOT_NULL(set, NULL);
+  chash_rehash(&set->table, n, hash_slot, set);
+}
+
+bool chashset_insert(chashset *set, const void *item) {
+  ASSERT_NOT_NULL(set, NULL);
+  ASSERT_NOT_NULL(item, "The item to be inserted");
+
+  size_t hash = data_hash(item, set->type);
+  if (chash_find(&set->table, item, hash, slot_equals, set)
+      != CHASH_NOT_FOUND) {
+    return false;
+  }
+  size_t i = chash_insert(&set->table, hash, hash_slot, set);
+  store_slot(set, chash_slot(&set->table, i), item);
+  return true;
+}
+
+size_t chashset_insert_all(chashset *set, const calist *al) {
+  ASSERT_NOT_NULL(set, NULL);
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(ctype_equals(set->type, calist_type(al)), ASSERT_SAME_TYPE);
+
+  size_t n = calist_size(al);
+  chashset_reserve(set, set->table.size + n);
+  size_t added = 0;
+  for (size_t i = 0; i < n; ++i) {
+    added += chashset_insert(set, calist_get_unchecked(al, i));
+  }
+  return added;
+}
+
+bool chashset_remove(chashset *set, const void *item) {
+  ASSERT_NOT_NULL(set, NULL);
+  ASSERT_NOT_NULL(item, "The item to be removed");
+
+  size_t i = chash_find(&set->table, item, data_hash(item, set->type),
+                        slot_equals, set);
+  if (i == CHASH_NOT_FOUND) {
+    return false;
+  }
+  release_slot(set, chash_slot(&set->table, i));
+  chash_erase(&set->table, i);
+  return true;
+}
+
+bool chashset_contains(const chashset *set, const void *item) {
+  return chashset_get(set, item) != NULL;
+}
+
+const void *chashset_get(const chashset *set, const void *item) {
+  ASSERT_NOT_NULL(set, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t i = chash_find(&set->table, item, data_hash(item, set->type),
+                        slot_equals, set);
+  return (i == CHASH_NOT_FOUND) ? NULL
+                                : slot_item(set, chash_slot(&set->table, i));
+}
+
+void chashset_foreach(const chashset *set, chashset_visit visit,
+                      const void *args) {
+  ASSERT_NOT_NULL(set, NULL);
+  ASSERT_NOT_NULL(visit, NULL);
+
+  const chash *t = &set->table;
+  for (size_t i = chash_next(t, 0); i < t->capacity;
+       i = chash_next(t, i + 1)) {
+    visit(set, slot_item(set, chash_slot(t, i)), args);
+  }
+}
+
+chashset *chashset_from_calist(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  chashset *set = chashset_create(calist_type(al));
+  chashset_insert_all(set, al);
+  return set;
+}
+
+calist *chashset_to_calist(const chashset *set) {
+  ASSERT_NOT_NULL(set, NULL);
+
+  const chash *t = &set->table;
+  calist *al = calist_create_size(set->type, t->size ? t->size : 1);
+  for (size_t i = chash_next(t, 0); i < t->capacity;
+       i = chash_next(t, i + 1)) {
+    calist_append(al, slot_item(set, chash_slot(t, i)));
+  }
+  return al;
+}
+
+// Helper function implementation
+static inline const void *slot_item(const chashset *set, const void *slot) {
+  if (!set->boxed) {
+    return slot;
+  }
+  const void *item;
+  memcpy(&item, slot, sizeof(item));
+  return item;
+}
+
+// Fill slot with a deep copy of item
+static void store_slot(const chashset *set, void *slot, const void *item) {
+  if (!set->boxed) {
+    memcpy(slot, item, set->table.width);
+    return;
+  }
+  void *copy = data_dup(item, set->type);
+  if (!copy) {
+    ALLOC_ERROR("chashset item");
+  }
+  memcpy(slot, &copy, sizeof(copy));
+}
+
+static void release_slot(const chashset *set, void *slot) {
+  if (set->boxed) {
+    void *item;
+    memcpy(&item, slot, sizeof(item));
+    data_destroy(item, set->type);
+  }
+}
+
+static size_t hash_slot(const void *slot, const void *ctx) {
+  const chashset *set = ctx;
+  return data_hash(slot_item(set, slot), set->type);
+}
+
+static bool slot_equals(const void *slot, const void *item, const void *ctx) {
+  const chashset *set = ctx;
+  return data_cmp(slot_item(set, slot), item, set->type) == 0;
+}
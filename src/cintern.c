@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "cintern.h"
+
+// An interned string [the canonical pointer is data]
+typedef struct {
+  size_t refs;
+  size_t hash;
+  size_t len;
+  char data[];
+} intern_entry;
+
+// The table is grown once live and deleted entries fill 70% of it
+static const size_t INTERN_INIT_CAPACITY = 64;
+static const size_t INTERN_MAX_LOAD_PERCENT = 70;
+
+// Marks a deleted entry, which keeps probe sequences intact
+static intern_entry tombstone;
+#define TOMBSTONE (&tombstone)
+
+// The open-addressing table with linear probing [capacity is a power of 2]
+static intern_entry **table = NULL;
+static size_t capacity = 0;
+static size_t live = 0;  // entries holding a string
+static size_t used = 0;  // live and deleted entries
+
+// Helper function declaration
+static size_t find_pos(const char *str, size_t len, size_t hash);
+static intern_entry *entry_of(const char *str);
+static bool grow(void);
+
+const char *cintern_acquire(const char *str) {
+  size_t len = strlen(str);
+  size_t hash = cintern_hash(str);
+
+  if (capacity > 0) {
+    size_t pos = find_pos(str, len, hash);
+    if (table[pos] && table[pos] != TOMBSTONE) {
+      ++table[pos]->refs;
+      return table[pos]->data;
+    }
+  }
+
+  if ((used + 1) * 100 > capacity * INTERN_MAX_LOAD_PERCENT && !grow()) {
+    return NULL;
+  }
+  if (len > SIZE_MAX - sizeof(intern_entry) - 1) {
+    return NULL;
+  }
+  intern_entry *entry = malloc(sizeof(*entry) + len + 1);
+  if (!entry) {
+    return NULL;
+  }
+  entry->refs = 1;
+  entry->hash = hash;
+  entry->len = len;
+  memcpy(entry->data, str, len + 1);
+
+  // Reuse the first deleted entry on the probe sequence, if any
+  size_t mask = capacity - 1;
+  size_t pos = hash & mask;
+  while (table[pos] && table[pos] != TOMBSTONE) {
+    pos = (pos + 1) & mask;
+  }
+  if (!table[pos]) {
+    ++used;
+  }
+  table[pos] = entry;
+  ++live;
+  return entry->data;
+}
+
+void cintern_release(const char *str) {
+  intern_entry *entry = entry_of(str);
+  if (--entry->refs > 0) return;
+
+  size_t mask = capacity - 1;
+  size_t pos = entry->hash & mask;
+  while (table[pos] != entry) {
+    pos = (pos + 1) & mask;
+  }
+  table[pos] = TOMBSTONE;
+  free(entry);
+
+  // An empty table is freed so that no memory outlives the last string
+  if (--live == 0) {
+    free(table);
+    table = NULL;
+    capacity = 0;
+    used = 0;
+  }
+}
+
+const char *cintern_lookup(const char *str) {
+  if (capacity == 0) {
+    return NULL;
+  }
+  size_t pos = find_pos(str, strlen(str), cintern_hash(str));
+  return (table[pos] && table[pos] != TOMBSTONE) ? table[pos]->data : NULL;
+}
+
+// FNV-1a
+size_t cintern_hash(const char *str) {
+  const unsigned char *ch = (const unsigned char *) str;
+  uint64_t hash = 14695981039346656037ULL;
+  for (; *ch; ++ch) {
+    hash ^= *ch;
+    hash *= 1099511628211ULL;
+  }
+  return (size_t) hash;
+}
+
+// Helper function implementation
+// Produce the position of the live entry equal to str, or of the empty
+//   entry that ends its probe sequence
+static size_t find_pos(const char *str, size_t len, size_t hash) {
+  size_t mask = capacity - 1;
+  size_t pos = hash & mask;
+  for (; table[pos]; pos = (pos + 1) & mask) {
+    intern_entry *entry = table[pos];
+    if (entry != TOMBSTONE && entry->hash == hash && entry->len == len &&
+        !memcmp(entry->data, str, len)) {
+      break;
+    }
+  }
+  return pos;
+}
+
+static intern_entry *entry_of(const char *str) {
+  return (intern_entry *) (str - offsetof(intern_entry, data));
+}
+
+// Rehash the live entries into a table with room for one more entry,
+//   doubling the capacity unless deleted entries free enough room
+static bool grow(void) {
+  size_t new_capacity = capacity ? capacity : INTERN_INIT_CAPACITY;
+  while ((live + 1) * 100 > new_capacity * INTERN_MAX_LOAD_PERCENT / 2) {
+    if (new_capacity > SIZE_MAX / 2 / sizeof(*table)) {
+      return false;
+    }
+    new_capacity *= 2;
+  }
+
+  intern_entry **new_table = calloc(new_capacity, sizeof(*new_table));
+  if (!new_table) {
+    return false;
+  }
+  size_t mask = new_capacity - 1;
+  for (size_t i = 0; i < capacity; ++i) {
+    intern_entry *entry = table[i];
+    if (entry && entry != TOMBSTONE) {
+      size_t pos = entry->hash & mask;
+      while (new_table[pos]) {
+        pos = (pos + 1) & mask;
+      }
+      new_table[pos] = entry;
+    }
+  }
+
+  free(table);
+  table = new_table;
+  capacity = new_capacity;
+  used = live;
+  return true;
+}
@@ -0,0 +1,36 @@
+// The cintern module provides the shared intern table behind
+//   ctype_interned_string(). Each distinct string is stored once with a
+//   reference count, and equal strings share one canonical pointer.
+// note: cintern is internal to the library and is not part of the public API
+//       the intern table is not thread-safe
+
+#ifndef CINTERN_H
+#define CINTERN_H
+
+#include <stddef.h>
+
+// cintern_acquire(str) produces the canonical copy of str, adding it to
+//   the table if needed, and takes a reference to it.
+// requires: str is not NULL
+// effects: may allocate heap memory [caller must release the reference
+//          with cintern_release]
+// note: returns NULL if allocation fails
+const char *cintern_acquire(const char *str);
+
+// cintern_release(str) drops a reference to the canonical string str,
+//   freeing it once no references remain.
+// requires: str was produced by cintern_acquire and is still referenced
+// effects: may free heap memory [str may become invalid]
+void cintern_release(const char *str);
+
+// cintern_lookup(str) produces the canonical copy of str if one exists,
+//   and NULL otherwise. No reference is taken.
+// requires: str is not NULL
+const char *cintern_lookup(const char *str);
+
+// cintern_hash(str) produces the hash code of str, which matches the hash
+//   of the built-in string ctypes.
+// requires: str is not NULL
+size_t cintern_hash(const char *str);
+
+#endif
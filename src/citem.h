@@ -0,0 +1,31 @@
+// The citem module provides the in-place operations on ctypeitem records
+//   shared by ctypeitem and valist, which keeps its items as an array of
+//   ctypeitem records instead of pointers to separate boxes.
+// note: citem is internal to the library and is not part of the public API
+
+#ifndef CITEM_H
+#define CITEM_H
+
+#include "ctypeitem.h"
+
+// citem_store(item, value, type) fills the record at item with a deep copy
+//   of value: inline if type is POD and small enough, and in the heap
+//   otherwise.
+// requires: item, value and type are not NULL
+//           item does not hold an owned value
+// effects: modifies item, may allocate heap memory
+void citem_store(ctypeitem *item, const void *value, const ctype *type);
+
+// citem_release(item) frees the value owned by item, if any.
+// requires: item is not NULL
+// effects: may free heap memory [the value of item becomes invalid]
+void citem_release(ctypeitem *item);
+
+// citem_cmp(i1, i2) orders i1 and i2 by type, then by value, producing 0
+//   if they are equal.
+// requires: i1 and i2 are not NULL
+// note: ctypes are ordered by address, so the order between items of 
+//       different types is arbitrary but consistent
+int citem_cmp(const ctypeitem *i1, const ctypeitem *i2);
+
+#endif
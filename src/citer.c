@@ -0,0 +1,266 @@
+#include <stdlib.h>
+#include "citer.h"
+#include "cerror.h"
+
+// Assertion messages
+static const char *ASSERT_STAGE_ROOM
+  = "citer cannot have more than CITER_MAX_STAGES stages!";
+static const char *ASSERT_HAS_TYPE
+  = "citer must produce items of one ctype to be collected to a calist!";
+
+// Helper function declaration
+static citer make_citer(citer_source source, const void *list,
+                        const ctype *type, size_t size);
+static citer_stage *add_stage(citer *it, citer_stage_kind kind);
+static bool read_source(citer *it, const void **item);
+static bool run_stages(citer *it, const void **item);
+
+citer citer_calist(const calist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return make_citer(CITER_SOURCE_CALIST, al, calist_type(al),
+                    calist_size(al));
+}
+
+citer citer_valist(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return make_citer(CITER_SOURCE_VALIST, al, NULL, valist_size(al));
+}
+
+citer citer_valist_type(const valist *al, const ctype *type) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+
+  citer it = make_citer(CITER_SOURCE_VALIST_TYPE, al, type,
+                        valist_size(al));
+  // The items of type are not at known indices
+  it.match = type;
+  it.ranged = false;
+  return it;
+}
+
+const ctype *citer_type(const citer *it) {
+  ASSERT_NOT_NULL(it, NULL);
+  return it->type;
+}
+
+void citer_filter(citer *it, citer_pred pred, const void *args) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  citer_stage *s = add_stage(it, CITER_STAGE_FILTER);
+  s->pred = pred;
+  s->args = args;
+  it->ranged = false;
+}
+
+void citer_map(citer *it, citer_transform transform, const ctype *type,
+               const void *args) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_NOT_NULL(transform, NULL);
+
+  // A map keeps the number and order of items, so later skip and take
+  //   stages may still narrow the range
+  citer_stage *s = add_stage(it, CITER_STAGE_MAP);
+  s->transform = transform;
+  s->args = args;
+  it->type = type;
+}
+
+void citer_skip(citer *it, size_t n) {
+  ASSERT_NOT_NULL(it, NULL);
+
+  if (it->ranged) {
+    it->pos = (n < it->end - it->pos) ? it->pos + n : it->end;
+    return;
+  }
+  add_stage(it, CITER_STAGE_SKIP)->left = n;
+}
+
+void citer_take(citer *it, size_t n) {
+  ASSERT_NOT_NULL(it, NULL);
+
+  if (it->ranged) {
+    if (n < it->end - it->pos) {
+      it->end = it->pos + n;
+    }
+    return;
+  }
+  citer_stage *s = add_stage(it, CITER_STAGE_TAKE);
+  s->left = n;
+  if (n == 0) {
+    it->done = true;
+  }
+}
+
+bool citer_next(citer *it, const void **item) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  const void *cur;
+  while (!it->done && read_source(it, &cur)) {
+    if (run_stages(it, &cur)) {
+      *item = cur;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t citer_count(citer *it) {
+  ASSERT_NOT_NULL(it, NULL);
+
+  // Without stages, the items left are those of the range
+  if (it->stage_count == 0 && it->source != CITER_SOURCE_VALIST_TYPE) {
+    size_t n = it->end - it->pos;
+    it->pos = it->end;
+    return n;
+  }
+  size_t n = 0;
+  const void *item;
+  while (citer_next(it, &item)) {
+    ++n;
+  }
+  return n;
+}
+
+bool citer_any(citer *it, citer_pred pred, const void *args) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  const void *item;
+  while (citer_next(it, &item)) {
+    if (pred(item, args)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool citer_all(citer *it, citer_pred pred, const void *args) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  const void *item;
+  while (citer_next(it, &item)) {
+    if (!pred(item, args)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void citer_reduce(citer *it, void *acc, citer_accumulate accumulate,
+                  const void *args) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_NOT_NULL(acc, NULL);
+  ASSERT_NOT_NULL(accumulate, NULL);
+
+  const void *item;
+  while (citer_next(it, &item)) {
+    accumulate(acc, item, args);
+  }
+}
+
+calist *citer_collect(citer *it) {
+  ASSERT_NOT_NULL(it, NULL);
+  ASSERT_MSG(it->type, ASSERT_HAS_TYPE);
+
+  calist *al = calist_create(it->type);
+  const void *item;
+  while (citer_next(it, &item)) {
+    calist_append(al, item);
+  }
+  return al;
+}
+
+valist *citer_collect_valist(citer *it) {
+  ASSERT_NOT_NULL(it, NULL);
+
+  valist *al = valist_create();
+  const void *item;
+  while (citer_next(it, &item)) {
+    valist_append(al, it->type ? CTYPEITEM(item, it->type) : item);
+  }
+  return al;
+}
+
+// Helper function implementation
+static citer make_citer(citer_source source, const void *list,
+                        const ctype *type, size_t size) {
+  citer it;
+  it.source = source;
+  it.list = list;
+  it.match = NULL;
+  it.type = type;
+  it.pos = 0;
+  it.end = size;
+  it.done = false;
+  it.ranged = true;
+  it.stage_count = 0;
+  return it;
+}
+
+static citer_stage *add_stage(citer *it, citer_stage_kind kind) {
+  ASSERT_MSG(it->stage_count < CITER_MAX_STAGES, ASSERT_STAGE_ROOM);
+
+  citer_stage *s = &it->stages[it->stage_count++];
+  s->kind = kind;
+  s->pred = NULL;
+  s->transform = NULL;
+  s->args = NULL;
+  s->left = 0;
+  return s;
+}
+
+// Read the next item of the list of it into *item
+static bool read_source(citer *it, const void **item) {
+  switch (it->source) {
+    case CITER_SOURCE_CALIST:
+      if (it->pos == it->end) return false;
+      *item = calist_get_unchecked(it->list, it->pos++);
+      return true;
+    case CITER_SOURCE_VALIST:
+      if (it->pos == it->end) return false;
+      *item = valist_get(it->list, it->pos++);
+      return true;
+    case CITER_SOURCE_VALIST_TYPE:
+      while (it->pos < it->end) {
+        const ctypeitem *record = valist_get(it->list, it->pos++);
+        if (ctype_equals(ctypeitem_type(record), it->match)) {
+          *item = ctypeitem_value(record);
+          return true;
+        }
+      }
+      return false;
+  }
+  return false;
+}
+
+// Pass *item through the stages of it, producing false if a stage drops it
+static bool run_stages(citer *it, const void **item) {
+  for (size_t i = 0; i < it->stage_count; ++i) {
+    citer_stage *s = &it->stages[i];
+    switch (s->kind) {
+      case CITER_STAGE_FILTER:
+        if (!s->pred(*item, s->args)) return false;
+        break;
+      case CITER_STAGE_MAP:
+        *item = s->transform(*item, s->buffer.bytes, s->args);
+        break;
+      case CITER_STAGE_SKIP:
+        if (s->left > 0) {
+          --s->left;
+          return false;
+        }
+        break;
+      case CITER_STAGE_TAKE:
+        // The stage ends it as it passes its last item, before any more
+        //   items are read
+        if (--s->left == 0) {
+          it->done = true;
+        }
+        break;
+    }
+  }
+  return true;
+}
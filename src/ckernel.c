@@ -0,0 +1,439 @@
+#include <stdint.h>
+#include "ckernel.h"
+#include "csort.h"
+#include "csimd.h"
+
+// Partitions of at most this many values are finished by insertion sort
+#define KERNEL_INSERTION_CUTOFF 16
+
+// Partitions of more than this many values use the ninther for the pivot
+#define KERNEL_NINTHER_THRESHOLD 128
+
+// Value comparisons matching the DEFINE_CMP methods of the built-in ctypes
+#define KERNEL_LT(a, b) ((a) < (b))
+#define KERNEL_EQ(a, b) (!((a) < (b)) && !((a) > (b)))
+
+// Helper function declaration
+#define DEFINE_SEARCH(type) \
+  static size_t find_##type(const type *base, size_t n, type value) { \
+    for (size_t i = 0; i < n; ++i) { \
+      if (KERNEL_EQ(base[i], value)) return i; \
+    } \
+    return n; \
+  } \
+  static size_t find_last_##type(const type *base, size_t n, type value) { \
+    for (size_t i = n; i-- > 0;) { \
+      if (KERNEL_EQ(base[i], value)) return i; \
+    } \
+    return n; \
+  } \
+  static size_t count_##type(const type *base, size_t n, type value) { \
+    size_t total = 0; \
+    for (size_t i = 0; i < n; ++i) { \
+      total += KERNEL_EQ(base[i], value); \
+    } \
+    return total; \
+  } \
+  static size_t min_##type(const type *base, size_t n) { \
+    size_t best = 0; \
+    for (size_t i = 1; i < n; ++i) { \
+      if (KERNEL_LT(base[i], base[best])) best = i; \
+    } \
+    return best; \
+  } \
+  static size_t max_##type(const type *base, size_t n) { \
+    size_t best = 0; \
+    for (size_t i = 1; i < n; ++i) { \
+      if (KERNEL_LT(base[best], base[i])) best = i; \
+    } \
+    return best; \
+  } \
+  static bool equal_##type(const type *a, const type *b, size_t n) { \
+    for (size_t i = 0; i < n; ++i) { \
+      if (!KERNEL_EQ(a[i], b[i])) return false; \
+    } \
+    return true; \
+  } \
+  static size_t bsearch_##type(const type *base, size_t n, type value) { \
+    if (n == 0) return n; \
+    size_t low = 0; \
+    size_t high = n - 1; \
+    while (low <= high) { \
+      size_t mid = (low + high) / 2; \
+      if (KERNEL_LT(base[mid], value)) { \
+        low = mid + 1; \
+      } else if (KERNEL_LT(value, base[mid])) { \
+        if (mid == 0) break; \
+        high = mid - 1; \
+      } else { \
+        return mid; \
+      } \
+    } \
+    return n; \
+  } \
+  static size_t lower_bound_##type(const type *base, size_t n, \
+                                   type value) { \
+    size_t low = 0; \
+    while (n > 0) { \
+      size_t half = n / 2; \
+      if (KERNEL_LT(base[low + half], value)) { \
+        low += half + 1; \
+        n -= half + 1; \
+      } else { \
+        n = half; \
+      } \
+    } \
+    return low; \
+  } \
+  static size_t upper_bound_##type(const type *base, size_t n, \
+                                   type value) { \
+    size_t low = 0; \
+    while (n > 0) { \
+      size_t half = n / 2; \
+      if (!KERNEL_LT(value, base[low + half])) { \
+        low += half + 1; \
+        n -= half + 1; \
+      } else { \
+        n = half; \
+      } \
+    } \
+    return low; \
+  }
+
+// Introsort specialized for type [see csort_intro]
+#define DEFINE_SORT(type) \
+  static inline void swap_##type(type *a, type *b) { \
+    type temp = *a; \
+    *a = *b; \
+    *b = temp; \
+  } \
+  static size_t median_##type(const type *base, size_t a, size_t b, \
+                              size_t c) { \
+    if (KERNEL_LT(base[a], base[b])) { \
+      if (KERNEL_LT(base[b], base[c])) return b; \
+      return KERNEL_LT(base[a], base[c]) ? c : a; \
+    } \
+    if (KERNEL_LT(base[a], base[c])) return a; \
+    return KERNEL_LT(base[b], base[c]) ? c : b; \
+  } \
+  static void insertion_##type(type *base, size_t n) { \
+    for (size_t i = 1; i < n; ++i) { \
+      type value = base[i]; \
+      size_t j = i; \
+      for (; j > 0 && KERNEL_LT(value, base[j - 1]); --j) { \
+        base[j] = base[j - 1]; \
+      } \
+      base[j] = value; \
+    } \
+  } \
+  static void sift_##type(type *base, size_t root, size_t n) { \
+    type value = base[root]; \
+    for (;;) { \
+      size_t child = 2 * root + 1; \
+      if (child >= n) break; \
+      if (child + 1 < n && KERNEL_LT(base[child], base[child + 1])) { \
+        ++child; \
+      } \
+      if (!KERNEL_LT(value, base[child])) break; \
+      base[root] = base[child]; \
+      root = child; \
+    } \
+    base[root] = value; \
+  } \
+  static void heap_##type(type *base, size_t n) { \
+    for (size_t i = n / 2; i-- > 0;) { \
+      sift_##type(base, i, n); \
+    } \
+    for (size_t end = n; end-- > 1;) { \
+      swap_##type(&base[0], &base[end]); \
+      sift_##type(base, 0, end); \
+    } \
+  } \
+  static size_t partition_##type(type *base, size_t n) { \
+    size_t mid = n / 2; \
+    size_t last = n - 1; \
+    size_t pivot; \
+    if (n > KERNEL_NINTHER_THRESHOLD) { \
+      size_t step = n / 8; \
+      size_t m1 = median_##type(base, 0, step, 2 * step); \
+      size_t m2 = median_##type(base, mid - step, mid, mid + step); \
+      size_t m3 = median_##type(base, last - 2 * step, last - step, last); \
+      pivot = median_##type(base, m1, m2, m3); \
+    } else { \
+      pivot = median_##type(base, 0, mid, last); \
+    } \
+    swap_##type(&base[0], &base[pivot]); \
+    type p = base[0]; \
+    size_t i = 1; \
+    size_t j = last; \
+    for (;;) { \
+      while (i <= j && KERNEL_LT(base[i], p)) ++i; \
+      while (i <= j && KERNEL_LT(p, base[j])) --j; \
+      if (i >= j) break; \
+      swap_##type(&base[i], &base[j]); \
+      ++i; \
+      --j; \
+    } \
+    swap_##type(&base[0], &base[j]); \
+    return j; \
+  } \
+  static void sort_##type(type *base, size_t n) { \
+    size_t depth_limit = 0; \
+    for (size_t i = n; i > 1; i >>= 1) { \
+      depth_limit += 2; \
+    } \
+    while (n > KERNEL_INSERTION_CUTOFF) { \
+      if (depth_limit == 0) { \
+        heap_##type(base, n); \
+        return; \
+      } \
+      --depth_limit; \
+      size_t pos = partition_##type(base, n); \
+      size_t left = pos; \
+      size_t right = n - pos - 1; \
+      if (left < right) { \
+        sort_##type(base, left); \
+        base += pos + 1; \
+        n = right; \
+      } else { \
+        sort_##type(base + pos + 1, right); \
+        n = left; \
+      } \
+    } \
+    insertion_##type(base, n); \
+  }
+
+// Slot comparator of type for the stable and parallel sorts
+#define DEFINE_SLOT_CMP(type) \
+  static int slot_cmp_##type(const void *a, const void *b, \
+                             const void *ctx) { \
+    (void) ctx; \
+    const type x = *(const type *) a; \
+    const type y = *(const type *) b; \
+    return KERNEL_LT(y, x) - KERNEL_LT(x, y); \
+  }
+
+// === Integral types ===
+DEFINE_SEARCH(int)
+DEFINE_SORT(int)
+DEFINE_SLOT_CMP(int)
+
+DEFINE_SEARCH(long)
+DEFINE_SORT(long)
+DEFINE_SLOT_CMP(long)
+
+DEFINE_SEARCH(char)
+DEFINE_SORT(char)
+DEFINE_SLOT_CMP(char)
+
+DEFINE_SEARCH(bool)
+DEFINE_SORT(bool)
+DEFINE_SLOT_CMP(bool)
+
+DEFINE_SEARCH(size_t)
+DEFINE_SORT(size_t)
+DEFINE_SLOT_CMP(size_t)
+
+// === Floating-point types ===
+DEFINE_SEARCH(float)
+DEFINE_SORT(float)
+DEFINE_SLOT_CMP(float)
+
+DEFINE_SEARCH(double)
+DEFINE_SORT(double)
+DEFINE_SLOT_CMP(double)
+
+// Dispatch stmt(type) on kind
+#define KERNEL_DISPATCH(kind, stmt) do { \
+  switch (kind) { \
+    case CKERNEL_INT: stmt(int); break; \
+    case CKERNEL_LONG: stmt(long); break; \
+    case CKERNEL_CHAR: stmt(char); break; \
+    case CKERNEL_BOOL: stmt(bool); break; \
+    case CKERNEL_SIZE_T: stmt(size_t); break; \
+    case CKERNEL_FLOAT: stmt(float); break; \
+    case CKERNEL_DOUBLE: stmt(double); break; \
+    case CKERNEL_NONE: break; \
+  } \
+} while (0)
+
+// The csimd lanes
+typedef enum {
+  LANE_NONE,
+  LANE_I32,
+  LANE_I64,
+  LANE_F32,
+  LANE_F64,
+} simd_lane;
+
+// Produce the csimd lane for kind, or LANE_NONE if there is none; unless
+//   ordered is false, unsigned kinds have no lane [lanes are signed]
+static simd_lane select_lane(ckernel_kind kind, bool ordered) {
+#ifdef CSIMD_AVAILABLE
+  switch (kind) {
+    case CKERNEL_INT:
+      return (sizeof(int) == sizeof(int32_t)) ? LANE_I32 : LANE_NONE;
+    case CKERNEL_LONG:
+      if (sizeof(long) == sizeof(int32_t)) return LANE_I32;
+      return (sizeof(long) == sizeof(int64_t)) ? LANE_I64 : LANE_NONE;
+    case CKERNEL_SIZE_T:
+      if (ordered) return LANE_NONE;
+      if (sizeof(size_t) == sizeof(int32_t)) return LANE_I32;
+      return (sizeof(size_t) == sizeof(int64_t)) ? LANE_I64 : LANE_NONE;
+    case CKERNEL_FLOAT:
+      return LANE_F32;
+    case CKERNEL_DOUBLE:
+      return LANE_F64;
+    default:
+      return LANE_NONE;
+  }
+#else
+  (void) kind;
+  (void) ordered;
+  return LANE_NONE;
+#endif
+}
+
+// Dispatch return csimd_<op>_<lane>(args) on the lane of kind
+#ifdef CSIMD_AVAILABLE
+#define SIMD_DISPATCH(kind, ordered, op, i32_args, i64_args, f32_args, \
+                      f64_args) do { \
+  switch (select_lane(kind, ordered)) { \
+    case LANE_I32: return csimd_##op##_i32 i32_args; \
+    case LANE_I64: return csimd_##op##_i64 i64_args; \
+    case LANE_F32: return csimd_##op##_f32 f32_args; \
+    case LANE_F64: return csimd_##op##_f64 f64_args; \
+    case LANE_NONE: break; \
+  } \
+} while (0)
+#else
+#define SIMD_DISPATCH(kind, ordered, op, i32_args, i64_args, f32_args, \
+                      f64_args) ((void) select_lane(kind, ordered))
+#endif
+
+// Argument lists for SIMD_DISPATCH of search and count kernels
+#define SEARCH_ARGS(type) (base, n, *(const type *) item)
+
+ckernel_kind ckernel_select(const ctype *type) {
+  if (type == ctype_int()) return CKERNEL_INT;
+  if (type == ctype_long()) return CKERNEL_LONG;
+  if (type == ctype_char()) return CKERNEL_CHAR;
+  if (type == ctype_bool()) return CKERNEL_BOOL;
+  if (type == ctype_size_t()) return CKERNEL_SIZE_T;
+  if (type == ctype_float()) return CKERNEL_FLOAT;
+  if (type == ctype_double()) return CKERNEL_DOUBLE;
+  return CKERNEL_NONE;
+}
+
+size_t ckernel_find(ckernel_kind kind, const void *base, size_t n,
+                    const void *item) {
+  SIMD_DISPATCH(kind, false, find, SEARCH_ARGS(int32_t),
+                SEARCH_ARGS(int64_t), SEARCH_ARGS(float),
+                SEARCH_ARGS(double));
+#define FIND(type) return find_##type(base, n, *(const type *) item)
+  KERNEL_DISPATCH(kind, FIND);
+#undef FIND
+  return n;
+}
+
+size_t ckernel_find_last(ckernel_kind kind, const void *base, size_t n,
+                         const void *item) {
+  SIMD_DISPATCH(kind, false, find_last, SEARCH_ARGS(int32_t),
+                SEARCH_ARGS(int64_t), SEARCH_ARGS(float),
+                SEARCH_ARGS(double));
+#define FIND_LAST(type) return find_last_##type(base, n, *(const type *) item)
+  KERNEL_DISPATCH(kind, FIND_LAST);
+#undef FIND_LAST
+  return n;
+}
+
+size_t ckernel_count(ckernel_kind kind, const void *base, size_t n,
+                     const void *item) {
+  SIMD_DISPATCH(kind, false, count, SEARCH_ARGS(int32_t),
+                SEARCH_ARGS(int64_t), SEARCH_ARGS(float),
+                SEARCH_ARGS(double));
+#define COUNT(type) return count_##type(base, n, *(const type *) item)
+  KERNEL_DISPATCH(kind, COUNT);
+#undef COUNT
+  return 0;
+}
+
+size_t ckernel_min(ckernel_kind kind, const void *base, size_t n) {
+  SIMD_DISPATCH(kind, true, min, (base, n), (base, n), (base, n),
+                (base, n));
+#define MIN(type) return min_##type(base, n)
+  KERNEL_DISPATCH(kind, MIN);
+#undef MIN
+  return 0;
+}
+
+size_t ckernel_max(ckernel_kind kind, const void *base, size_t n) {
+  SIMD_DISPATCH(kind, true, max, (base, n), (base, n), (base, n),
+                (base, n));
+#define MAX(type) return max_##type(base, n)
+  KERNEL_DISPATCH(kind, MAX);
+#undef MAX
+  return 0;
+}
+
+bool ckernel_equal(ckernel_kind kind, const void *a, const void *b,
+                   size_t n) {
+#define EQUAL(type) return equal_##type(a, b, n)
+  KERNEL_DISPATCH(kind, EQUAL);
+#undef EQUAL
+  return false;
+}
+
+size_t ckernel_bsearch(ckernel_kind kind, const void *base, size_t n,
+                       const void *item) {
+#define BSEARCH(type) return bsearch_##type(base, n, *(const type *) item)
+  KERNEL_DISPATCH(kind, BSEARCH);
+#undef BSEARCH
+  return n;
+}
+
+size_t ckernel_lower_bound(ckernel_kind kind, const void *base, size_t n,
+                           const void *item) {
+#define LOWER_BOUND(type) \
+  return lower_bound_##type(base, n, *(const type *) item)
+  KERNEL_DISPATCH(kind, LOWER_BOUND);
+#undef LOWER_BOUND
+  return n;
+}
+
+size_t ckernel_upper_bound(ckernel_kind kind, const void *base, size_t n,
+                           const void *item) {
+#define UPPER_BOUND(type) \
+  return upper_bound_##type(base, n, *(const type *) item)
+  KERNEL_DISPATCH(kind, UPPER_BOUND);
+#undef UPPER_BOUND
+  return n;
+}
+
+void ckernel_sort(ckernel_kind kind, void *base, size_t n) {
+#define SORT(type) sort_##type(base, n)
+  KERNEL_DISPATCH(kind, SORT);
+#undef SORT
+}
+
+csort_cmp ckernel_slot_cmp(ckernel_kind kind) {
+#define SLOT_CMP(type) return slot_cmp_##type
+  KERNEL_DISPATCH(kind, SLOT_CMP);
+#undef SLOT_CMP
+  return NULL;
+}
+
+void ckernel_stable_sort(ckernel_kind kind, void *base, size_t n) {
+  switch (kind) {
+    case CKERNEL_FLOAT:
+      // -0.0 and 0.0 compare equal but are distinguishable
+      csort_tim(base, n, sizeof(float), slot_cmp_float, NULL);
+      break;
+    case CKERNEL_DOUBLE:
+      csort_tim(base, n, sizeof(double), slot_cmp_double, NULL);
+      break;
+    default:
+      ckernel_sort(kind, base, n);
+      break;
+  }
+}
@@ -0,0 +1,108 @@
+// The ckernel module provides type-specialized search, count, equality
+//   and sorting kernels for contiguous arrays of the built-in ctypes.
+//   Kernels compare values directly instead of calling the ctype cmp
+//   method, and match its semantics exactly: two values are equal if
+//   neither is less than the other. Search, count and min/max kernels for
+//   32-bit and 64-bit lanes are vectorized when csimd is available.
+// note: ckernel is internal to the library and is not part of the public API
+
+#ifndef CKERNEL_H
+#define CKERNEL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ctype.h"
+#include "csort.h"
+
+// ckernel_kind identifies the kernels for a built-in ctype.
+typedef enum {
+  CKERNEL_NONE,
+  CKERNEL_INT,
+  CKERNEL_LONG,
+  CKERNEL_CHAR,
+  CKERNEL_BOOL,
+  CKERNEL_SIZE_T,
+  CKERNEL_FLOAT,
+  CKERNEL_DOUBLE,
+} ckernel_kind;
+
+// ckernel_select(type) produces the kernel kind for type, or CKERNEL_NONE
+//   if type is not one of the built-in POD singletons.
+// requires: type is not NULL
+ckernel_kind ckernel_select(const ctype *type);
+
+// ckernel_find(kind, base, n, item) produces the index of the first value
+//   in base[0..n) equal to the value at item, or n if there is none.
+// requires: kind is not CKERNEL_NONE
+//           base is not NULL if n > 0, item is not NULL
+size_t ckernel_find(ckernel_kind kind, const void *base, size_t n,
+                    const void *item);
+
+// ckernel_find_last(kind, base, n, item) produces the index of the last
+//   value in base[0..n) equal to the value at item, or n if there is none.
+// requires: see ckernel_find
+size_t ckernel_find_last(ckernel_kind kind, const void *base, size_t n,
+                         const void *item);
+
+// ckernel_count(kind, base, n, item) produces the number of values in
+//   base[0..n) equal to the value at item.
+// requires: see ckernel_find
+size_t ckernel_count(ckernel_kind kind, const void *base, size_t n,
+                     const void *item);
+
+// ckernel_min(kind, base, n) produces the index of the first smallest
+//   value in base[0..n); ckernel_max(kind, base, n) produces the index of
+//   the first largest value. Both match a sequential scan that replaces
+//   the candidate only by a strictly smaller (or larger) value.
+// requires: kind is not CKERNEL_NONE
+//           base is not NULL, n > 0
+size_t ckernel_min(ckernel_kind kind, const void *base, size_t n);
+size_t ckernel_max(ckernel_kind kind, const void *base, size_t n);
+
+// ckernel_equal(kind, a, b, n) produces true if a[i] equals b[i] for
+//   all 0 <= i < n, and false otherwise.
+// requires: kind is not CKERNEL_NONE
+//           a and b are not NULL if n > 0
+bool ckernel_equal(ckernel_kind kind, const void *a, const void *b,
+                   size_t n);
+
+// ckernel_bsearch(kind, base, n, item) produces any index of a value in
+//   the sorted base[0..n) equal to the value at item, or n if there is
+//   none. The index matches the one found by the generic binary search.
+// requires: see ckernel_find
+//           base is sorted in ascending order [not asserted]
+size_t ckernel_bsearch(ckernel_kind kind, const void *base, size_t n,
+                       const void *item);
+
+// ckernel_lower_bound(kind, base, n, item) produces the index of the first
+//   value in the sorted base[0..n) that is not less than the value at item;
+//   ckernel_upper_bound(kind, base, n, item) produces the index of the
+//   first value greater than it. Both produce n if there is none.
+// requires: see ckernel_bsearch
+size_t ckernel_lower_bound(ckernel_kind kind, const void *base, size_t n,
+                           const void *item);
+size_t ckernel_upper_bound(ckernel_kind kind, const void *base, size_t n,
+                           const void *item);
+
+// ckernel_sort(kind, base, n) sorts base[0..n) in ascending order
+//   [see csort_intro].
+// requires: kind is not CKERNEL_NONE
+//           base is not NULL if n > 0
+// effects: modifies base
+void ckernel_sort(ckernel_kind kind, void *base, size_t n);
+
+// ckernel_stable_sort(kind, base, n) stably sorts base[0..n) in
+//   ascending order.
+// requires: kind is not CKERNEL_NONE
+//           base is not NULL if n > 0
+// effects: modifies base, may allocate and free heap memory
+// note: equal integral values are indistinguishable, so integral kinds
+//       use the faster unstable sort
+void ckernel_stable_sort(ckernel_kind kind, void *base, size_t n);
+
+// ckernel_slot_cmp(kind) produces a slot comparator on the values of kind
+//   [ctx is ignored] that agrees with the ctype cmp method.
+// requires: kind is not CKERNEL_NONE
+csort_cmp ckernel_slot_cmp(ckernel_kind kind);
+
+#endif
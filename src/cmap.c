@@ -0,0 +1,190 @@
+// mremap is a GNU extension
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cmap.h"
+
+// The file header [CMAP_HEADER_SIZE bytes, keeping the items aligned]
+typedef struct {
+  char magic[8];
+  uint64_t width;
+  uint64_t size;
+} cmap_header;
+
+static const char CMAP_MAGIC[8] = "CALIST1";
+#define CMAP_HEADER_SIZE ((size_t) 64)
+
+struct cmap {
+  int fd;
+  unsigned char *base;  // the mapping, starting with the header
+  size_t length;        // bytes mapped [the length of the file]
+  size_t width;
+  cmap_advice advice;
+};
+
+// Helper function declaration
+static bool length_of(size_t width, size_t capacity, size_t *length);
+static void write_header(cmap *map, size_t size);
+static void apply_advice(const cmap *map);
+
+cmap *cmap_open(const char *path, size_t width, bool truncate,
+                size_t *size, size_t *capacity) {
+  int fd = open(path, O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+  cmap *map = malloc(sizeof(*map));
+  struct stat st;
+  if (!map || fstat(fd, &st) < 0) {
+    goto fail;
+  }
+  map->fd = fd;
+  map->width = width;
+  map->advice = CMAP_ADVICE_NORMAL;
+
+  // A new file holds room for one item
+  bool fresh = (st.st_size == 0);
+  if (fresh) {
+    length_of(width, 1, &map->length);
+    if (ftruncate(fd, (off_t) map->length) < 0) {
+      goto fail;
+    }
+  } else if ((uintmax_t) st.st_size < CMAP_HEADER_SIZE ||
+             (uintmax_t) st.st_size > SIZE_MAX) {
+    goto fail;
+  } else {
+    map->length = (size_t) st.st_size;
+  }
+
+  map->base = mmap(NULL, map->length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+  if (map->base == MAP_FAILED) {
+    goto fail;
+  }
+  if (fresh) {
+    write_header(map, 0);
+  }
+
+  cmap_header header;
+  memcpy(&header, map->base, sizeof(header));
+  *capacity = (map->length - CMAP_HEADER_SIZE) / width;
+  if (memcmp(header.magic, CMAP_MAGIC, sizeof(CMAP_MAGIC)) ||
+      header.width != width || header.size > *capacity) {
+    munmap(map->base, map->length);
+    goto fail;
+  }
+  *size = (size_t) header.size;
+
+  // A file trimmed to no items still needs room for one
+  if (*capacity == 0) {
+    if (!cmap_resize(map, 1)) {
+      munmap(map->base, map->length);
+      goto fail;
+    }
+    *capacity = 1;
+  }
+  return map;
+
+fail:
+  free(map);
+  close(fd);
+  return NULL;
+}
+
+void *cmap_data(const cmap *map) {
+  return map->base + CMAP_HEADER_SIZE;
+}
+
+bool cmap_resize(cmap *map, size_t capacity) {
+  size_t length = 0;
+  if (!length_of(map->width, capacity, &length)) {
+    return false;
+  }
+  if (length == map->length) {
+    return true;
+  }
+
+  // The file grows before the mapping does, and shrinks after it
+  if (length > map->length && ftruncate(map->fd, (off_t) length) < 0) {
+    return false;
+  }
+#ifdef MREMAP_MAYMOVE
+  void *base = mremap(map->base, map->length, length, MREMAP_MAYMOVE);
+#else
+  void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    map->fd, 0);
+  if (base != MAP_FAILED) {
+    munmap(map->base, map->length);
+  }
+#endif
+  if (base == MAP_FAILED) {
+    if (length > map->length) {
+      ftruncate(map->fd, (off_t) map->length);
+    }
+    return false;
+  }
+  if (length < map->length) {
+    ftruncate(map->fd, (off_t) length);
+  }
+
+  map->base = base;
+  map->length = length;
+  apply_advice(map);
+  return true;
+}
+
+void cmap_advise(cmap *map, cmap_advice advice) {
+  map->advice = advice;
+  apply_advice(map);
+}
+
+bool cmap_sync(cmap *map, size_t size) {
+  write_header(map, size);
+  return (msync(map->base, map->length, MS_SYNC) == 0);
+}
+
+void cmap_close(cmap *map, size_t size) {
+  if (!map) return;
+
+  write_header(map, size);
+  munmap(map->base, map->length);
+  size_t length = 0;
+  if (length_of(map->width, size, &length)) {
+    ftruncate(map->fd, (off_t) length);
+  }
+  close(map->fd);
+  free(map);
+}
+
+// Helper function implementation
+// Store the file length for capacity items of width bytes at length,
+//   producing false if it overflows
+static bool length_of(size_t width, size_t capacity, size_t *length) {
+  if (capacity > (SIZE_MAX - CMAP_HEADER_SIZE) / width) {
+    return false;
+  }
+  *length = CMAP_HEADER_SIZE + width * capacity;
+  return true;
+}
+
+static void write_header(cmap *map, size_t size) {
+  cmap_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CMAP_MAGIC, sizeof(CMAP_MAGIC));
+  header.width = map->width;
+  header.size = size;
+  memcpy(map->base, &header, sizeof(header));
+}
+
+static void apply_advice(const cmap *map) {
+  int advice = (map->advice == CMAP_ADVICE_SEQUENTIAL) ? MADV_SEQUENTIAL
+             : (map->advice == CMAP_ADVICE_RANDOM) ? MADV_RANDOM
+             : MADV_NORMAL;
+  madvise(map->base, map->length, advice);
+}
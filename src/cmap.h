@@ -0,0 +1,72 @@
+// The cmap module provides file-backed storage for the inline items of a
+//   calist. A mapped file starts with a fixed-size header recording the
+//   item size and the number of items, followed by the items themselves,
+//   so reopening a file maps its items back without copying them.
+// note: cmap is internal to the library and is not part of the public API
+//       cmap requires POSIX mmap; files are grown with ftruncate and
+//       remapped with mremap where available
+
+#ifndef CMAP_H
+#define CMAP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// A cmap is an open file mapped read-write into memory.
+typedef struct cmap cmap;
+
+// cmap_advice describes the expected access pattern of a mapping.
+typedef enum {
+  CMAP_ADVICE_NORMAL,
+  CMAP_ADVICE_SEQUENTIAL,
+  CMAP_ADVICE_RANDOM,
+} cmap_advice;
+
+// cmap_open(path, width, truncate, size, capacity) opens or creates the
+//   file at path holding items of width bytes and maps it, storing the
+//   number of items recorded in the file at size and the number of items
+//   the mapping can hold at capacity [at least 1]. If truncate is true,
+//   the existing contents of the file are discarded.
+// requires: path, size, capacity are not NULL
+//           width > 0
+// effects: may create or modify the file at path, allocates heap memory
+//          [caller must free with cmap_close]
+// note: returns NULL if the file cannot be opened or mapped, is not a
+//       cmap file, or holds items of a different width
+cmap *cmap_open(const char *path, size_t width, bool truncate,
+                size_t *size, size_t *capacity);
+
+// cmap_data(map) produces the address of the first item of map.
+// requires: map is not NULL
+// note: the address changes whenever map is resized
+void *cmap_data(const cmap *map);
+
+// cmap_resize(map, capacity) resizes the file and the mapping of map to
+//   hold capacity items, producing true on success and false otherwise
+//   [map is unchanged].
+// requires: map is not NULL
+//           capacity > 0
+// effects: modifies the file of map [items beyond capacity are lost]
+bool cmap_resize(cmap *map, size_t capacity);
+
+// cmap_advise(map, advice) passes the access pattern advice for map to
+//   the operating system, now and after every resize.
+// requires: map is not NULL
+void cmap_advise(cmap *map, cmap_advice advice);
+
+// cmap_sync(map, size) records size as the number of items of map and
+//   flushes the mapping to the file, producing true on success and false
+//   otherwise.
+// requires: map is not NULL
+//           size does not exceed the capacity of map
+// effects: modifies the file of map
+bool cmap_sync(cmap *map, size_t size);
+
+// cmap_close(map, size) records size as the number of items of map, trims
+//   the file to exactly size items, unmaps it and frees map.
+// requires: size does not exceed the capacity of map
+// effects: modifies the file of map, frees heap memory [map becomes
+//          invalid]
+void cmap_close(cmap *map, size_t size);
+
+#endif
@@ -0,0 +1,282 @@
+// pthreads and sysconf are POSIX
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cpool.h"
+#include "cerror.h"
+
+const size_t CPOOL_DEFAULT_GRAIN = 1024;
+
+// The chunks [next, end) still to be run by one thread
+typedef struct {
+  pthread_mutex_t lock;
+  size_t next;
+  size_t end;
+} chunk_range;
+
+// Thread 0 is the thread that starts a loop; threads 1 to workers are the
+//   worker threads of the pool
+struct cpool {
+  size_t workers;
+  size_t grain;
+  pthread_t *threads;
+  chunk_range *ranges;  // one per thread
+
+  pthread_mutex_t run_lock;  // held while a loop runs
+  pthread_mutex_t lock;      // guards the fields below
+  pthread_cond_t start;
+  pthread_cond_t done;
+  size_t generation;         // advanced for every loop
+  size_t busy;               // workers still running the current loop
+  bool stop;
+
+  // The current loop
+  size_t n;
+  size_t step;               // the grain size of the loop
+  cpool_body body;
+  void *ctx;
+};
+
+// A worker thread and its pool
+typedef struct {
+  cpool *pool;
+  size_t self;
+} worker_arg;
+
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+static cpool *default_pool = NULL;
+
+// Helper function declaration
+static void *worker_main(void *arg);
+static void run_chunks(cpool *pool, size_t self);
+static bool take_chunk(chunk_range *range, size_t *chunk);
+static bool steal_chunks(cpool *pool, size_t self);
+static void create_default(void);
+
+cpool *cpool_create(size_t threads) {
+  if (threads == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (online > 0) ? (size_t) online : 1;
+  }
+
+  cpool *pool = malloc(sizeof(*pool));
+  if (!pool) {
+    ALLOC_ERROR("cpool");
+  }
+  pool->workers = threads - 1;
+  pool->grain = CPOOL_DEFAULT_GRAIN;
+  pool->threads = malloc(sizeof(*pool->threads) * (pool->workers + 1));
+  pool->ranges = malloc(sizeof(*pool->ranges) * threads);
+  if (!pool->threads || !pool->ranges) {
+    ALLOC_ERROR("cpool");
+  }
+  for (size_t i = 0; i < threads; ++i) {
+    pthread_mutex_init(&pool->ranges[i].lock, NULL);
+    pool->ranges[i].next = pool->ranges[i].end = 0;
+  }
+  pthread_mutex_init(&pool->run_lock, NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->generation = 0;
+  pool->busy = 0;
+  pool->stop = false;
+  pool->n = 0;
+  pool->step = 0;
+  pool->body = NULL;
+  pool->ctx = NULL;
+
+  // Each worker frees its own argument once it has read it
+  for (size_t i = 1; i <= pool->workers; ++i) {
+    worker_arg *arg = malloc(sizeof(*arg));
+    if (!arg) {
+      ALLOC_ERROR("cpool");
+    }
+    arg->pool = pool;
+    arg->self = i;
+    if (pthread_create(&pool->threads[i], NULL, worker_main, arg)) {
+      FATAL_ERROR("Failed to start the threads of cpool!");
+    }
+  }
+  return pool;
+}
+
+void cpool_destroy(cpool *pool) {
+  if (!pool) return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 1; i <= pool->workers; ++i) {
+    pthread_join(pool->threads[i], NULL);
+  }
+
+  for (size_t i = 0; i <= pool->workers; ++i) {
+    pthread_mutex_destroy(&pool->ranges[i].lock);
+  }
+  pthread_mutex_destroy(&pool->run_lock);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  free(pool->threads);
+  free(pool->ranges);
+  free(pool);
+}
+
+cpool *cpool_default(void) {
+  pthread_once(&default_once, create_default);
+  return default_pool;
+}
+
+size_t cpool_threads(const cpool *pool) {
+  ASSERT_NOT_NULL(pool, NULL);
+  return pool->workers + 1;
+}
+
+size_t cpool_grain(const cpool *pool) {
+  ASSERT_NOT_NULL(pool, NULL);
+  return pool->grain;
+}
+
+void cpool_set_grain(cpool *pool, size_t grain) {
+  ASSERT_NOT_NULL(pool, NULL);
+  ASSERT_MSG(grain, "The grain size of cpool cannot be zero!");
+  pool->grain = grain;
+}
+
+void cpool_for(cpool *pool, size_t n, cpool_body body, void *ctx) {
+  ASSERT_NOT_NULL(pool, NULL);
+  cpool_for_grain(pool, n, pool->grain, body, ctx);
+}
+
+void cpool_for_grain(cpool *pool, size_t n, size_t grain, cpool_body body,
+                     void *ctx) {
+  ASSERT_NOT_NULL(pool, NULL);
+  ASSERT_NOT_NULL(body, NULL);
+  ASSERT_MSG(grain, "The grain size of cpool cannot be zero!");
+
+  size_t chunks = n / grain + (n % grain != 0);
+
+  // Small loops, and loops started while the pool is busy, run here
+  if (chunks <= 1 || pool->workers == 0 ||
+      pthread_mutex_trylock(&pool->run_lock)) {
+    for (size_t begin = 0; begin < n; begin += grain) {
+      body(ctx, begin, (n - begin > grain) ? begin + grain : n);
+    }
+    return;
+  }
+
+  // Every thread starts with an even share of the chunks
+  size_t threads = pool->workers + 1;
+  for (size_t i = 0; i < threads; ++i) {
+    pool->ranges[i].next = chunks * i / threads;
+    pool->ranges[i].end = chunks * (i + 1) / threads;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->n = n;
+  pool->step = grain;
+  pool->body = body;
+  pool->ctx = ctx;
+  pool->busy = pool->workers;
+  ++pool->generation;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  run_chunks(pool, 0);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->busy > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  pthread_mutex_unlock(&pool->run_lock);
+}
+
+// Helper function implementation
+static void *worker_main(void *arg) {
+  worker_arg *worker = arg;
+  cpool *pool = worker->pool;
+  size_t self = worker->self;
+  free(worker);
+
+  size_t seen = 0;
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (pool->generation == seen && !pool->stop) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->stop) break;
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    run_chunks(pool, self);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->busy == 0) {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+// Run chunks of the current loop on thread self until none are left
+static void run_chunks(cpool *pool, size_t self) {
+  size_t grain = pool->step;
+  size_t n = pool->n;
+  size_t chunk = 0;
+  for (;;) {
+    if (!take_chunk(&pool->ranges[self], &chunk)) {
+      if (!steal_chunks(pool, self)) return;
+      continue;
+    }
+    size_t begin = chunk * grain;
+    pool->body(pool->ctx, begin, (n - begin > grain) ? begin + grain : n);
+  }
+}
+
+// Take the next chunk of range, producing false if range is empty
+static bool take_chunk(chunk_range *range, size_t *chunk) {
+  pthread_mutex_lock(&range->lock);
+  bool taken = range->next < range->end;
+  if (taken) {
+    *chunk = range->next++;
+  }
+  pthread_mutex_unlock(&range->lock);
+  return taken;
+}
+
+// Move the second half of the chunks of another thread to the empty range
+//   of thread self, producing false if no thread has chunks left
+static bool steal_chunks(cpool *pool, size_t self) {
+  size_t threads = pool->workers + 1;
+  for (size_t i = 1; i < threads; ++i) {
+    chunk_range *victim = &pool->ranges[(self + i) % threads];
+    pthread_mutex_lock(&victim->lock);
+    size_t left = victim->end - victim->next;
+    if (left > 0) {
+      size_t stolen = (left + 1) / 2;
+      victim->end -= stolen;
+      size_t from = victim->end;
+      pthread_mutex_unlock(&victim->lock);
+
+      chunk_range *own = &pool->ranges[self];
+      pthread_mutex_lock(&own->lock);
+      own->next = from;
+      own->end = from + stolen;
+      pthread_mutex_unlock(&own->lock);
+      return true;
+    }
+    pthread_mutex_unlock(&victim->lock);
+  }
+  return false;
+}
+
+static void create_default(void) {
+  default_pool = cpool_create(0);
+}
@@ -0,0 +1,560 @@
+#include "csimd.h"
+
+#ifdef CSIMD_AVAILABLE
+
+#if defined(CSIMD_X86)
+#include <immintrin.h>
+#elif defined(CSIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// Vectors per count block; keeps 32-bit lane counters from overflowing
+#define COUNT_BLOCK ((size_t) 1 << 20)
+
+// Scalar comparisons matching the built-in ctype cmp methods
+#define EQ_INT(a, b) ((a) == (b))
+#define EQ_FLT(a, b) (!((a) < (b)) && !((a) > (b)))
+#define EQ_ORD(a, b) ((a) == (b))
+#define IS_NAN(a) ((a) != (a))
+#define NOT_NAN(a) ((void) (a), 0)
+#define LESS(a, b) ((a) < (b))
+#define GREATER(a, b) ((a) > (b))
+
+// Helper function declaration
+// DEFINE_FIND(name, attr, T, V, N, LOAD, SET1, EQ, MOVEMASK, SEQ) defines
+//   name(base, n, value) producing the first index of value in base[0..n)
+//   where EQ compares N lanes of vector type V and SEQ compares scalars
+#define DEFINE_FIND(name, attr, T, V, N, LOAD, SET1, EQ, MOVEMASK, SEQ) \
+  attr static size_t name(const T *base, size_t n, T value) { \
+    V v = SET1(value); \
+    size_t i = 0; \
+    for (; i + (N) <= n; i += (N)) { \
+      V x = LOAD(base + i); \
+      unsigned mask = (unsigned) MOVEMASK(EQ(x, v)); \
+      if (mask) return i + (size_t) __builtin_ctz(mask); \
+    } \
+    for (; i < n; ++i) { \
+      if (SEQ(base[i], value)) return i; \
+    } \
+    return n; \
+  }
+
+// DEFINE_FIND_LAST(...) defines name(base, n, value) producing the last
+//   index of value in base[0..n) [see DEFINE_FIND]
+#define DEFINE_FIND_LAST(name, attr, T, V, N, LOAD, SET1, EQ, MOVEMASK, \
+                         SEQ) \
+  attr static size_t name(const T *base, size_t n, T value) { \
+    V v = SET1(value); \
+    size_t i = n - n % (N); \
+    for (size_t j = n; j > i;) { \
+      --j; \
+      if (SEQ(base[j], value)) return j; \
+    } \
+    while (i > 0) { \
+      i -= (N); \
+      V x = LOAD(base + i); \
+      unsigned mask = (unsigned) MOVEMASK(EQ(x, v)); \
+      if (mask) { \
+        return i + (size_t) (31 - __builtin_clz(mask)); \
+      } \
+    } \
+    return n; \
+  }
+
+// DEFINE_COUNT(...) defines name(base, n, value) producing the number of
+//   occurrences of value in base[0..n); equality masks (all bits set) are
+//   subtracted from the lane counters of vector type A
+#define DEFINE_COUNT(name, attr, T, V, A, N, LOAD, SET1, EQ, ZERO, SUB, \
+                     REDUCE, SEQ) \
+  attr static size_t name(const T *base, size_t n, T value) { \
+    V v = SET1(value); \
+    size_t total = 0; \
+    size_t i = 0; \
+    while (i + (N) <= n) { \
+      size_t vectors = (n - i) / (N); \
+      if (vectors > COUNT_BLOCK) vectors = COUNT_BLOCK; \
+      A acc = ZERO(); \
+      for (size_t k = 0; k < vectors; ++k, i += (N)) { \
+        V x = LOAD(base + i); \
+        acc = SUB(acc, EQ(x, v)); \
+      } \
+      total += REDUCE(acc); \
+    } \
+    for (; i < n; ++i) { \
+      total += SEQ(base[i], value); \
+    } \
+    return total; \
+  }
+
+// DEFINE_BEST(...) defines name(base, n) producing the first index of the
+//   smallest (or largest, per BETTER) value in base[0..n); a lane is only
+//   replaced by a strictly better value, so NaN never replaces a lane, and
+//   the index is then located with the ordered equality find FIND
+#define DEFINE_BEST(name, attr, T, V, N, LOAD, SET1, SELECT, STORE, \
+                    BETTER, FIND, ISNAN) \
+  attr static size_t name(const T *base, size_t n) { \
+    if (ISNAN(base[0])) return 0; \
+    V best = SET1(base[0]); \
+    size_t i = 0; \
+    for (; i + (N) <= n; i += (N)) { \
+      V x = LOAD(base + i); \
+      best = SELECT(x, best); \
+    } \
+    T lanes[N]; \
+    STORE(lanes, best); \
+    T value = lanes[0]; \
+    for (size_t k = 1; k < (N); ++k) { \
+      if (BETTER(lanes[k], value)) value = lanes[k]; \
+    } \
+    for (; i < n; ++i) { \
+      if (BETTER(base[i], value)) value = base[i]; \
+    } \
+    return FIND(base, n, value); \
+  }
+
+// Scalar min/max for lanes without a vector compare
+#define DEFINE_BEST_SCALAR(name, T, BETTER) \
+  static size_t name(const T *base, size_t n) { \
+    size_t best = 0; \
+    for (size_t i = 1; i < n; ++i) { \
+      if (BETTER(base[i], base[best])) best = i; \
+    } \
+    return best; \
+  }
+
+#if defined(CSIMD_X86)
+
+#define ATTR_NONE
+#define ATTR_AVX2 __attribute__((target("avx2")))
+
+static int has_avx2(void) {
+  return __builtin_cpu_supports("avx2");
+}
+
+// === SSE2 primitives ===
+#define SSE2_LOAD_I(p) _mm_loadu_si128((const __m128i *) (const void *) (p))
+#define SSE2_SET1_I32(x) _mm_set1_epi32(x)
+#define SSE2_SET1_I64(x) _mm_set1_epi64x(x)
+#define SSE2_EQ_I32(x, v) _mm_cmpeq_epi32(x, v)
+#define SSE2_EQ_I64(x, v) sse2_eq_i64(x, v)
+#define SSE2_MASK_32(m) _mm_movemask_ps(_mm_castsi128_ps(m))
+#define SSE2_MASK_64(m) _mm_movemask_pd(_mm_castsi128_pd(m))
+#define SSE2_ZERO() _mm_setzero_si128()
+#define SSE2_SUB_32(a, m) _mm_sub_epi32(a, m)
+#define SSE2_SUB_64(a, m) _mm_sub_epi64(a, m)
+#define SSE2_STORE_I(p, x) _mm_storeu_si128((__m128i *) (void *) (p), x)
+
+#define SSE2_LOAD_F32(p) _mm_loadu_ps(p)
+#define SSE2_LOAD_F64(p) _mm_loadu_pd(p)
+#define SSE2_SET1_F32(x) _mm_set1_ps(x)
+#define SSE2_SET1_F64(x) _mm_set1_pd(x)
+#define SSE2_EQ_F32(x, v) \
+  _mm_castps_si128(_mm_or_ps(_mm_cmpeq_ps(x, v), _mm_cmpunord_ps(x, v)))
+#define SSE2_EQ_F64(x, v) \
+  _mm_castpd_si128(_mm_or_pd(_mm_cmpeq_pd(x, v), _mm_cmpunord_pd(x, v)))
+#define SSE2_OEQ_F32(x, v) _mm_castps_si128(_mm_cmpeq_ps(x, v))
+#define SSE2_OEQ_F64(x, v) _mm_castpd_si128(_mm_cmpeq_pd(x, v))
+#define SSE2_STORE_F32(p, x) _mm_storeu_ps(p, x)
+#define SSE2_STORE_F64(p, x) _mm_storeu_pd(p, x)
+
+static inline __m128i sse2_eq_i64(__m128i x, __m128i v) {
+  // Both 32-bit halves of a 64-bit lane must be equal
+  __m128i eq = _mm_cmpeq_epi32(x, v);
+  return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static inline __m128i sse2_select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline size_t sse2_reduce_32(__m128i acc) {
+  uint32_t lanes[4];
+  SSE2_STORE_I(lanes, acc);
+  return (size_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static inline size_t sse2_reduce_64(__m128i acc) {
+  uint64_t lanes[2];
+  SSE2_STORE_I(lanes, acc);
+  return (size_t) (lanes[0] + lanes[1]);
+}
+
+#define SSE2_MIN_I32(x, m) sse2_select(_mm_cmplt_epi32(x, m), x, m)
+#define SSE2_MAX_I32(x, m) sse2_select(_mm_cmpgt_epi32(x, m), x, m)
+#define SSE2_MIN_F32(x, m) sse2_select_ps(_mm_cmplt_ps(x, m), x, m)
+#define SSE2_MAX_F32(x, m) sse2_select_ps(_mm_cmpgt_ps(x, m), x, m)
+#define SSE2_MIN_F64(x, m) sse2_select_pd(_mm_cmplt_pd(x, m), x, m)
+#define SSE2_MAX_F64(x, m) sse2_select_pd(_mm_cmpgt_pd(x, m), x, m)
+
+static inline __m128 sse2_select_ps(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128d sse2_select_pd(__m128d mask, __m128d a, __m128d b) {
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+// === AVX2 primitives ===
+#define AVX2_LOAD_I(p) \
+  _mm256_loadu_si256((const __m256i *) (const void *) (p))
+#define AVX2_SET1_I32(x) _mm256_set1_epi32(x)
+#define AVX2_SET1_I64(x) _mm256_set1_epi64x(x)
+#define AVX2_EQ_I32(x, v) _mm256_cmpeq_epi32(x, v)
+#define AVX2_EQ_I64(x, v) _mm256_cmpeq_epi64(x, v)
+#define AVX2_MASK_32(m) _mm256_movemask_ps(_mm256_castsi256_ps(m))
+#define AVX2_MASK_64(m) _mm256_movemask_pd(_mm256_castsi256_pd(m))
+#define AVX2_ZERO() _mm256_setzero_si256()
+#define AVX2_SUB_32(a, m) _mm256_sub_epi32(a, m)
+#define AVX2_SUB_64(a, m) _mm256_sub_epi64(a, m)
+#define AVX2_STORE_I(p, x) _mm256_storeu_si256((__m256i *) (void *) (p), x)
+
+#define AVX2_LOAD_F32(p) _mm256_loadu_ps(p)
+#define AVX2_LOAD_F64(p) _mm256_loadu_pd(p)
+#define AVX2_SET1_F32(x) _mm256_set1_ps(x)
+#define AVX2_SET1_F64(x) _mm256_set1_pd(x)
+#define AVX2_EQ_F32(x, v) _mm256_castps_si256(_mm256_cmp_ps(x, v, _CMP_EQ_UQ))
+#define AVX2_EQ_F64(x, v) _mm256_castpd_si256(_mm256_cmp_pd(x, v, _CMP_EQ_UQ))
+#define AVX2_OEQ_F32(x, v) \
+  _mm256_castps_si256(_mm256_cmp_ps(x, v, _CMP_EQ_OQ))
+#define AVX2_OEQ_F64(x, v) \
+  _mm256_castpd_si256(_mm256_cmp_pd(x, v, _CMP_EQ_OQ))
+#define AVX2_STORE_F32(p, x) _mm256_storeu_ps(p, x)
+#define AVX2_STORE_F64(p, x) _mm256_storeu_pd(p, x)
+
+#define AVX2_MIN_I32(x, m) _mm256_min_epi32(x, m)
+#define AVX2_MAX_I32(x, m) _mm256_max_epi32(x, m)
+#define AVX2_MIN_I64(x, m) \
+  _mm256_blendv_epi8(m, x, _mm256_cmpgt_epi64(m, x))
+#define AVX2_MAX_I64(x, m) \
+  _mm256_blendv_epi8(m, x, _mm256_cmpgt_epi64(x, m))
+#define AVX2_MIN_F32(x, m) \
+  _mm256_blendv_ps(m, x, _mm256_cmp_ps(x, m, _CMP_LT_OQ))
+#define AVX2_MAX_F32(x, m) \
+  _mm256_blendv_ps(m, x, _mm256_cmp_ps(x, m, _CMP_GT_OQ))
+#define AVX2_MIN_F64(x, m) \
+  _mm256_blendv_pd(m, x, _mm256_cmp_pd(x, m, _CMP_LT_OQ))
+#define AVX2_MAX_F64(x, m) \
+  _mm256_blendv_pd(m, x, _mm256_cmp_pd(x, m, _CMP_GT_OQ))
+
+ATTR_AVX2 static inline size_t avx2_reduce_32(__m256i acc) {
+  uint32_t lanes[8];
+  AVX2_STORE_I(lanes, acc);
+  size_t total = 0;
+  for (int k = 0; k < 8; ++k) {
+    total += lanes[k];
+  }
+  return total;
+}
+
+ATTR_AVX2 static inline size_t avx2_reduce_64(__m256i acc) {
+  uint64_t lanes[4];
+  AVX2_STORE_I(lanes, acc);
+  return (size_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+// === SSE2 kernels ===
+DEFINE_FIND(find_i32_sse2, ATTR_NONE, int32_t, __m128i, 4, SSE2_LOAD_I,
+            SSE2_SET1_I32, SSE2_EQ_I32, SSE2_MASK_32, EQ_INT)
+DEFINE_FIND(find_i64_sse2, ATTR_NONE, int64_t, __m128i, 2, SSE2_LOAD_I,
+            SSE2_SET1_I64, SSE2_EQ_I64, SSE2_MASK_64, EQ_INT)
+DEFINE_FIND(find_f32_sse2, ATTR_NONE, float, __m128, 4, SSE2_LOAD_F32,
+            SSE2_SET1_F32, SSE2_EQ_F32, SSE2_MASK_32, EQ_FLT)
+DEFINE_FIND(find_f64_sse2, ATTR_NONE, double, __m128d, 2, SSE2_LOAD_F64,
+            SSE2_SET1_F64, SSE2_EQ_F64, SSE2_MASK_64, EQ_FLT)
+DEFINE_FIND(ofind_f32_sse2, ATTR_NONE, float, __m128, 4, SSE2_LOAD_F32,
+            SSE2_SET1_F32, SSE2_OEQ_F32, SSE2_MASK_32, EQ_ORD)
+DEFINE_FIND(ofind_f64_sse2, ATTR_NONE, double, __m128d, 2, SSE2_LOAD_F64,
+            SSE2_SET1_F64, SSE2_OEQ_F64, SSE2_MASK_64, EQ_ORD)
+
+DEFINE_FIND_LAST(find_last_i32_sse2, ATTR_NONE, int32_t, __m128i, 4,
+                 SSE2_LOAD_I, SSE2_SET1_I32, SSE2_EQ_I32, SSE2_MASK_32,
+                 EQ_INT)
+DEFINE_FIND_LAST(find_last_i64_sse2, ATTR_NONE, int64_t, __m128i, 2,
+                 SSE2_LOAD_I, SSE2_SET1_I64, SSE2_EQ_I64, SSE2_MASK_64,
+                 EQ_INT)
+DEFINE_FIND_LAST(find_last_f32_sse2, ATTR_NONE, float, __m128, 4,
+                 SSE2_LOAD_F32, SSE2_SET1_F32, SSE2_EQ_F32, SSE2_MASK_32,
+                 EQ_FLT)
+DEFINE_FIND_LAST(find_last_f64_sse2, ATTR_NONE, double, __m128d, 2,
+                 SSE2_LOAD_F64, SSE2_SET1_F64, SSE2_EQ_F64, SSE2_MASK_64,
+                 EQ_FLT)
+
+DEFINE_COUNT(count_i32_sse2, ATTR_NONE, int32_t, __m128i, __m128i, 4,
+             SSE2_LOAD_I, SSE2_SET1_I32, SSE2_EQ_I32, SSE2_ZERO,
+             SSE2_SUB_32, sse2_reduce_32, EQ_INT)
+DEFINE_COUNT(count_i64_sse2, ATTR_NONE, int64_t, __m128i, __m128i, 2,
+             SSE2_LOAD_I, SSE2_SET1_I64, SSE2_EQ_I64, SSE2_ZERO,
+             SSE2_SUB_64, sse2_reduce_64, EQ_INT)
+DEFINE_COUNT(count_f32_sse2, ATTR_NONE, float, __m128, __m128i, 4,
+             SSE2_LOAD_F32, SSE2_SET1_F32, SSE2_EQ_F32, SSE2_ZERO,
+             SSE2_SUB_32, sse2_reduce_32, EQ_FLT)
+DEFINE_COUNT(count_f64_sse2, ATTR_NONE, double, __m128d, __m128i, 2,
+             SSE2_LOAD_F64, SSE2_SET1_F64, SSE2_EQ_F64, SSE2_ZERO,
+             SSE2_SUB_64, sse2_reduce_64, EQ_FLT)
+
+DEFINE_BEST(min_i32_sse2, ATTR_NONE, int32_t, __m128i, 4, SSE2_LOAD_I,
+            SSE2_SET1_I32, SSE2_MIN_I32, SSE2_STORE_I, LESS, find_i32_sse2,
+            NOT_NAN)
+DEFINE_BEST(max_i32_sse2, ATTR_NONE, int32_t, __m128i, 4, SSE2_LOAD_I,
+            SSE2_SET1_I32, SSE2_MAX_I32, SSE2_STORE_I, GREATER,
+            find_i32_sse2, NOT_NAN)
+DEFINE_BEST(min_f32_sse2, ATTR_NONE, float, __m128, 4, SSE2_LOAD_F32,
+            SSE2_SET1_F32, SSE2_MIN_F32, SSE2_STORE_F32, LESS,
+            ofind_f32_sse2, IS_NAN)
+DEFINE_BEST(max_f32_sse2, ATTR_NONE, float, __m128, 4, SSE2_LOAD_F32,
+            SSE2_SET1_F32, SSE2_MAX_F32, SSE2_STORE_F32, GREATER,
+            ofind_f32_sse2, IS_NAN)
+DEFINE_BEST(min_f64_sse2, ATTR_NONE, double, __m128d, 2, SSE2_LOAD_F64,
+            SSE2_SET1_F64, SSE2_MIN_F64, SSE2_STORE_F64, LESS,
+            ofind_f64_sse2, IS_NAN)
+DEFINE_BEST(max_f64_sse2, ATTR_NONE, double, __m128d, 2, SSE2_LOAD_F64,
+            SSE2_SET1_F64, SSE2_MAX_F64, SSE2_STORE_F64, GREATER,
+            ofind_f64_sse2, IS_NAN)
+// SSE2 has no 64-bit integer ordering compare
+DEFINE_BEST_SCALAR(min_i64_sse2, int64_t, LESS)
+DEFINE_BEST_SCALAR(max_i64_sse2, int64_t, GREATER)
+
+// === AVX2 kernels ===
+DEFINE_FIND(find_i32_avx2, ATTR_AVX2, int32_t, __m256i, 8, AVX2_LOAD_I,
+            AVX2_SET1_I32, AVX2_EQ_I32, AVX2_MASK_32, EQ_INT)
+DEFINE_FIND(find_i64_avx2, ATTR_AVX2, int64_t, __m256i, 4, AVX2_LOAD_I,
+            AVX2_SET1_I64, AVX2_EQ_I64, AVX2_MASK_64, EQ_INT)
+DEFINE_FIND(find_f32_avx2, ATTR_AVX2, float, __m256, 8, AVX2_LOAD_F32,
+            AVX2_SET1_F32, AVX2_EQ_F32, AVX2_MASK_32, EQ_FLT)
+DEFINE_FIND(find_f64_avx2, ATTR_AVX2, double, __m256d, 4, AVX2_LOAD_F64,
+            AVX2_SET1_F64, AVX2_EQ_F64, AVX2_MASK_64, EQ_FLT)
+DEFINE_FIND(ofind_f32_avx2, ATTR_AVX2, float, __m256, 8, AVX2_LOAD_F32,
+            AVX2_SET1_F32, AVX2_OEQ_F32, AVX2_MASK_32, EQ_ORD)
+DEFINE_FIND(ofind_f64_avx2, ATTR_AVX2, double, __m256d, 4, AVX2_LOAD_F64,
+            AVX2_SET1_F64, AVX2_OEQ_F64, AVX2_MASK_64, EQ_ORD)
+
+DEFINE_FIND_LAST(find_last_i32_avx2, ATTR_AVX2, int32_t, __m256i, 8,
+                 AVX2_LOAD_I, AVX2_SET1_I32, AVX2_EQ_I32, AVX2_MASK_32,
+                 EQ_INT)
+DEFINE_FIND_LAST(find_last_i64_avx2, ATTR_AVX2, int64_t, __m256i, 4,
+                 AVX2_LOAD_I, AVX2_SET1_I64, AVX2_EQ_I64, AVX2_MASK_64,
+                 EQ_INT)
+DEFINE_FIND_LAST(find_last_f32_avx2, ATTR_AVX2, float, __m256, 8,
+                 AVX2_LOAD_F32, AVX2_SET1_F32, AVX2_EQ_F32, AVX2_MASK_32,
+                 EQ_FLT)
+DEFINE_FIND_LAST(find_last_f64_avx2, ATTR_AVX2, double, __m256d, 4,
+                 AVX2_LOAD_F64, AVX2_SET1_F64, AVX2_EQ_F64, AVX2_MASK_64,
+                 EQ_FLT)
+
+DEFINE_COUNT(count_i32_avx2, ATTR_AVX2, int32_t, __m256i, __m256i, 8,
+             AVX2_LOAD_I, AVX2_SET1_I32, AVX2_EQ_I32, AVX2_ZERO,
+             AVX2_SUB_32, avx2_reduce_32, EQ_INT)
+DEFINE_COUNT(count_i64_avx2, ATTR_AVX2, int64_t, __m256i, __m256i, 4,
+             AVX2_LOAD_I, AVX2_SET1_I64, AVX2_EQ_I64, AVX2_ZERO,
+             AVX2_SUB_64, avx2_reduce_64, EQ_INT)
+DEFINE_COUNT(count_f32_avx2, ATTR_AVX2, float, __m256, __m256i, 8,
+             AVX2_LOAD_F32, AVX2_SET1_F32, AVX2_EQ_F32, AVX2_ZERO,
+             AVX2_SUB_32, avx2_reduce_32, EQ_FLT)
+DEFINE_COUNT(count_f64_avx2, ATTR_AVX2, double, __m256d, __m256i, 4,
+             AVX2_LOAD_F64, AVX2_SET1_F64, AVX2_EQ_F64, AVX2_ZERO,
+             AVX2_SUB_64, avx2_reduce_64, EQ_FLT)
+
+DEFINE_BEST(min_i32_avx2, ATTR_AVX2, int32_t, __m256i, 8, AVX2_LOAD_I,
+            AVX2_SET1_I32, AVX2_MIN_I32, AVX2_STORE_I, LESS, find_i32_avx2,
+            NOT_NAN)
+DEFINE_BEST(max_i32_avx2, ATTR_AVX2, int32_t, __m256i, 8, AVX2_LOAD_I,
+            AVX2_SET1_I32, AVX2_MAX_I32, AVX2_STORE_I, GREATER,
+            find_i32_avx2, NOT_NAN)
+DEFINE_BEST(min_i64_avx2, ATTR_AVX2, int64_t, __m256i, 4, AVX2_LOAD_I,
+            AVX2_SET1_I64, AVX2_MIN_I64, AVX2_STORE_I, LESS, find_i64_avx2,
+            NOT_NAN)
+DEFINE_BEST(max_i64_avx2, ATTR_AVX2, int64_t, __m256i, 4, AVX2_LOAD_I,
+            AVX2_SET1_I64, AVX2_MAX_I64, AVX2_STORE_I, GREATER,
+            find_i64_avx2, NOT_NAN)
+DEFINE_BEST(min_f32_avx2, ATTR_AVX2, float, __m256, 8, AVX2_LOAD_F32,
+            AVX2_SET1_F32, AVX2_MIN_F32, AVX2_STORE_F32, LESS,
+            ofind_f32_avx2, IS_NAN)
+DEFINE_BEST(max_f32_avx2, ATTR_AVX2, float, __m256, 8, AVX2_LOAD_F32,
+            AVX2_SET1_F32, AVX2_MAX_F32, AVX2_STORE_F32, GREATER,
+            ofind_f32_avx2, IS_NAN)
+DEFINE_BEST(min_f64_avx2, ATTR_AVX2, double, __m256d, 4, AVX2_LOAD_F64,
+            AVX2_SET1_F64, AVX2_MIN_F64, AVX2_STORE_F64, LESS,
+            ofind_f64_avx2, IS_NAN)
+DEFINE_BEST(max_f64_avx2, ATTR_AVX2, double, __m256d, 4, AVX2_LOAD_F64,
+            AVX2_SET1_F64, AVX2_MAX_F64, AVX2_STORE_F64, GREATER,
+            ofind_f64_avx2, IS_NAN)
+
+// DEFINE_DISPATCH(name, params, args) defines csimd_<name>, which runs
+//   the AVX2 kernel if supported and the SSE2 kernel otherwise
+#define DEFINE_DISPATCH(name, params, args) \
+  size_t csimd_##name params { \
+    return has_avx2() ? name##_avx2 args : name##_sse2 args; \
+  }
+
+#elif defined(CSIMD_NEON)
+
+#define ATTR_NONE
+
+// === NEON primitives ===
+#define NEON_LOAD_I32(p) vld1q_s32(p)
+#define NEON_LOAD_I64(p) vld1q_s64(p)
+#define NEON_LOAD_F32(p) vld1q_f32(p)
+#define NEON_LOAD_F64(p) vld1q_f64(p)
+#define NEON_SET1_I32(x) vdupq_n_s32(x)
+#define NEON_SET1_I64(x) vdupq_n_s64(x)
+#define NEON_SET1_F32(x) vdupq_n_f32(x)
+#define NEON_SET1_F64(x) vdupq_n_f64(x)
+#define NEON_EQ_I32(x, v) vceqq_s32(x, v)
+#define NEON_EQ_I64(x, v) vceqq_s64(x, v)
+#define NEON_EQ_F32(x, v) \
+  vmvnq_u32(vorrq_u32(vcltq_f32(x, v), vcgtq_f32(x, v)))
+#define NEON_EQ_F64(x, v) \
+  veorq_u64(vorrq_u64(vcltq_f64(x, v), vcgtq_f64(x, v)), \
+            vdupq_n_u64(~(uint64_t) 0))
+#define NEON_OEQ_F32(x, v) vceqq_f32(x, v)
+#define NEON_OEQ_F64(x, v) vceqq_f64(x, v)
+#define NEON_MASK_32(m) neon_mask_32(m)
+#define NEON_MASK_64(m) neon_mask_64(m)
+#define NEON_ZERO_32() vdupq_n_u32(0)
+#define NEON_ZERO_64() vdupq_n_u64(0)
+#define NEON_SUB_32(a, m) vsubq_u32(a, m)
+#define NEON_SUB_64(a, m) vsubq_u64(a, m)
+#define NEON_REDUCE_32(a) ((size_t) vaddvq_u32(a))
+#define NEON_REDUCE_64(a) ((size_t) vaddvq_u64(a))
+#define NEON_STORE_I32(p, x) vst1q_s32(p, x)
+#define NEON_STORE_I64(p, x) vst1q_s64(p, x)
+#define NEON_STORE_F32(p, x) vst1q_f32(p, x)
+#define NEON_STORE_F64(p, x) vst1q_f64(p, x)
+
+#define NEON_MIN_I32(x, m) vminq_s32(x, m)
+#define NEON_MAX_I32(x, m) vmaxq_s32(x, m)
+#define NEON_MIN_I64(x, m) vbslq_s64(vcltq_s64(x, m), x, m)
+#define NEON_MAX_I64(x, m) vbslq_s64(vcgtq_s64(x, m), x, m)
+#define NEON_MIN_F32(x, m) vbslq_f32(vcltq_f32(x, m), x, m)
+#define NEON_MAX_F32(x, m) vbslq_f32(vcgtq_f32(x, m), x, m)
+#define NEON_MIN_F64(x, m) vbslq_f64(vcltq_f64(x, m), x, m)
+#define NEON_MAX_F64(x, m) vbslq_f64(vcgtq_f64(x, m), x, m)
+
+static inline unsigned neon_mask_32(uint32x4_t m) {
+  static const uint32_t bits[4] = { 1, 2, 4, 8 };
+  return vaddvq_u32(vandq_u32(m, vld1q_u32(bits)));
+}
+
+static inline unsigned neon_mask_64(uint64x2_t m) {
+  static const uint64_t bits[2] = { 1, 2 };
+  return (unsigned) vaddvq_u64(vandq_u64(m, vld1q_u64(bits)));
+}
+
+// === NEON kernels ===
+DEFINE_FIND(find_i32_neon, ATTR_NONE, int32_t, int32x4_t, 4, NEON_LOAD_I32,
+            NEON_SET1_I32, NEON_EQ_I32, NEON_MASK_32, EQ_INT)
+DEFINE_FIND(find_i64_neon, ATTR_NONE, int64_t, int64x2_t, 2, NEON_LOAD_I64,
+            NEON_SET1_I64, NEON_EQ_I64, NEON_MASK_64, EQ_INT)
+DEFINE_FIND(find_f32_neon, ATTR_NONE, float, float32x4_t, 4, NEON_LOAD_F32,
+            NEON_SET1_F32, NEON_EQ_F32, NEON_MASK_32, EQ_FLT)
+DEFINE_FIND(find_f64_neon, ATTR_NONE, double, float64x2_t, 2,
+            NEON_LOAD_F64, NEON_SET1_F64, NEON_EQ_F64, NEON_MASK_64, EQ_FLT)
+DEFINE_FIND(ofind_f32_neon, ATTR_NONE, float, float32x4_t, 4,
+            NEON_LOAD_F32, NEON_SET1_F32, NEON_OEQ_F32, NEON_MASK_32, EQ_ORD)
+DEFINE_FIND(ofind_f64_neon, ATTR_NONE, double, float64x2_t, 2,
+            NEON_LOAD_F64, NEON_SET1_F64, NEON_OEQ_F64, NEON_MASK_64, EQ_ORD)
+
+DEFINE_FIND_LAST(find_last_i32_neon, ATTR_NONE, int32_t, int32x4_t, 4,
+                 NEON_LOAD_I32, NEON_SET1_I32, NEON_EQ_I32, NEON_MASK_32,
+                 EQ_INT)
+DEFINE_FIND_LAST(find_last_i64_neon, ATTR_NONE, int64_t, int64x2_t, 2,
+                 NEON_LOAD_I64, NEON_SET1_I64, NEON_EQ_I64, NEON_MASK_64,
+                 EQ_INT)
+DEFINE_FIND_LAST(find_last_f32_neon, ATTR_NONE, float, float32x4_t, 4,
+                 NEON_LOAD_F32, NEON_SET1_F32, NEON_EQ_F32, NEON_MASK_32,
+                 EQ_FLT)
+DEFINE_FIND_LAST(find_last_f64_neon, ATTR_NONE, double, float64x2_t, 2,
+                 NEON_LOAD_F64, NEON_SET1_F64, NEON_EQ_F64, NEON_MASK_64,
+                 EQ_FLT)
+
+DEFINE_COUNT(count_i32_neon, ATTR_NONE, int32_t, int32x4_t, uint32x4_t, 4,
+             NEON_LOAD_I32, NEON_SET1_I32, NEON_EQ_I32, NEON_ZERO_32,
+             NEON_SUB_32, NEON_REDUCE_32, EQ_INT)
+DEFINE_COUNT(count_i64_neon, ATTR_NONE, int64_t, int64x2_t, uint64x2_t, 2,
+             NEON_LOAD_I64, NEON_SET1_I64, NEON_EQ_I64, NEON_ZERO_64,
+             NEON_SUB_64, NEON_REDUCE_64, EQ_INT)
+DEFINE_COUNT(count_f32_neon, ATTR_NONE, float, float32x4_t, uint32x4_t, 4,
+             NEON_LOAD_F32, NEON_SET1_F32, NEON_EQ_F32, NEON_ZERO_32,
+             NEON_SUB_32, NEON_REDUCE_32, EQ_FLT)
+DEFINE_COUNT(count_f64_neon, ATTR_NONE, double, float64x2_t, uint64x2_t, 2,
+             NEON_LOAD_F64, NEON_SET1_F64, NEON_EQ_F64, NEON_ZERO_64,
+             NEON_SUB_64, NEON_REDUCE_64, EQ_FLT)
+
+DEFINE_BEST(min_i32_neon, ATTR_NONE, int32_t, int32x4_t, 4, NEON_LOAD_I32,
+            NEON_SET1_I32, NEON_MIN_I32, NEON_STORE_I32, LESS,
+            find_i32_neon, NOT_NAN)
+DEFINE_BEST(max_i32_neon, ATTR_NONE, int32_t, int32x4_t, 4, NEON_LOAD_I32,
+            NEON_SET1_I32, NEON_MAX_I32, NEON_STORE_I32, GREATER,
+            find_i32_neon, NOT_NAN)
+DEFINE_BEST(min_i64_neon, ATTR_NONE, int64_t, int64x2_t, 2, NEON_LOAD_I64,
+            NEON_SET1_I64, NEON_MIN_I64, NEON_STORE_I64, LESS,
+            find_i64_neon, NOT_NAN)
+DEFINE_BEST(max_i64_neon, ATTR_NONE, int64_t, int64x2_t, 2, NEON_LOAD_I64,
+            NEON_SET1_I64, NEON_MAX_I64, NEON_STORE_I64, GREATER,
+            find_i64_neon, NOT_NAN)
+DEFINE_BEST(min_f32_neon, ATTR_NONE, float, float32x4_t, 4, NEON_LOAD_F32,
+            NEON_SET1_F32, NEON_MIN_F32, NEON_STORE_F32, LESS,
+            ofind_f32_neon, IS_NAN)
+DEFINE_BEST(max_f32_neon, ATTR_NONE, float, float32x4_t, 4, NEON_LOAD_F32,
+            NEON_SET1_F32, NEON_MAX_F32, NEON_STORE_F32, GREATER,
+            ofind_f32_neon, IS_NAN)
+DEFINE_BEST(min_f64_neon, ATTR_NONE, double, float64x2_t, 2,
+            NEON_LOAD_F64, NEON_SET1_F64, NEON_MIN_F64, NEON_STORE_F64,
+            LESS, ofind_f64_neon, IS_NAN)
+DEFINE_BEST(max_f64_neon, ATTR_NONE, double, float64x2_t, 2,
+            NEON_LOAD_F64, NEON_SET1_F64, NEON_MAX_F64, NEON_STORE_F64,
+            GREATER, ofind_f64_neon, IS_NAN)
+
+// NEON is part of the AArch64 baseline, so there is nothing to detect
+#define DEFINE_DISPATCH(name, params, args) \
+  size_t csimd_##name params { \
+    return name##_neon args; \
+  }
+
+#endif
+
+DEFINE_DISPATCH(find_i32, (const int32_t *base, size_t n, int32_t value),
+                (base, n, value))
+DEFINE_DISPATCH(find_i64, (const int64_t *base, size_t n, int64_t value),
+                (base, n, value))
+DEFINE_DISPATCH(find_f32, (const float *base, size_t n, float value),
+                (base, n, value))
+DEFINE_DISPATCH(find_f64, (const double *base, size_t n, double value),
+                (base, n, value))
+
+DEFINE_DISPATCH(find_last_i32,
+                (const int32_t *base, size_t n, int32_t value),
+                (base, n, value))
+DEFINE_DISPATCH(find_last_i64,
+                (const int64_t *base, size_t n, int64_t value),
+                (base, n, value))
+DEFINE_DISPATCH(find_last_f32, (const float *base, size_t n, float value),
+                (base, n, value))
+DEFINE_DISPATCH(find_last_f64,
+                (const double *base, size_t n, double value),
+                (base, n, value))
+
+DEFINE_DISPATCH(count_i32, (const int32_t *base, size_t n, int32_t value),
+                (base, n, value))
+DEFINE_DISPATCH(count_i64, (const int64_t *base, size_t n, int64_t value),
+                (base, n, value))
+DEFINE_DISPATCH(count_f32, (const float *base, size_t n, float value),
+                (base, n, value))
+DEFINE_DISPATCH(count_f64, (const double *base, size_t n, double value),
+                (base, n, value))
+
+DEFINE_DISPATCH(min_i32, (const int32_t *base, size_t n), (base, n))
+DEFINE_DISPATCH(min_i64, (const int64_t *base, size_t n), (base, n))
+DEFINE_DISPATCH(min_f32, (const float *base, size_t n), (base, n))
+DEFINE_DISPATCH(min_f64, (const double *base, size_t n), (base, n))
+DEFINE_DISPATCH(max_i32, (const int32_t *base, size_t n), (base, n))
+DEFINE_DISPATCH(max_i64, (const int64_t *base, size_t n), (base, n))
+DEFINE_DISPATCH(max_f32, (const float *base, size_t n), (base, n))
+DEFINE_DISPATCH(max_f64, (const double *base, size_t n), (base, n))
+
+#else
+
+// ISO C forbids an empty translation unit
+typedef int csimd_unavailable;
+
+#endif
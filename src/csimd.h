@@ -0,0 +1,69 @@
+// The csimd module provides vectorized search, count, and min/max kernels
+//   for contiguous arrays of 32-bit and 64-bit integers and floats.
+//   Implementations are selected at runtime: AVX2 when the CPU supports it
+//   and SSE2 otherwise on x86-64, and NEON on AArch64. CSIMD_AVAILABLE is
+//   defined only if the target has a vector implementation; otherwise
+//   callers use their scalar kernels.
+//
+// Equality follows the built-in ctype cmp methods: two values are equal if
+//   neither is less than the other, so for floats NaN equals every value.
+//   Min/max kernels match a sequential scan that replaces the current
+//   candidate only by a strictly smaller (or larger) value.
+// note: csimd is internal to the library and is not part of the public API
+
+#ifndef CSIMD_H
+#define CSIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CSIMD_X86 1
+#define CSIMD_AVAILABLE 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define CSIMD_NEON 1
+#define CSIMD_AVAILABLE 1
+#endif
+
+#ifdef CSIMD_AVAILABLE
+
+// csimd_find_<lane>(base, n, value) produces the index of the first value
+//   in base[0..n) equal to value, or n if there is none.
+// requires: base is not NULL if n > 0
+size_t csimd_find_i32(const int32_t *base, size_t n, int32_t value);
+size_t csimd_find_i64(const int64_t *base, size_t n, int64_t value);
+size_t csimd_find_f32(const float *base, size_t n, float value);
+size_t csimd_find_f64(const double *base, size_t n, double value);
+
+// csimd_find_last_<lane>(base, n, value) produces the index of the last
+//   value in base[0..n) equal to value, or n if there is none.
+// requires: base is not NULL if n > 0
+size_t csimd_find_last_i32(const int32_t *base, size_t n, int32_t value);
+size_t csimd_find_last_i64(const int64_t *base, size_t n, int64_t value);
+size_t csimd_find_last_f32(const float *base, size_t n, float value);
+size_t csimd_find_last_f64(const double *base, size_t n, double value);
+
+// csimd_count_<lane>(base, n, value) produces the number of values in
+//   base[0..n) equal to value.
+// requires: base is not NULL if n > 0
+size_t csimd_count_i32(const int32_t *base, size_t n, int32_t value);
+size_t csimd_count_i64(const int64_t *base, size_t n, int64_t value);
+size_t csimd_count_f32(const float *base, size_t n, float value);
+size_t csimd_count_f64(const double *base, size_t n, double value);
+
+// csimd_min_<lane>(base, n) produces the index of the first smallest value
+//   in base[0..n); csimd_max_<lane>(base, n) produces the index of the
+//   first largest value.
+// requires: base is not NULL, n > 0
+size_t csimd_min_i32(const int32_t *base, size_t n);
+size_t csimd_min_i64(const int64_t *base, size_t n);
+size_t csimd_min_f32(const float *base, size_t n);
+size_t csimd_min_f64(const double *base, size_t n);
+size_t csimd_max_i32(const int32_t *base, size_t n);
+size_t csimd_max_i64(const int64_t *base, size_t n);
+size_t csimd_max_f32(const float *base, size_t n);
+size_t csimd_max_f64(const double *base, size_t n);
+
+#endif
+
+#endif
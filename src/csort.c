@@ -0,0 +1,652 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "csort.h"
+#include "cerror.h"
+
+// Partitions of at most this many slots are finished by insertion sort
+static const size_t INSERTION_SORT_CUTOFF = 16;
+
+// Partitions of more than this many slots use the ninther for the pivot
+static const size_t NINTHER_THRESHOLD = 128;
+
+// Runs shorter than this are extended by binary insertion sort
+static const size_t TIMSORT_MIN_MERGE = 32;
+
+// Enough pending runs for any n < 2^64 under the timsort run invariants
+#define TIMSORT_MAX_RUNS 85
+
+// A pending timsort run of len slots starting at base
+typedef struct {
+  unsigned char *base;
+  size_t len;
+} tim_run;
+
+// The state of a timsort call
+typedef struct {
+  size_t width;
+  csort_cmp cmp;
+  const void *ctx;
+  unsigned char *buf;  // merge buffer, reused across merges
+  size_t buf_cap;      // capacity of buf in slots
+  tim_run runs[TIMSORT_MAX_RUNS];
+  size_t num_runs;
+} tim_state;
+
+// Each merge pass of csort_par is split into this many parts per thread,
+//   so that threads that finish early can take work from the others
+#define PAR_PARTS_PER_THREAD 4
+
+// The state of a csort_par call
+typedef struct {
+  unsigned char *src;   // the sorted runs of the current pass
+  unsigned char *dst;   // the merged runs of the current pass
+  size_t n;
+  size_t width;
+  csort_cmp cmp;
+  const void *ctx;
+  csort_engine sort;
+  size_t blocks;        // the slots are split into this many blocks
+  size_t run;           // the number of blocks per run in src
+  size_t parts;         // the number of parts of each pass
+} par_state;
+
+// Helper function declaration
+static inline unsigned char *slot(unsigned char *base, size_t index,
+                                  size_t width);
+static size_t median_of_three(unsigned char *base, size_t width,
+                              size_t a, size_t b, size_t c,
+                              csort_cmp cmp, const void *ctx);
+static void insertion_sort(unsigned char *base, size_t n, size_t width,
+                           csort_cmp cmp, const void *ctx);
+static void heap_sort(unsigned char *base, size_t n, size_t width,
+                      csort_cmp cmp, const void *ctx);
+static size_t partition(unsigned char *base, size_t n, size_t width,
+                        csort_cmp cmp, const void *ctx);
+static unsigned char *tim_buffer(tim_state *ts, size_t n);
+static size_t tim_min_run(size_t n);
+static size_t tim_count_run(tim_state *ts, unsigned char *base, size_t n);
+static void tim_binary_insertion(tim_state *ts, unsigned char *base,
+                                 size_t n, size_t sorted);
+static void tim_merge_collapse(tim_state *ts);
+static void tim_merge_force_collapse(tim_state *ts);
+static size_t par_bound(size_t n, size_t k, size_t i);
+static void par_sort_blocks(void *ctx, size_t begin, size_t end);
+static void par_merge_parts(void *ctx, size_t begin, size_t end);
+static void par_merge_part(par_state *ps, size_t lo, size_t hi);
+static size_t par_split(par_state *ps, const unsigned char *a, size_t len_a,
+                        const unsigned char *b, size_t len_b, size_t k);
+static void par_copy_parts(void *ctx, size_t begin, size_t end);
+
+void csort_swap(void *a, void *b, size_t width) {
+  if (a == b) return;
+
+  if (width == sizeof(uint64_t)) {
+    uint64_t temp;
+    memcpy(&temp, a, sizeof(temp));
+    memcpy(a, b, sizeof(temp));
+    memcpy(b, &temp, sizeof(temp));
+    return;
+  }
+  if (width == sizeof(uint32_t)) {
+    uint32_t temp;
+    memcpy(&temp, a, sizeof(temp));
+    memcpy(a, b, sizeof(temp));
+    memcpy(b, &temp, sizeof(temp));
+    return;
+  }
+
+  unsigned char *pa = a;
+  unsigned char *pb = b;
+  unsigned char temp[64];
+  for (size_t left = width; left > 0;) {
+    size_t chunk = left < sizeof(temp) ? left : sizeof(temp);
+    memcpy(temp, pa, chunk);
+    memcpy(pa, pb, chunk);
+    memcpy(pb, temp, chunk);
+    pa += chunk;
+    pb += chunk;
+    left -= chunk;
+  }
+}
+
+void csort_intro(void *base, size_t n, size_t width,
+                 csort_cmp cmp, const void *ctx) {
+  unsigned char *first = base;
+
+  size_t depth_limit = 0;
+  for (size_t i = n; i > 1; i >>= 1) {
+    depth_limit += 2;
+  }
+
+  // Recurse on the smaller partition and loop on the larger one
+  while (n > INSERTION_SORT_CUTOFF) {
+    if (depth_limit == 0) {
+      heap_sort(first, n, width, cmp, ctx);
+      return;
+    }
+    --depth_limit;
+
+    size_t pos = partition(first, n, width, cmp, ctx);
+    size_t left = pos;
+    size_t right = n - pos - 1;
+    if (left < right) {
+      csort_intro(first, left, width, cmp, ctx);
+      first = slot(first, pos + 1, width);
+      n = right;
+    } else {
+      csort_intro(slot(first, pos + 1, width), right, width, cmp, ctx);
+      n = left;
+    }
+  }
+  insertion_sort(first, n, width, cmp, ctx);
+}
+
+void csort_tim(void *base, size_t n, size_t width,
+               csort_cmp cmp, const void *ctx) {
+  if (n < 2) return;
+
+  tim_state ts = {
+    .width = width,
+    .cmp = cmp,
+    .ctx = ctx,
+    .buf = NULL,
+    .buf_cap = 0,
+    .num_runs = 0,
+  };
+
+  unsigned char *lo = base;
+  size_t left = n;
+  size_t min_run = tim_min_run(n);
+  while (left > 0) {
+    size_t run = tim_count_run(&ts, lo, left);
+    if (run < min_run) {
+      size_t forced = left < min_run ? left : min_run;
+      tim_binary_insertion(&ts, lo, forced, run);
+      run = forced;
+    }
+
+    ts.runs[ts.num_runs].base = lo;
+    ts.runs[ts.num_runs].len = run;
+    ++ts.num_runs;
+    tim_merge_collapse(&ts);
+
+    lo += run * width;
+    left -= run;
+  }
+  tim_merge_force_collapse(&ts);
+  free(ts.buf);
+}
+
+void csort_par(cpool *pool, void *base, size_t n, size_t width,
+               csort_cmp cmp, const void *ctx, csort_engine sort) {
+  size_t threads = cpool_threads(pool);
+  size_t blocks = n / cpool_grain(pool);
+  if (blocks > threads) {
+    blocks = threads;
+  }
+  unsigned char *buf = (blocks >= 2) ? malloc(n * width) : NULL;
+  if (!buf) {
+    sort(base, n, ctx);
+    return;
+  }
+
+  par_state ps = {
+    .src = base,
+    .dst = buf,
+    .n = n,
+    .width = width,
+    .cmp = cmp,
+    .ctx = ctx,
+    .sort = sort,
+    .blocks = blocks,
+    .run = 1,
+    .parts = threads * PAR_PARTS_PER_THREAD,
+  };
+  cpool_for_grain(pool, blocks, 1, par_sort_blocks, &ps);
+
+  for (; ps.run < blocks; ps.run *= 2) {
+    cpool_for_grain(pool, ps.parts, 1, par_merge_parts, &ps);
+    unsigned char *merged = ps.dst;
+    ps.dst = ps.src;
+    ps.src = merged;
+  }
+  if (ps.src != (unsigned char *) base) {
+    ps.dst = base;
+    cpool_for_grain(pool, ps.parts, 1, par_copy_parts, &ps);
+  }
+  free(buf);
+}
+
+// Helper function implementation
+static inline unsigned char *slot(unsigned char *base, size_t index,
+                                  size_t width) {
+  return base + index * width;
+}
+
+static size_t median_of_three(unsigned char *base, size_t width,
+                              size_t a, size_t b, size_t c,
+                              csort_cmp cmp, const void *ctx) {
+  const void *pa = slot(base, a, width);
+  const void *pb = slot(base, b, width);
+  const void *pc = slot(base, c, width);
+  if (cmp(pa, pb, ctx) < 0) {
+    if (cmp(pb, pc, ctx) < 0) return b;
+    return (cmp(pa, pc, ctx) < 0) ? c : a;
+  }
+  if (cmp(pa, pc, ctx) < 0) return a;
+  return (cmp(pb, pc, ctx) < 0) ? c : b;
+}
+
+static void insertion_sort(unsigned char *base, size_t n, size_t width,
+                           csort_cmp cmp, const void *ctx) {
+  for (size_t i = 1; i < n; ++i) {
+    for (size_t j = i; j > 0; --j) {
+      unsigned char *cur = slot(base, j, width);
+      unsigned char *prev = cur - width;
+      if (cmp(prev, cur, ctx) <= 0) break;
+      csort_swap(prev, cur, width);
+    }
+  }
+}
+
+static void sift_down(unsigned char *base, size_t root, size_t n,
+                      size_t width, csort_cmp cmp, const void *ctx) {
+  for (;;) {
+    size_t child = 2 * root + 1;
+    if (child >= n) return;
+    if (child + 1 < n && cmp(slot(base, child, width),
+                             slot(base, child + 1, width), ctx) < 0) {
+      ++child;
+    }
+    if (cmp(slot(base, root, width), slot(base, child, width), ctx) >= 0) {
+      return;
+    }
+    csort_swap(slot(base, root, width), slot(base, child, width), width);
+    root = child;
+  }
+}
+
+static void heap_sort(unsigned char *base, size_t n, size_t width,
+                      csort_cmp cmp, const void *ctx) {
+  for (size_t i = n / 2; i-- > 0;) {
+    sift_down(base, i, n, width, cmp, ctx);
+  }
+  for (size_t end = n; end-- > 1;) {
+    csort_swap(base, slot(base, end, width), width);
+    sift_down(base, 0, end, width, cmp, ctx);
+  }
+}
+
+// Partition base around a sampled pivot and produce the final pivot index;
+//   items equal to the pivot are split between both sides, so runs of
+//   duplicates do not degrade the partition
+static size_t partition(unsigned char *base, size_t n, size_t width,
+                        csort_cmp cmp, const void *ctx) {
+  size_t mid = n / 2;
+  size_t last = n - 1;
+  size_t pivot;
+  if (n > NINTHER_THRESHOLD) {
+    size_t step = n / 8;
+    size_t m1 = median_of_three(base, width, 0, step, 2 * step, cmp, ctx);
+    size_t m2 = median_of_three(base, width, mid - step, mid, mid + step,
+                                cmp, ctx);
+    size_t m3 = median_of_three(base, width, last - 2 * step, last - step,
+                                last, cmp, ctx);
+    pivot = median_of_three(base, width, m1, m2, m3, cmp, ctx);
+  } else {
+    pivot = median_of_three(base, width, 0, mid, last, cmp, ctx);
+  }
+  csort_swap(base, slot(base, pivot, width), width);
+
+  // The pivot stays at slot 0 until the final swap
+  const void *p = base;
+  size_t i = 1;
+  size_t j = last;
+  for (;;) {
+    while (i <= j && cmp(slot(base, i, width), p, ctx) < 0) ++i;
+    while (i <= j && cmp(slot(base, j, width), p, ctx) > 0) --j;
+    if (i >= j) break;
+    csort_swap(slot(base, i, width), slot(base, j, width), width);
+    ++i;
+    --j;
+  }
+  csort_swap(base, slot(base, j, width), width);
+  return j;
+}
+
+// Produce a merge buffer of at least n slots
+static unsigned char *tim_buffer(tim_state *ts, size_t n) {
+  if (n <= ts->buf_cap) {
+    return ts->buf;
+  }
+
+  size_t new_cap = ts->buf_cap ? ts->buf_cap : 1;
+  while (new_cap < n) {
+    new_cap *= 2;
+  }
+  if (new_cap > SIZE_MAX / ts->width) {
+    ALLOC_ERROR("timsort merge buffer");
+  }
+  // The old contents are never needed, so avoid realloc's copy
+  free(ts->buf);
+  ts->buf = malloc(new_cap * ts->width);
+  if (!ts->buf) {
+    ALLOC_ERROR("timsort merge buffer");
+  }
+  ts->buf_cap = new_cap;
+  return ts->buf;
+}
+
+// Produce a run length in [MIN_MERGE / 2, MIN_MERGE] such that n / len is
+//   close to, but not above, a power of two
+static size_t tim_min_run(size_t n) {
+  size_t r = 0;
+  while (n >= TIMSORT_MIN_MERGE) {
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+static void reverse_slots(unsigned char *base, size_t n, size_t width) {
+  for (size_t i = 0, j = n - 1; i < j; ++i, --j) {
+    csort_swap(slot(base, i, width), slot(base, j, width), width);
+  }
+}
+
+// Produce the length of the run at base, reversing it in place if it is
+//   strictly descending [strictness keeps the reversal stable]
+static size_t tim_count_run(tim_state *ts, unsigned char *base, size_t n) {
+  size_t width = ts->width;
+  if (n < 2) return n;
+
+  size_t run = 2;
+  if (ts->cmp(slot(base, 1, width), base, ts->ctx) < 0) {
+    while (run < n && ts->cmp(slot(base, run, width),
+                              slot(base, run - 1, width), ts->ctx) < 0) {
+      ++run;
+    }
+    reverse_slots(base, run, width);
+  } else {
+    while (run < n && ts->cmp(slot(base, run, width),
+                              slot(base, run - 1, width), ts->ctx) >= 0) {
+      ++run;
+    }
+  }
+  return run;
+}
+
+// Sort the n slots at base, of which the first sorted are already sorted
+static void tim_binary_insertion(tim_state *ts, unsigned char *base,
+                                 size_t n, size_t sorted) {
+  size_t width = ts->width;
+  unsigned char *pivot = tim_buffer(ts, 1);
+  for (size_t i = sorted ? sorted : 1; i < n; ++i) {
+    memcpy(pivot, slot(base, i, width), width);
+
+    // Insert after all equal items to keep the sort stable
+    size_t lo = 0;
+    size_t hi = i;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (ts->cmp(pivot, slot(base, mid, width), ts->ctx) < 0) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    memmove(slot(base, lo + 1, width), slot(base, lo, width),
+            (i - lo) * width);
+    memcpy(slot(base, lo, width), pivot, width);
+  }
+}
+
+// Produce the number of slots in the sorted base[0..n) that are <= key
+static size_t tim_upper_bound(tim_state *ts, const void *key,
+                              unsigned char *base, size_t n) {
+  size_t lo = 0;
+  size_t hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (ts->cmp(key, slot(base, mid, ts->width), ts->ctx) < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// Produce the number of slots in the sorted base[0..n) that are < key
+static size_t tim_lower_bound(tim_state *ts, const void *key,
+                              unsigned char *base, size_t n) {
+  size_t lo = 0;
+  size_t hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (ts->cmp(slot(base, mid, ts->width), key, ts->ctx) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Merge the adjacent runs a and b, where a is not longer than b
+static void tim_merge_lo(tim_state *ts, unsigned char *a, size_t len_a,
+                         unsigned char *b, size_t len_b) {
+  size_t width = ts->width;
+  unsigned char *tmp = tim_buffer(ts, len_a);
+  memcpy(tmp, a, len_a * width);
+
+  unsigned char *dest = a;
+  unsigned char *pa = tmp;
+  unsigned char *end_a = tmp + len_a * width;
+  unsigned char *pb = b;
+  unsigned char *end_b = b + len_b * width;
+  while (pa < end_a && pb < end_b) {
+    // Take from b only if strictly smaller to keep the merge stable
+    if (ts->cmp(pb, pa, ts->ctx) < 0) {
+      memcpy(dest, pb, width);
+      pb += width;
+    } else {
+      memcpy(dest, pa, width);
+      pa += width;
+    }
+    dest += width;
+  }
+  // The rest of b is already in place
+  memcpy(dest, pa, (size_t) (end_a - pa));
+}
+
+// Merge the adjacent runs a and b, where b is shorter than a
+static void tim_merge_hi(tim_state *ts, unsigned char *a, size_t len_a,
+                         unsigned char *b, size_t len_b) {
+  size_t width = ts->width;
+  unsigned char *tmp = tim_buffer(ts, len_b);
+  memcpy(tmp, b, len_b * width);
+
+  unsigned char *dest = b + len_b * width;
+  unsigned char *pa = a + len_a * width;  // past the last unmerged item
+  unsigned char *pb = tmp + len_b * width;
+  while (pa > a && pb > tmp) {
+    // Take from a only if strictly larger to keep the merge stable
+    if (ts->cmp(pb - width, pa - width, ts->ctx) < 0) {
+      pa -= width;
+      dest -= width;
+      memcpy(dest, pa, width);
+    } else {
+      pb -= width;
+      dest -= width;
+      memcpy(dest, pb, width);
+    }
+  }
+  // The rest of a is already in place
+  memcpy(a, tmp, (size_t) (pb - tmp));
+}
+
+// Merge the pending runs at index positions i and i + 1
+static void tim_merge_at(tim_state *ts, size_t i) {
+  size_t width = ts->width;
+  unsigned char *a = ts->runs[i].base;
+  size_t len_a = ts->runs[i].len;
+  unsigned char *b = ts->runs[i + 1].base;
+  size_t len_b = ts->runs[i + 1].len;
+
+  ts->runs[i].len = len_a + len_b;
+  for (size_t k = i + 1; k + 1 < ts->num_runs; ++k) {
+    ts->runs[k] = ts->runs[k + 1];
+  }
+  --ts->num_runs;
+
+  // Items of a that are <= b[0] are already in place
+  size_t skip = tim_upper_bound(ts, b, a, len_a);
+  a += skip * width;
+  len_a -= skip;
+  if (len_a == 0) return;
+
+  // Items of b that are >= the last item of a are already in place
+  len_b = tim_lower_bound(ts, slot(a, len_a - 1, width), b, len_b);
+  if (len_b == 0) return;
+
+  if (len_a <= len_b) {
+    tim_merge_lo(ts, a, len_a, b, len_b);
+  } else {
+    tim_merge_hi(ts, a, len_a, b, len_b);
+  }
+}
+
+// Merge pending runs until the run lengths satisfy the timsort invariants
+static void tim_merge_collapse(tim_state *ts) {
+  while (ts->num_runs > 1) {
+    size_t n = ts->num_runs - 2;
+    tim_run *r = ts->runs;
+    if ((n > 0 && r[n - 1].len <= r[n].len + r[n + 1].len) ||
+        (n > 1 && r[n - 2].len <= r[n - 1].len + r[n].len)) {
+      if (r[n - 1].len < r[n + 1].len) {
+        --n;
+      }
+    } else if (r[n].len > r[n + 1].len) {
+      break;
+    }
+    tim_merge_at(ts, n);
+  }
+}
+
+// Merge all pending runs into one
+static void tim_merge_force_collapse(tim_state *ts) {
+  while (ts->num_runs > 1) {
+    size_t n = ts->num_runs - 2;
+    if (n > 0 && ts->runs[n - 1].len < ts->runs[n + 1].len) {
+      --n;
+    }
+    tim_merge_at(ts, n);
+  }
+}
+
+// Produce the start of part i of n slots split into k parts of equal size
+//   [give or take one slot]
+static size_t par_bound(size_t n, size_t k, size_t i) {
+  return (n / k) * i + (n % k) * i / k;
+}
+
+static void par_sort_blocks(void *ctx, size_t begin, size_t end) {
+  par_state *ps = ctx;
+  for (size_t i = begin; i < end; ++i) {
+    size_t lo = par_bound(ps->n, ps->blocks, i);
+    size_t hi = par_bound(ps->n, ps->blocks, i + 1);
+    ps->sort(slot(ps->src, lo, ps->width), hi - lo, ps->ctx);
+  }
+}
+
+static void par_merge_parts(void *ctx, size_t begin, size_t end) {
+  par_state *ps = ctx;
+  for (size_t i = begin; i < end; ++i) {
+    par_merge_part(ps, par_bound(ps->n, ps->parts, i), 
+                   par_bound(ps->n, ps->parts, i + 1));
+  }
+}
+
+// Write the slots [lo, hi) of dst by merging each pair of adjacent runs of
+//   src that overlap them
+static void par_merge_part(par_state *ps, size_t lo, size_t hi) {
+  size_t width = ps->width;
+  size_t pair = 2 * ps->run;
+  size_t first = 0;
+  while (lo < hi) {
+    // Find the pair of runs at lo, a = [start, mid) and b = [mid, stop)
+    while (par_bound(ps->n, ps->blocks, 
+                     (first + pair < ps->blocks) ? first + pair : ps->blocks)
+           <= lo) {
+      first += pair;
+    }
+    size_t mid_block = (first + ps->run < ps->blocks) ? 
+                       first + ps->run : ps->blocks;
+    size_t stop_block = (first + pair < ps->blocks) ? 
+                        first + pair : ps->blocks;
+    size_t start = par_bound(ps->n, ps->blocks, first);
+    size_t mid = par_bound(ps->n, ps->blocks, mid_block);
+    size_t stop = par_bound(ps->n, ps->blocks, stop_block);
+    size_t end = (hi < stop) ? hi : stop;
+
+    const unsigned char *a = slot(ps->src, start, width);
+    const unsigned char *b = slot(ps->src, mid, width);
+    size_t len_a = mid - start;
+    size_t len_b = stop - mid;
+    size_t i = par_split(ps, a, len_a, b, len_b, lo - start);
+    size_t j = lo - start - i;
+    size_t i_end = par_split(ps, a, len_a, b, len_b, end - start);
+    size_t j_end = end - start - i_end;
+
+    // Ties are taken from a, the earlier run
+    unsigned char *out = slot(ps->dst, lo, width);
+    while (i < i_end && j < j_end) {
+      const unsigned char *x = slot((unsigned char *) a, i, width);
+      const unsigned char *y = slot((unsigned char *) b, j, width);
+      if (ps->cmp(y, x, ps->ctx) < 0) {
+        memcpy(out, y, width);
+        ++j;
+      } else {
+        memcpy(out, x, width);
+        ++i;
+      }
+      out += width;
+    }
+    memcpy(out, slot((unsigned char *) a, i, width), (i_end - i) * width);
+    out += (i_end - i) * width;
+    memcpy(out, slot((unsigned char *) b, j, width), (j_end - j) * width);
+    lo = end;
+  }
+}
+
+// Produce the number of slots of a among the first k slots of the stable
+//   merge of a and b
+static size_t par_split(par_state *ps, const unsigned char *a, size_t len_a,
+                        const unsigned char *b, size_t len_b, size_t k) {
+  size_t lo = (k > len_b) ? k - len_b : 0;
+  size_t hi = (k < len_a) ? k : len_a;
+  // a[i] is among the first k slots iff it precedes b[k - i - 1]
+  while (lo < hi) {
+    size_t i = lo + (hi - lo) / 2;
+    const unsigned char *x = slot((unsigned char *) a, i, ps->width);
+    const unsigned char *y = slot((unsigned char *) b, k - i - 1, ps->width);
+    if (ps->cmp(y, x, ps->ctx) < 0) {
+      hi = i;
+    } else {
+      lo = i + 1;
+    }
+  }
+  return lo;
+}
+
+static void par_copy_parts(void *ctx, size_t begin, size_t end) {
+  par_state *ps = ctx;
+  for (size_t i = begin; i < end; ++i) {
+    size_t lo = par_bound(ps->n, ps->parts, i);
+    size_t hi = par_bound(ps->n, ps->parts, i + 1);
+    memcpy(slot(ps->dst, lo, ps->width), slot(ps->src, lo, ps->width),
+           (hi - lo) * ps->width);
+  }
+}
@@ -0,0 +1,69 @@
+// The csort module provides the sorting engines shared by the storage ADTs.
+//   Engines sort arrays of fixed-width slots and compare slots through
+//   a caller-provided comparator, so they work for both inline items and
+//   arrays of item pointers.
+// note: csort is internal to the library and is not part of the public API
+
+#ifndef CSORT_H
+#define CSORT_H
+
+#include <stddef.h>
+#include "cpool.h"
+
+// csort_cmp is a comparator on two slots, a and b, where ctx is the
+//   context passed to the sorting engine.
+// note: returns 0 if equal, <0 if a < b, >0 if a > b
+typedef int (*csort_cmp)(const void *a, const void *b, const void *ctx);
+
+// csort_engine is a sequential sort of the n slots at base, where ctx is
+//   the context passed to csort_par.
+typedef void (*csort_engine)(void *base, size_t n, const void *ctx);
+
+// csort_swap(a, b, width) swaps the width bytes at a and b.
+// requires: a and b are not NULL and do not partially overlap
+void csort_swap(void *a, void *b, size_t width);
+
+// csort_intro(base, n, width, cmp, ctx) sorts the n slots of width bytes
+//   at base in ascending order using introsort: median-of-three or ninther
+//   pivots, iteration on the larger partition, an insertion sort cutoff
+//   for small partitions, and a heapsort fallback when the recursion
+//   depth exceeds 2 * log2(n).
+// requires: base is not NULL if n > 0
+//           cmp is not NULL
+// effects: modifies base
+// time: O(n log n) worst case; O(log n) stack
+// note: the sort is not stable
+void csort_intro(void *base, size_t n, size_t width,
+                 csort_cmp cmp, const void *ctx);
+
+// csort_tim(base, n, width, cmp, ctx) stably sorts the n slots of width
+//   bytes at base in ascending order using timsort: existing ascending and
+//   strictly descending runs are detected and reused, short runs are 
+//   extended by binary insertion sort, and runs are merged through one
+//   reusable buffer.
+// requires: base is not NULL if n > 0
+//           cmp is not NULL
+// effects: modifies base, allocates and frees heap memory
+// time: O(n log n) worst case; O(n) if base consists of a few runs
+void csort_tim(void *base, size_t n, size_t width,
+               csort_cmp cmp, const void *ctx);
+
+// csort_par(pool, base, n, width, cmp, ctx, sort) stably sorts the n slots
+//   of width bytes at base in ascending order on the threads of pool: the
+//   slots are split into one block per thread, the blocks are sorted 
+//   concurrently with sort, and the sorted blocks are merged pairwise with
+//   every merge pass split into equal parts of the output, so that each
+//   part is merged by one thread. Slots that compare equal keep their 
+//   order, so the result is that of any stable sort.
+// requires: pool, cmp and sort are not NULL
+//           base is not NULL if n > 0
+//           sort is a stable sort by cmp [or one whose result cannot be 
+//           told apart from a stable sort]
+// effects: modifies base, allocates and frees heap memory
+// time: O(n log n) work; O(n log n / t + n log t / t) on t threads
+// note: the merge buffer holds n slots; if it cannot be allocated, base
+//       is sorted with sort alone
+void csort_par(cpool *pool, void *base, size_t n, size_t width,
+               csort_cmp cmp, const void *ctx, csort_engine sort);
+
+#endif
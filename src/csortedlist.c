@@ -0,0 +1,740 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "csortedlist.h"
+#include "cerror.h"
+#include "ckernel.h"
+
+// A leaf holds about this many bytes of slots
+#define LEAF_BYTES 1024
+#define MIN_LEAF_SLOTS 8
+
+// The most children of a branch
+#define BRANCH_ORDER 32
+
+// Slots and keys follow node headers in the same block, at this alignment
+#define SLOT_ALIGN 16
+#define ALIGN_UP(n) (((n) + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN)
+
+// Each node has room for one entry more than its maximum, so that an
+//   insertion is made before the node splits
+typedef struct node {
+  bool leaf;
+  size_t count;  // the number of items (leaf) or children (branch)
+} node;
+
+// A run of consecutive items; the slots follow the header
+typedef struct leaf {
+  node base;
+  struct leaf *prev;
+  struct leaf *next;
+  unsigned char *slots;
+} leaf;
+
+// Routing key i separates child i and child i + 1: no item below child i
+//   is greater than it, and no item below child i + 1 is less than it.
+//   The keys follow the header.
+typedef struct branch {
+  node base;
+  node *children[BRANCH_ORDER + 1];
+  size_t sizes[BRANCH_ORDER + 1];  // the number of items below each child
+  unsigned char *keys;
+} branch;
+
+struct csortedlist {
+  const ctype *type;
+  size_t width;           // the size of a slot in bytes
+  bool boxed;             // true if slots hold pointers to the items
+  ckernel_kind kernel;    // CKERNEL_NONE unless inline with a built-in ctype
+  size_t leaf_slots;      // the most items of a leaf
+  size_t size;
+  node *root;             // an empty leaf if sl is empty
+  unsigned char *key;     // a routing key moving up from a split
+};
+
+// Assertion messages
+static const char *ASSERT_INDEX_BOUNDED
+  = "Index cannot exceed (csortedlist_size - 1)!";
+static const char *ASSERT_INDEX_BOUNDED_INCLUSIVE
+  = "Index cannot exceed csortedlist_size!";
+static const char *ASSERT_INDEX_END_AFTER_START
+  = "The end index must be greater than or equal to the start index!";
+
+// Helper function declaration
+static inline unsigned char *slot_at(const csortedlist *sl,
+                                     unsigned char *base, size_t i);
+static inline const void *slot_item(const csortedlist *sl, const void *slot);
+static void store_slot(const csortedlist *sl, void *slot, const void *item);
+static void release_slot(const csortedlist *sl, void *slot);
+static size_t lower_in(const csortedlist *sl, unsigned char *base, size_t n,
+                       const void *item);
+static size_t upper_in(const csortedlist *sl, unsigned char *base, size_t n,
+                       const void *item);
+static leaf *new_leaf(const csortedlist *sl);
+static branch *new_branch(const csortedlist *sl);
+static void free_node(const csortedlist *sl, node *n);
+static size_t node_size(const node *n);
+static node *insert_into(csortedlist *sl, node *n, const void *item,
+                         size_t *index);
+static node *split_leaf(csortedlist *sl, leaf *l);
+static node *split_branch(csortedlist *sl, branch *b);
+static void remove_from(csortedlist *sl, node *n, size_t index);
+static bool underflows(const csortedlist *sl, const node *n);
+static void fix_child(csortedlist *sl, branch *b, size_t c);
+static void merge_leaves(csortedlist *sl, branch *b, size_t c);
+static void merge_branches(csortedlist *sl, branch *b, size_t c);
+static void rotate_left(csortedlist *sl, branch *b, size_t c);
+static void rotate_right(csortedlist *sl, branch *b, size_t c);
+static void remove_child(csortedlist *sl, branch *b, size_t c);
+static leaf *leaf_at(const csortedlist *sl, size_t *index);
+static size_t rank(const csortedlist *sl, const void *item, bool upper);
+
+csortedlist *csortedlist_create(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+
+  csortedlist *sl = malloc(sizeof(*sl));
+  if (!sl) {
+    ALLOC_ERROR("csortedlist");
+  }
+  sl->type = type;
+  sl->boxed = !ctype_is_pod(type);
+  sl->width = sl->boxed ? sizeof(void *) : data_size(type);
+  sl->kernel = sl->boxed ? CKERNEL_NONE : ckernel_select(type);
+  sl->leaf_slots = LEAF_BYTES / sl->width;
+  if (sl->leaf_slots < MIN_LEAF_SLOTS) {
+    sl->leaf_slots = MIN_LEAF_SLOTS;
+  }
+  sl->size = 0;
+  sl->key = malloc(sl->width);
+  if (!sl->key) {
+    ALLOC_ERROR("csortedlist");
+  }
+  sl->root = &new_leaf(sl)->base;
+  return sl;
+}
+
+void csortedlist_destroy(csortedlist *sl) {
+  if (!sl) return;
+
+  free_node(sl, sl->root);
+  free(sl->key);
+  free(sl);
+}
+
+void csortedlist_clear(csortedlist *sl) {
+  ASSERT_NOT_NULL(sl, NULL);
+
+  free_node(sl, sl->root);
+  sl->root = &new_leaf(sl)->base;
+  sl->size = 0;
+}
+
+void csortedlist_print(const csortedlist *sl) {
+  ASSERT_NOT_NULL(sl, NULL);
+
+  size_t offset = 0;
+  const leaf *l = leaf_at(sl, &offset);
+  printf("[");
+  for (bool first = true; l; l = l->next) {
+    for (size_t i = 0; i < l->base.count; ++i, first = false) {
+      if (!first) {
+        printf(", ");
+      }
+      data_print(slot_item(sl, slot_at(sl, l->slots, i)), sl->type);
+    }
+  }
+  printf("]\n");
+}
+
+const ctype *csortedlist_type(const csortedlist *sl) {
+  ASSERT_NOT_NULL(sl, NULL);
+  return sl->type;
+}
+
+size_t csortedlist_size(const csortedlist *sl) {
+  ASSERT_NOT_NULL(sl, NULL);
+  return sl->size;
+}
+
+bool csortedlist_empty(const csortedlist *sl) {
+  ASSERT_NOT_NULL(sl, NULL);
+  return sl->size == 0;
+}
+
+size_t csortedlist_insert(csortedlist *sl, const void *item) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, "The item to be inserted");
+
+  size_t index = 0;
+  node *right = insert_into(sl, sl->root, item, &index);
+  if (right) {
+    // The root split: grow the tree by one level
+    branch *root = new_branch(sl);
+    root->children[0] = sl->root;
+    root->children[1] = right;
+    root->sizes[0] = node_size(sl->root);
+    root->sizes[1] = node_size(right);
+    memcpy(root->keys, sl->key, sl->width);
+    root->base.count = 2;
+    sl->root = &root->base;
+  }
+  ++sl->size;
+  return index;
+}
+
+const void *csortedlist_get(const csortedlist *sl, size_t index) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_MSG(index < sl->size, ASSERT_INDEX_BOUNDED);
+
+  const leaf *l = leaf_at(sl, &index);
+  return slot_item(sl, slot_at(sl, l->slots, index));
+}
+
+size_t csortedlist_lower_bound(const csortedlist *sl, const void *item) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  return rank(sl, item, false);
+}
+
+size_t csortedlist_upper_bound(const csortedlist *sl, const void *item) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  return rank(sl, item, true);
+}
+
+void csortedlist_equal_range(const csortedlist *sl, const void *item,
+                             size_t *from_index, size_t *to_index) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(from_index, "The start index");
+  ASSERT_NOT_NULL(to_index, "The end index");
+
+  *from_index = rank(sl, item, false);
+  *to_index = rank(sl, item, true);
+}
+
+size_t csortedlist_index(const csortedlist *sl, const void *item) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t index = rank(sl, item, false);
+  if (index < sl->size &&
+      data_cmp(csortedlist_get(sl, index), item, sl->type) == 0) {
+    return index;
+  }
+  return CALIST_INDEX_NOT_FOUND;
+}
+
+bool csortedlist_contains(const csortedlist *sl, const void *item) {
+  return csortedlist_index(sl, item) != CALIST_INDEX_NOT_FOUND;
+}
+
+size_t csortedlist_count(const csortedlist *sl, const void *item) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  return rank(sl, item, true) - rank(sl, item, false);
+}
+
+void csortedlist_pop(csortedlist *sl, size_t index) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_MSG(index < sl->size, ASSERT_INDEX_BOUNDED);
+
+  remove_from(sl, sl->root, index);
+  --sl->size;
+
+  // A root branch with one child is replaced by the child
+  if (!sl->root->leaf && sl->root->count == 1) {
+    branch *root = (branch *) sl->root;
+    sl->root = root->children[0];
+    free(root);
+  }
+}
+
+size_t csortedlist_remove(csortedlist *sl, const void *item) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t index = csortedlist_index(sl, item);
+  if (index != CALIST_INDEX_NOT_FOUND) {
+    csortedlist_pop(sl, index);
+  }
+  return index;
+}
+
+void csortedlist_remove_range(csortedlist *sl, size_t from_index,
+                              size_t to_index) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= sl->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  for (size_t i = from_index; i < to_index; ++i) {
+    csortedlist_pop(sl, from_index);
+  }
+}
+
+void csortedlist_foreach_range(const csortedlist *sl, size_t from_index,
+                               size_t to_index, csortedlist_visit visit,
+                               const void *args) {
+  ASSERT_NOT_NULL(sl, NULL);
+  ASSERT_NOT_NULL(visit, NULL);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= sl->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  size_t left = to_index - from_index;
+  if (left == 0) return;
+
+  size_t i = from_index;
+  for (const leaf *l = leaf_at(sl, &i); left > 0; l = l->next, i = 0) {
+    for (; i < l->base.count && left > 0; ++i, --left) {
+      visit(sl, slot_item(sl, slot_at(sl, l->slots, i)), args);
+    }
+  }
+}
+
+calist *csortedlist_to_calist(const csortedlist *sl) {
+  ASSERT_NOT_NULL(sl, NULL);
+
+  calist *al = calist_create_size(sl->type, sl->size ? sl->size : 1);
+  size_t offset = 0;
+  for (const leaf *l = leaf_at(sl, &offset); l; l = l->next) {
+    if (!sl->boxed) {
+      calist_append_array(al, l->slots, l->base.count);
+      continue;
+    }
+    for (size_t i = 0; i < l->base.count; ++i) {
+      calist_append(al, slot_item(sl, slot_at(sl, l->slots, i)));
+    }
+  }
+  return al;
+}
+
+// Helper function implementation
+static inline unsigned char *slot_at(const csortedlist *sl,
+                                     unsigned char *base, size_t i) {
+  return base + i * sl->width;
+}
+
+static inline const void *slot_item(const csortedlist *sl, const void *slot) {
+  if (!sl->boxed) {
+    return slot;
+  }
+  const void *item;
+  memcpy(&item, slot, sizeof(item));
+  return item;
+}
+
+// Fill slot with a deep copy of item
+static void store_slot(const csortedlist *sl, void *slot, const void *item) {
+  if (!sl->boxed) {
+    memcpy(slot, item, sl->width);
+    return;
+  }
+  void *copy = data_dup(item, sl->type);
+  if (!copy) {
+    ALLOC_ERROR("csortedlist item");
+  }
+  memcpy(slot, &copy, sizeof(copy));
+}
+
+static void release_slot(const csortedlist *sl, void *slot) {
+  if (sl->boxed) {
+    void *item;
+    memcpy(&item, slot, sizeof(item));
+    data_destroy(item, sl->type);
+  }
+}
+
+// Produce the number of the n sorted slots at base that are less than
+//   item
+static size_t lower_in(const csortedlist *sl, unsigned char *base, size_t n,
+                       const void *item) {
+  if (sl->kernel != CKERNEL_NONE) {
+    return ckernel_lower_bound(sl->kernel, base, n, item);
+  }
+
+  size_t low = 0;
+  while (n > 0) {
+    size_t half = n / 2;
+    const void *mid = slot_item(sl, slot_at(sl, base, low + half));
+    if (data_cmp(mid, item, sl->type) < 0) {
+      low += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return low;
+}
+
+// Produce the number of the n sorted slots at base that are not greater
+//   than item
+static size_t upper_in(const csortedlist *sl, unsigned char *base, size_t n,
+                       const void *item) {
+  if (sl->kernel != CKERNEL_NONE) {
+    return ckernel_upper_bound(sl->kernel, base, n, item);
+  }
+
+  size_t low = 0;
+  while (n > 0) {
+    size_t half = n / 2;
+    const void *mid = slot_item(sl, slot_at(sl, base, low + half));
+    if (data_cmp(mid, item, sl->type) <= 0) {
+      low += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return low;
+}
+
+static leaf *new_leaf(const csortedlist *sl) {
+  size_t header = ALIGN_UP(sizeof(leaf));
+  leaf *l = malloc(header + sl->width * (sl->leaf_slots + 1));
+  if (!l) {
+    ALLOC_ERROR("csortedlist node");
+  }
+  l->base.leaf = true;
+  l->base.count = 0;
+  l->prev = l->next = NULL;
+  l->slots = (unsigned char *) l + header;
+  return l;
+}
+
+static branch *new_branch(const csortedlist *sl) {
+  size_t header = ALIGN_UP(sizeof(branch));
+  branch *b = malloc(header + sl->width * BRANCH_ORDER);
+  if (!b) {
+    ALLOC_ERROR("csortedlist node");
+  }
+  b->base.leaf = false;
+  b->base.count = 0;
+  b->keys = (unsigned char *) b + header;
+  return b;
+}
+
+// Free n with all of the items and keys below it
+static void free_node(const csortedlist *sl, node *n) {
+  if (n->leaf) {
+    leaf *l = (leaf *) n;
+    for (size_t i = 0; i < n->count; ++i) {
+      release_slot(sl, slot_at(sl, l->slots, i));
+    }
+  } else {
+    branch *b = (branch *) n;
+    for (size_t c = 0; c < n->count; ++c) {
+      free_node(sl, b->children[c]);
+    }
+    for (size_t k = 0; k + 1 < n->count; ++k) {
+      release_slot(sl, slot_at(sl, b->keys, k));
+    }
+  }
+  free(n);
+}
+
+static size_t node_size(const node *n) {
+  if (n->leaf) {
+    return n->count;
+  }
+  const branch *b = (const branch *) n;
+  size_t total = 0;
+  for (size_t c = 0; c < n->count; ++c) {
+    total += b->sizes[c];
+  }
+  return total;
+}
+
+// Insert a copy of item below n, after the items equal to it, and store
+//   its index below n at index. If n splits, produce its new right sibling
+//   and leave the routing key between them in sl->key; otherwise produce
+//   NULL.
+static node *insert_into(csortedlist *sl, node *n, const void *item,
+                         size_t *index) {
+  if (n->leaf) {
+    leaf *l = (leaf *) n;
+    size_t pos = upper_in(sl, l->slots, n->count, item);
+    memmove(slot_at(sl, l->slots, pos + 1), slot_at(sl, l->slots, pos),
+            sl->width * (n->count - pos));
+    store_slot(sl, slot_at(sl, l->slots, pos), item);
+    ++n->count;
+    *index = pos;
+    return (n->count > sl->leaf_slots) ? split_leaf(sl, l) : NULL;
+  }
+
+  branch *b = (branch *) n;
+  size_t c = upper_in(sl, b->keys, n->count - 1, item);
+  size_t offset = 0;
+  for (size_t i = 0; i < c; ++i) {
+    offset += b->sizes[i];
+  }
+  node *right = insert_into(sl, b->children[c], item, index);
+  *index += offset;
+  ++b->sizes[c];
+  if (!right) {
+    return NULL;
+  }
+
+  // Adopt the new sibling of child c and its routing key
+  memmove(slot_at(sl, b->keys, c + 1), slot_at(sl, b->keys, c),
+          sl->width * (n->count - 1 - c));
+  memcpy(slot_at(sl, b->keys, c), sl->key, sl->width);
+  memmove(&b->children[c + 2], &b->children[c + 1],
+          sizeof(*b->children) * (n->count - 1 - c));
+  memmove(&b->sizes[c + 2], &b->sizes[c + 1],
+          sizeof(*b->sizes) * (n->count - 1 - c));
+  b->children[c + 1] = right;
+  b->sizes[c + 1] = node_size(right);
+  b->sizes[c] -= b->sizes[c + 1];
+  ++n->count;
+  return (n->count > BRANCH_ORDER) ? split_branch(sl, b) : NULL;
+}
+
+// Move the upper half of the overfull leaf l to a new leaf after it,
+//   leaving a copy of its first item in sl->key
+static node *split_leaf(csortedlist *sl, leaf *l) {
+  leaf *right = new_leaf(sl);
+  size_t half = l->base.count / 2;
+  right->base.count = l->base.count - half;
+  memcpy(right->slots, slot_at(sl, l->slots, half),
+         sl->width * right->base.count);
+  l->base.count = half;
+
+  right->prev = l;
+  right->next = l->next;
+  if (l->next) {
+    l->next->prev = right;
+  }
+  l->next = right;
+
+  store_slot(sl, sl->key, slot_item(sl, right->slots));
+  return &right->base;
+}
+
+// Move the upper half of the overfull branch b to a new branch after it,
+//   leaving the key between the halves in sl->key
+static node *split_branch(csortedlist *sl, branch *b) {
+  branch *right = new_branch(sl);
+  size_t half = b->base.count / 2;
+  right->base.count = b->base.count - half;
+  memcpy(right->children, &b->children[half],
+         sizeof(*b->children) * right->base.count);
+  memcpy(right->sizes, &b->sizes[half],
+         sizeof(*b->sizes) * right->base.count);
+  memcpy(right->keys, slot_at(sl, b->keys, half),
+         sl->width * (right->base.count - 1));
+  memcpy(sl->key, slot_at(sl, b->keys, half - 1), sl->width);
+  b->base.count = half;
+  return &right->base;
+}
+
+// Remove the item at index below n, leaving n possibly underfull
+static void remove_from(csortedlist *sl, node *n, size_t index) {
+  if (n->leaf) {
+    leaf *l = (leaf *) n;
+    release_slot(sl, slot_at(sl, l->slots, index));
+    memmove(slot_at(sl, l->slots, index), slot_at(sl, l->slots, index + 1),
+            sl->width * (n->count - index - 1));
+    --n->count;
+    return;
+  }
+
+  branch *b = (branch *) n;
+  size_t c = 0;
+  while (index >= b->sizes[c]) {
+    index -= b->sizes[c++];
+  }
+  remove_from(sl, b->children[c], index);
+  --b->sizes[c];
+  if (underflows(sl, b->children[c])) {
+    fix_child(sl, b, c);
+  }
+}
+
+static bool underflows(const csortedlist *sl, const node *n) {
+  size_t most = n->leaf ? sl->leaf_slots : BRANCH_ORDER;
+  return n->count < most / 2;
+}
+
+// Restore the underfull child c of b by merging it with a sibling or
+//   borrowing an entry from one
+static void fix_child(csortedlist *sl, branch *b, size_t c) {
+  size_t l = (c > 0) ? c - 1 : c;
+  node *left = b->children[l];
+  node *right = b->children[l + 1];
+  size_t most = left->leaf ? sl->leaf_slots : BRANCH_ORDER;
+
+  if (left->count + right->count <= most) {
+    if (left->leaf) {
+      merge_leaves(sl, b, l);
+    } else {
+      merge_branches(sl, b, l);
+    }
+  } else if (l == c) {
+    rotate_left(sl, b, l);
+  } else {
+    rotate_right(sl, b, l);
+  }
+}
+
+// Merge child c + 1 of b into child c, both leaves
+static void merge_leaves(csortedlist *sl, branch *b, size_t c) {
+  leaf *left = (leaf *) b->children[c];
+  leaf *right = (leaf *) b->children[c + 1];
+  memcpy(slot_at(sl, left->slots, left->base.count), right->slots,
+         sl->width * right->base.count);
+  left->base.count += right->base.count;
+  left->next = right->next;
+  if (right->next) {
+    right->next->prev = left;
+  }
+  free(right);
+
+  release_slot(sl, slot_at(sl, b->keys, c));
+  b->sizes[c] += b->sizes[c + 1];
+  remove_child(sl, b, c);
+}
+
+// Merge child c + 1 of b into child c, both branches, moving the key
+//   between them down
+static void merge_branches(csortedlist *sl, branch *b, size_t c) {
+  branch *left = (branch *) b->children[c];
+  branch *right = (branch *) b->children[c + 1];
+  size_t n = left->base.count;
+  memcpy(slot_at(sl, left->keys, n - 1), slot_at(sl, b->keys, c),
+         sl->width);
+  memcpy(slot_at(sl, left->keys, n), right->keys,
+         sl->width * (right->base.count - 1));
+  memcpy(&left->children[n], right->children,
+         sizeof(*right->children) * right->base.count);
+  memcpy(&left->sizes[n], right->sizes,
+         sizeof(*right->sizes) * right->base.count);
+  left->base.count += right->base.count;
+  free(right);
+
+  b->sizes[c] += b->sizes[c + 1];
+  remove_child(sl, b, c);
+}
+
+// Move the first entry of child c + 1 of b to the end of child c
+static void rotate_left(csortedlist *sl, branch *b, size_t c) {
+  node *left = b->children[c];
+  node *right = b->children[c + 1];
+  unsigned char *key = slot_at(sl, b->keys, c);
+
+  if (left->leaf) {
+    leaf *l = (leaf *) left;
+    leaf *r = (leaf *) right;
+    memcpy(slot_at(sl, l->slots, left->count), r->slots, sl->width);
+    memmove(r->slots, slot_at(sl, r->slots, 1),
+            sl->width * (right->count - 1));
+    ++left->count;
+    --right->count;
+    release_slot(sl, key);
+    store_slot(sl, key, slot_item(sl, r->slots));
+    ++b->sizes[c];
+    --b->sizes[c + 1];
+    return;
+  }
+
+  branch *l = (branch *) left;
+  branch *r = (branch *) right;
+  size_t moved = r->sizes[0];
+  memcpy(slot_at(sl, l->keys, left->count - 1), key, sl->width);
+  l->children[left->count] = r->children[0];
+  l->sizes[left->count] = moved;
+  memcpy(key, r->keys, sl->width);
+  memmove(r->keys, slot_at(sl, r->keys, 1), sl->width * (right->count - 2));
+  memmove(r->children, &r->children[1],
+          sizeof(*r->children) * (right->count - 1));
+  memmove(r->sizes, &r->sizes[1], sizeof(*r->sizes) * (right->count - 1));
+  ++left->count;
+  --right->count;
+  b->sizes[c] += moved;
+  b->sizes[c + 1] -= moved;
+}
+
+// Move the last entry of child c of b to the front of child c + 1
+static void rotate_right(csortedlist *sl, branch *b, size_t c) {
+  node *left = b->children[c];
+  node *right = b->children[c + 1];
+  unsigned char *key = slot_at(sl, b->keys, c);
+
+  if (left->leaf) {
+    leaf *l = (leaf *) left;
+    leaf *r = (leaf *) right;
+    memmove(slot_at(sl, r->slots, 1), r->slots, sl->width * right->count);
+    memcpy(r->slots, slot_at(sl, l->slots, left->count - 1), sl->width);
+    --left->count;
+    ++right->count;
+    release_slot(sl, key);
+    store_slot(sl, key, slot_item(sl, r->slots));
+    --b->sizes[c];
+    ++b->sizes[c + 1];
+    return;
+  }
+
+  branch *l = (branch *) left;
+  branch *r = (branch *) right;
+  size_t moved = l->sizes[left->count - 1];
+  memmove(slot_at(sl, r->keys, 1), r->keys, sl->width * (right->count - 1));
+  memcpy(r->keys, key, sl->width);
+  memmove(&r->children[1], r->children,
+          sizeof(*r->children) * right->count);
+  memmove(&r->sizes[1], r->sizes, sizeof(*r->sizes) * right->count);
+  r->children[0] = l->children[left->count - 1];
+  r->sizes[0] = moved;
+  memcpy(key, slot_at(sl, l->keys, left->count - 2), sl->width);
+  --left->count;
+  ++right->count;
+  b->sizes[c] -= moved;
+  b->sizes[c + 1] += moved;
+}
+
+// Remove child c + 1 of b and the key before it, whose contents have been
+//   moved or released
+static void remove_child(csortedlist *sl, branch *b, size_t c) {
+  size_t n = b->base.count;
+  memmove(slot_at(sl, b->keys, c), slot_at(sl, b->keys, c + 1),
+          sl->width * (n - 2 - c));
+  memmove(&b->children[c + 1], &b->children[c + 2],
+          sizeof(*b->children) * (n - 2 - c));
+  memmove(&b->sizes[c + 1], &b->sizes[c + 2],
+          sizeof(*b->sizes) * (n - 2 - c));
+  --b->base.count;
+}
+
+// Produce the leaf holding the item at *index, and store the position of
+//   the item in the leaf at index; an index of 0 in an empty sl produces
+//   the empty root leaf
+static leaf *leaf_at(const csortedlist *sl, size_t *index) {
+  node *n = sl->root;
+  while (!n->leaf) {
+    const branch *b = (const branch *) n;
+    size_t c = 0;
+    while (c + 1 < n->count && *index >= b->sizes[c]) {
+      *index -= b->sizes[c++];
+    }
+    n = b->children[c];
+  }
+  return (leaf *) n;
+}
+
+// Produce the number of items in sl that are less than item, or not
+//   greater than item if upper is true
+static size_t rank(const csortedlist *sl, const void *item, bool upper) {
+  size_t total = 0;
+  node *n = sl->root;
+  while (!n->leaf) {
+    branch *b = (branch *) n;
+    size_t c = upper ? upper_in(sl, b->keys, n->count - 1, item)
+                     : lower_in(sl, b->keys, n->count - 1, item);
+    for (size_t i = 0; i < c; ++i) {
+      total += b->sizes[i];
+    }
+    n = b->children[c];
+  }
+  leaf *l = (leaf *) n;
+  return total + (upper ? upper_in(sl, l->slots, n->count, item)
+                        : lower_in(sl, l->slots, n->count, item));
+}
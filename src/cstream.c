@@ -0,0 +1,175 @@
+#include <stdlib.h>
+#include <string.h>
+#include "cstream.h"
+#include "cerror.h"
+
+// Bytes are checksummed in blocks of BLOCK_SIZE bytes, counted from the
+//   start of the stream, so that large buffers can bypass the block buffer
+#define BLOCK_SIZE ((size_t) 1 << 16)
+
+static const uint64_t CHECKSUM_SEED = 14695981039346656037ULL;
+static const uint64_t CHECKSUM_PRIME = 1099511628211ULL;
+
+// Helper function declaration
+static uint64_t checksum_block(uint64_t checksum, const unsigned char *p,
+                               size_t n);
+static void ensure_block(cstream *s);
+static void flush_block(cstream *s);
+
+void cstream_open_write(cstream *s, FILE *out) {
+  s->file = out;
+  s->block = NULL;
+  s->pos = 0;
+  s->fill = 0;
+  s->left = 0;
+  s->bytes = 0;
+  s->checksum = CHECKSUM_SEED;
+  s->ok = true;
+}
+
+void cstream_write(cstream *s, const void *buf, size_t n) {
+  const unsigned char *p = buf;
+  s->bytes += n;
+  while (n > 0) {
+    // Whole blocks skip the buffer
+    if (s->fill == 0 && n >= BLOCK_SIZE) {
+      size_t direct = n - n % BLOCK_SIZE;
+      for (size_t i = 0; i < direct; i += BLOCK_SIZE) {
+        s->checksum = checksum_block(s->checksum, p + i, BLOCK_SIZE);
+      }
+      if (s->file && fwrite(p, 1, direct, s->file) != direct) {
+        s->ok = false;
+      }
+      p += direct;
+      n -= direct;
+      continue;
+    }
+
+    ensure_block(s);
+    size_t chunk = BLOCK_SIZE - s->fill;
+    if (chunk > n) {
+      chunk = n;
+    }
+    memcpy(s->block + s->fill, p, chunk);
+    s->fill += chunk;
+    p += chunk;
+    n -= chunk;
+    if (s->fill == BLOCK_SIZE) {
+      flush_block(s);
+    }
+  }
+}
+
+bool cstream_close_write(cstream *s) {
+  if (s->fill > 0) {
+    flush_block(s);
+  }
+  free(s->block);
+  s->block = NULL;
+  return s->ok;
+}
+
+void cstream_open_read(cstream *s, FILE *in, size_t bytes) {
+  cstream_open_write(s, in);
+  s->left = bytes;
+}
+
+bool cstream_read(cstream *s, void *buf, size_t n) {
+  unsigned char *p = buf;
+  while (n > 0 && s->ok) {
+    if (s->pos == s->fill) {
+      // Whole blocks are read straight into buf
+      size_t direct = (n < s->left ? n : s->left);
+      direct -= direct % BLOCK_SIZE;
+      if (direct > 0) {
+        if (fread(p, 1, direct, s->file) != direct) {
+          s->ok = false;
+          break;
+        }
+        for (size_t i = 0; i < direct; i += BLOCK_SIZE) {
+          s->checksum = checksum_block(s->checksum, p + i, BLOCK_SIZE);
+        }
+        s->left -= direct;
+        s->bytes += direct;
+        p += direct;
+        n -= direct;
+        continue;
+      }
+
+      size_t chunk = (s->left < BLOCK_SIZE ? s->left : BLOCK_SIZE);
+      if (chunk == 0) {
+        s->ok = false;
+        break;
+      }
+      ensure_block(s);
+      if (fread(s->block, 1, chunk, s->file) != chunk) {
+        s->ok = false;
+        break;
+      }
+      s->checksum = checksum_block(s->checksum, s->block, chunk);
+      s->left -= chunk;
+      s->pos = 0;
+      s->fill = chunk;
+    }
+
+    size_t chunk = s->fill - s->pos;
+    if (chunk > n) {
+      chunk = n;
+    }
+    memcpy(p, s->block + s->pos, chunk);
+    s->pos += chunk;
+    s->bytes += chunk;
+    p += chunk;
+    n -= chunk;
+  }
+  return s->ok;
+}
+
+bool cstream_close_read(cstream *s, uint64_t checksum) {
+  free(s->block);
+  s->block = NULL;
+  return s->ok && s->left == 0 && s->pos == s->fill &&
+         s->checksum == checksum;
+}
+
+size_t cstream_bytes(const cstream *s) {
+  return s->bytes;
+}
+
+uint64_t cstream_checksum(const cstream *s) {
+  return s->checksum;
+}
+
+// Helper function implementation
+// Mix the n bytes at p into checksum a word at a time [FNV-1a over 64-bit
+//   words, with a shift so that high bits reach the low ones]
+static uint64_t checksum_block(uint64_t checksum, const unsigned char *p,
+                               size_t n) {
+  for (; n >= sizeof(uint64_t); p += sizeof(uint64_t), n -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    checksum = (checksum ^ word) * CHECKSUM_PRIME;
+    checksum ^= checksum >> 29;
+  }
+  for (; n > 0; ++p, --n) {
+    checksum = (checksum ^ *p) * CHECKSUM_PRIME;
+  }
+  return checksum;
+}
+
+static void ensure_block(cstream *s) {
+  if (!s->block) {
+    s->block = malloc(BLOCK_SIZE);
+    if (!s->block) {
+      ALLOC_ERROR("stream buffer");
+    }
+  }
+}
+
+static void flush_block(cstream *s) {
+  s->checksum = checksum_block(s->checksum, s->block, s->fill);
+  if (s->file && fwrite(s->block, 1, s->fill, s->file) != s->fill) {
+    s->ok = false;
+  }
+  s->fill = 0;
+}
@@ -0,0 +1,73 @@
+// The cstream module provides block-buffered byte streams over files that
+//   checksum the bytes passing through them, for the binary formats of the
+//   storage ADTs. The checksum of a stream depends only on its bytes, not
+//   on how they were split across calls.
+// note: cstream is internal to the library and is not part of the public API
+
+#ifndef CSTREAM_H
+#define CSTREAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// A cstream is a stream writing to, or reading a given number of bytes
+//   from, a file. Its fields are private to the module.
+typedef struct {
+  FILE *file;
+  unsigned char *block;
+  size_t pos;
+  size_t fill;
+  size_t left;  // bytes still to be read from file
+  size_t bytes;
+  uint64_t checksum;
+  bool ok;
+} cstream;
+
+// cstream_open_write(s, out) starts a stream at s writing to out. If out
+//   is NULL, bytes are only counted and checksummed.
+// requires: s is not NULL
+void cstream_open_write(cstream *s, FILE *out);
+
+// cstream_write(s, buf, n) writes the n bytes at buf to s.
+// requires: s was started by cstream_open_write
+//           buf is not NULL if n > 0
+// effects: may produce output to the file of s
+void cstream_write(cstream *s, const void *buf, size_t n);
+
+// cstream_close_write(s) flushes s to its file, producing true if every
+//   byte was written and false otherwise. The number of bytes and the
+//   checksum of s remain available.
+// requires: s was started by cstream_open_write
+// effects: may produce output to the file of s
+bool cstream_close_write(cstream *s);
+
+// cstream_open_read(s, in, bytes) starts a stream at s reading exactly
+//   bytes bytes from in.
+// requires: s and in are not NULL
+void cstream_open_read(cstream *s, FILE *in, size_t bytes);
+
+// cstream_read(s, buf, n) reads the next n bytes of s into buf, producing
+//   true on success and false if s holds fewer than n more bytes or the
+//   file cannot be read.
+// requires: s was started by cstream_open_read
+//           buf is not NULL if n > 0
+// effects: reads from the file of s, modifies buf
+bool cstream_read(cstream *s, void *buf, size_t n);
+
+// cstream_close_read(s, checksum) ends s, producing true if all of its
+//   bytes were read without error and their checksum equals checksum, and
+//   false otherwise.
+// requires: s was started by cstream_open_read
+bool cstream_close_read(cstream *s, uint64_t checksum);
+
+// cstream_bytes(s) produces the number of bytes written to or read from s.
+// requires: s is not NULL
+size_t cstream_bytes(const cstream *s);
+
+// cstream_checksum(s) produces the checksum of the bytes written to s.
+// requires: s was closed by cstream_close_write
+uint64_t cstream_checksum(const cstream *s);
+
+#endif
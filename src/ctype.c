@@ -1,17 +1,45 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include "ctype.h"
 #include "cerror.h"
+#include "cintern.h"
+#include "cformat.h"
 
 struct ctype {
   size_t size;
+  bool pod;
   void *(*dup)(const void *);
   void (*destroy)(void *);
   void (*print)(const void *);
   int (*cmp)(const void *, const void *);
+  size_t (*hash)(const void *);
+  void *(*dup_with)(const void *, const callocator *);
+  void (*destroy_with)(void *, const callocator *);
+  callocator *slab;  // owned; the source of dup and destroy if not NULL
+  bool string;       // values are null-terminated strings
+  size_t slot_size;  // 0 unless values have a slot representation
+  bool (*slot_store)(void *, const void *, const callocator *);
+  const void *(*slot_value)(const void *);
+  void (*slot_release)(void *, const callocator *);
+  size_t (*slot_find)(const void *, size_t, const void *, bool, size_t *);
+  const void *(*canonical)(const void *);
+  size_t (*serialize)(const void *, void *, size_t);
+  void *(*deserialize)(const void *, size_t);
+  size_t (*format)(const void *, char *, size_t);
 };
 
+// The global counters of the data functions [see CALIST_STATS]; a call
+//   that delegates to another data function is counted there
+#if CALIST_STATS
+static ctype_counters counters;
+#define COUNT_CALL(field) \
+  __atomic_add_fetch(&counters.field, 1, __ATOMIC_RELAXED)
+#else
+#define COUNT_CALL(field) ((void) 0)
+#endif
+
 // Helper function declaration
 #define DEFINE_DUP(type) \
   static void *dup_##type(const void *item) { \
@@ -24,11 +52,25 @@ struct ctype {
     return copy; \
   }
 
-#define DEFINE_PRINT(type, format) \
-  static void print_##type(const void *item) { \
+// Format a value by converting it to the given wider type [see cformat]
+#define DEFINE_FORMAT(type, wide, convert) \
+  static size_t format_##type(const void *item, char *buf, size_t cap) { \
     ASSERT_NOT_NULL(item, NULL); \
     const type *ptr = item; \
-    printf(format, *ptr); \
+    char text[CFORMAT_MAX]; \
+    size_t len = convert((wide) *ptr, text); \
+    if (len <= cap) { \
+      memcpy(buf, text, len); \
+    } \
+    return len; \
+  }
+
+// Print a value through its format method
+#define DEFINE_PRINT(type) \
+  static void print_##type(const void *item) { \
+    ASSERT_NOT_NULL(item, NULL); \
+    char text[CFORMAT_MAX]; \
+    fwrite(text, 1, format_##type(item, text, sizeof(text)), stdout); \
   }
 
 #define DEFINE_CMP(type) \
@@ -40,40 +82,103 @@ struct ctype {
     return (*item1_val > *item2_val) - (*item1_val < *item2_val); \
   }
 
+#define DEFINE_HASH(type) \
+  static size_t hash_##type(const void *item) { \
+    ASSERT_NOT_NULL(item, NULL); \
+    const type *ptr = item; \
+    return (size_t) *ptr; \
+  }
+
+// Hash the bits of a floating-point value, where -0.0 hashes as 0.0 and
+//   every NaN hashes alike
+#define DEFINE_HASH_FLOATING(type, bits_type) \
+  static size_t hash_##type(const void *item) { \
+    ASSERT_NOT_NULL(item, NULL); \
+    type value = *(const type *) item; \
+    if (value != value) { \
+      return SIZE_MAX; \
+    } \
+    if (value == 0) { \
+      value = 0; \
+    } \
+    bits_type bits; \
+    memcpy(&bits, &value, sizeof(bits)); \
+    return (size_t) (bits ^ (bits >> (sizeof(bits) * 4))); \
+  }
+
 // === Integral types ===
 DEFINE_DUP(int)
-DEFINE_PRINT(int, "%d")
+DEFINE_FORMAT(int, intmax_t, cformat_signed)
+DEFINE_PRINT(int)
 DEFINE_CMP(int)
+DEFINE_HASH(int)
 
 DEFINE_DUP(long)
-DEFINE_PRINT(long, "%ld")
+DEFINE_FORMAT(long, intmax_t, cformat_signed)
+DEFINE_PRINT(long)
 DEFINE_CMP(long)
+DEFINE_HASH(long)
 
 DEFINE_DUP(char)
-DEFINE_PRINT(char, "%c")
+static size_t format_char(const void *item, char *buf, size_t cap);
+DEFINE_PRINT(char)
 DEFINE_CMP(char)
+DEFINE_HASH(char)
 
 DEFINE_DUP(bool)
-static void print_bool(const void *item);  // Print string "true" or "false"
+static size_t format_bool(const void *item, char *buf, size_t cap);
+DEFINE_PRINT(bool)  // Print string "true" or "false"
 DEFINE_CMP(bool)
+DEFINE_HASH(bool)
 
 DEFINE_DUP(size_t)
-DEFINE_PRINT(size_t, "%zu")
+DEFINE_FORMAT(size_t, uintmax_t, cformat_unsigned)
+DEFINE_PRINT(size_t)
 DEFINE_CMP(size_t)
+DEFINE_HASH(size_t)
 
 // === Floating-point types ===
 DEFINE_DUP(float)
-DEFINE_PRINT(float, "%g")
+DEFINE_FORMAT(float, double, cformat_general)
+DEFINE_PRINT(float)
 DEFINE_CMP(float)
+DEFINE_HASH_FLOATING(float, uint32_t)
 
 DEFINE_DUP(double)
-DEFINE_PRINT(double, "%g")
+DEFINE_FORMAT(double, double, cformat_general)
+DEFINE_PRINT(double)
 DEFINE_CMP(double)
+DEFINE_HASH_FLOATING(double, uint64_t)
+
+// Duplicate a POD value of the given size [used by ctype_create_pod]
+static void *dup_pod(const void *item, size_t size);
 
 // === String type ===
 static void *dup_string(const void *item);
 static int cmp_string(const void *item1, const void *item2);
 static void print_string(const void *item);
+static size_t format_string(const void *item, char *buf, size_t cap);
+static size_t hash_string(const void *item);
+static void *dup_with_string(const void *item, const callocator *alloc);
+static void destroy_with_string(void *item, const callocator *alloc);
+// === SSO string type ===
+static bool sso_store(void *slot, const void *item, const callocator *alloc);
+static const void *sso_value(const void *slot);
+static void sso_release(void *slot, const callocator *alloc);
+static size_t sso_find(const void *slots, size_t n, const void *item,
+                       bool last, size_t *count);
+static inline bool sso_equal(const unsigned char *slot, const char *str,
+                             size_t len);
+// === Interned string type ===
+static void *dup_interned(const void *item);
+static void destroy_interned(void *item);
+static void *dup_with_interned(const void *item, const callocator *alloc);
+static void destroy_with_interned(void *item, const callocator *alloc);
+static int cmp_interned(const void *item1, const void *item2);
+static const void *canonical_interned(const void *item);
+static size_t serialize_string(const void *item, void *buf, size_t cap);
+static void *deserialize_string(const void *buf, size_t len);
+static void *deserialize_interned(const void *buf, size_t len);
 
 ctype *ctype_create(size_t size,
                     void *(*dup)(const void *),
@@ -91,15 +196,110 @@ ctype *ctype_create(size_t size,
   }
   
   type->size = size;
+  type->pod = false;
   type->dup = dup;
   type->destroy = destroy;
   type->print = print;
   type->cmp = cmp;
+  type->hash = NULL;
+  type->dup_with = NULL;
+  type->destroy_with = NULL;
+  type->slab = NULL;
+  type->string = false;
+  type->slot_size = 0;
+  type->slot_store = NULL;
+  type->slot_value = NULL;
+  type->slot_release = NULL;
+  type->slot_find = NULL;
+  type->canonical = NULL;
+  type->serialize = NULL;
+  type->deserialize = NULL;
+  type->format = NULL;
+  return type;
+}
+
+ctype *ctype_create_pod(size_t size,
+                        void (*print)(const void *),
+                        int (*cmp)(const void *, const void *)) {
+  ASSERT_MSG(size, "The size of a POD ctype cannot be zero!");
+  ASSERT_NOT_NULL(print, NULL);
+  ASSERT_NOT_NULL(cmp, NULL);
+
+  ctype *type = malloc(sizeof(*type));
+  if (!type) {
+    ALLOC_ERROR("ctype");
+  }
+
+  type->size = size;
+  type->pod = true;
+  type->dup = NULL;
+  type->destroy = free;
+  type->print = print;
+  type->cmp = cmp;
+  type->hash = NULL;
+  type->dup_with = NULL;
+  type->destroy_with = NULL;
+  type->slab = NULL;
+  type->string = false;
+  type->slot_size = 0;
+  type->slot_store = NULL;
+  type->slot_value = NULL;
+  type->slot_release = NULL;
+  type->slot_find = NULL;
+  type->canonical = NULL;
+  type->serialize = NULL;
+  type->deserialize = NULL;
+  type->format = NULL;
+  return type;
+}
+
+ctype *ctype_create_slab(size_t size,
+                         void (*print)(const void *),
+                         int (*cmp)(const void *, const void *)) {
+  ASSERT_MSG(size, "The size of a POD ctype cannot be zero!");
+  ASSERT_NOT_NULL(print, NULL);
+  ASSERT_NOT_NULL(cmp, NULL);
+
+  ctype *type = ctype_create_pod(size, print, cmp);
+  type->destroy = NULL;
+  type->slab = callocator_create_slab(size);
   return type;
 }
 
+void ctype_set_hash(ctype *type, size_t (*hash)(const void *)) {
+  ASSERT_NOT_NULL(type, NULL);
+  type->hash = hash;
+}
+
+void ctype_set_alloc(ctype *type,
+                     void *(*dup_with)(const void *, const callocator *),
+                     void (*destroy_with)(void *, const callocator *)) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(!dup_with == !destroy_with,
+             "dup_with and destroy_with must be set together!");
+  type->dup_with = dup_with;
+  type->destroy_with = destroy_with;
+}
+
+void ctype_set_serialize(ctype *type,
+                         size_t (*serialize)(const void *, void *, size_t),
+                         void *(*deserialize)(const void *, size_t)) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(!serialize == !deserialize,
+             "serialize and deserialize must be set together!");
+  type->serialize = serialize;
+  type->deserialize = deserialize;
+}
+
+void ctype_set_format(ctype *type, 
+                      size_t (*format)(const void *, char *, size_t)) {
+  ASSERT_NOT_NULL(type, NULL);
+  type->format = format;
+}
+
 void ctype_destroy(ctype *type) {
   if (type) {
+    callocator_destroy(type->slab);
     free(type);
   }
 }
@@ -110,6 +310,31 @@ bool ctype_equals(const ctype *t1, const ctype *t2) {
   return (t1 == t2);
 }
 
+bool ctype_is_pod(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->pod;
+}
+
+bool ctype_has_hash(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->hash != NULL;
+}
+
+bool ctype_has_format(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->format != NULL;
+}
+
+bool ctype_has_serialize(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->serialize != NULL || type->pod;
+}
+
+bool ctype_is_string(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->string;
+}
+
 size_t data_size(const ctype *type) {
   ASSERT_NOT_NULL(type, NULL);
   return type->size;
@@ -118,12 +343,74 @@ size_t data_size(const ctype *type) {
 void *data_dup(const void *item, const ctype *type) {
   ASSERT_NOT_NULL(item, NULL);
   ASSERT_NOT_NULL(type, NULL);
-  return (item ? type->dup(item) : NULL);
+  if (!item) {
+    return NULL;
+  }
+  if (type->slab) {
+    return data_dup_with(item, type, type->slab);
+  }
+  COUNT_CALL(dups);
+  if (!type->dup) {
+    return dup_pod(item, type->size);
+  }
+  return type->dup(item);
 }
 
 void data_destroy(void *item, const ctype *type) {
   ASSERT_NOT_NULL(type, NULL);
-  if (item) {
+  if (!item) {
+    return;
+  }
+  if (type->slab) {
+    data_destroy_with(item, type, type->slab);
+  } else {
+    COUNT_CALL(destroys);
+    type->destroy(item);
+  }
+}
+
+void *data_dup_with(const void *item, const ctype *type,
+                    const callocator *alloc) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(alloc, NULL);
+  if (!item) {
+    return NULL;
+  }
+  if (alloc == callocator_default()) {
+    return data_dup(item, type);
+  }
+  if (type->dup_with) {
+    COUNT_CALL(dups);
+    return type->dup_with(item, alloc);
+  }
+  if (type->pod) {
+    COUNT_CALL(dups);
+    void *copy = callocator_alloc(alloc, type->size);
+    if (copy) {
+      memcpy(copy, item, type->size);
+    }
+    return copy;
+  }
+  return data_dup(item, type);
+}
+
+void data_destroy_with(void *item, const ctype *type,
+                       const callocator *alloc) {
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(alloc, NULL);
+  if (!item) {
+    return;
+  }
+  if (alloc == callocator_default()) {
+    data_destroy(item, type);
+    return;
+  }
+  COUNT_CALL(destroys);
+  if (type->destroy_with) {
+    type->destroy_with(item, alloc);
+  } else if (type->pod) {
+    callocator_release(alloc, item, type->size);
+  } else {
     type->destroy(item);
   }
 }
@@ -140,17 +427,150 @@ int data_cmp(const void *item1, const void *item2, const ctype *type) {
   ASSERT_NOT_NULL(item1, NULL);
   ASSERT_NOT_NULL(item2, NULL);
   ASSERT_NOT_NULL(type, NULL);
+  COUNT_CALL(cmps);
   return type->cmp(item1, item2);
 }
 
+void ctype_stats(ctype_counters *out) {
+  ASSERT_NOT_NULL(out, NULL);
+#if CALIST_STATS
+  out->dups = __atomic_load_n(&counters.dups, __ATOMIC_RELAXED);
+  out->destroys = __atomic_load_n(&counters.destroys, __ATOMIC_RELAXED);
+  out->cmps = __atomic_load_n(&counters.cmps, __ATOMIC_RELAXED);
+#else
+  memset(out, 0, sizeof(*out));
+#endif
+}
+
+void ctype_stats_reset(void) {
+#if CALIST_STATS
+  __atomic_store_n(&counters.dups, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&counters.destroys, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&counters.cmps, 0, __ATOMIC_RELAXED);
+#endif
+}
+
+size_t data_format(const void *item, char *buf, size_t cap, 
+                   const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_MSG(buf || cap == 0, "buf cannot be NULL if cap > 0!");
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->format, "ctype has no format method!");
+  return type->format(item, buf, cap);
+}
+
+size_t data_hash(const void *item, const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->hash, "ctype has no hash method!");
+  return type->hash(item);
+}
+
+size_t data_slot_size(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->slot_size;
+}
+
+bool data_slot_store(void *slot, const void *item, const ctype *type,
+                     const callocator *alloc) {
+  ASSERT_NOT_NULL(slot, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(alloc, NULL);
+  ASSERT_MSG(type->slot_size, "ctype has no slot representation!");
+  return type->slot_store(slot, item, alloc);
+}
+
+const void *data_slot_value(const void *slot, const ctype *type) {
+  ASSERT_NOT_NULL(slot, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->slot_size, "ctype has no slot representation!");
+  return type->slot_value(slot);
+}
+
+void data_slot_release(void *slot, const ctype *type,
+                       const callocator *alloc) {
+  ASSERT_NOT_NULL(slot, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(alloc, NULL);
+  ASSERT_MSG(type->slot_size, "ctype has no slot representation!");
+  type->slot_release(slot, alloc);
+}
+
+size_t data_slot_find(const void *slots, size_t n, const void *item,
+                      const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->slot_size, "ctype has no slot representation!");
+  return type->slot_find(slots, n, item, false, NULL);
+}
+
+size_t data_slot_find_last(const void *slots, size_t n, const void *item,
+                           const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->slot_size, "ctype has no slot representation!");
+  return type->slot_find(slots, n, item, true, NULL);
+}
+
+size_t data_slot_count(const void *slots, size_t n, const void *item,
+                       const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->slot_size, "ctype has no slot representation!");
+  size_t count = 0;
+  type->slot_find(slots, n, item, false, &count);
+  return count;
+}
+
+size_t data_serialize(const void *item, void *buf, size_t cap,
+                      const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_MSG(buf || cap == 0, "buf cannot be NULL if cap > 0!");
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(ctype_has_serialize(type), "ctype cannot be serialized!");
+  if (type->serialize) {
+    return type->serialize(item, buf, cap);
+  }
+  if (type->size <= cap) {
+    memcpy(buf, item, type->size);
+  }
+  return type->size;
+}
+
+void *data_deserialize(const void *buf, size_t len, const ctype *type) {
+  ASSERT_MSG(buf || len == 0, "buf cannot be NULL if len > 0!");
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(ctype_has_serialize(type), "ctype cannot be serialized!");
+  if (type->deserialize) {
+    return type->deserialize(buf, len);
+  }
+  return (len == type->size) ? data_dup(buf, type) : NULL;
+}
+
+bool ctype_has_canonical(const ctype *type) {
+  ASSERT_NOT_NULL(type, NULL);
+  return type->canonical != NULL;
+}
+
+const void *data_canonical(const void *item, const ctype *type) {
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_MSG(type->canonical, "ctype has no canonical values!");
+  return type->canonical(item);
+}
+
 // === Integral types ===
 const ctype *ctype_int(void) {
   static const ctype int_type = {
     .size = sizeof(int),
+    .pod = true,
     .dup = dup_int,
     .destroy = free,
     .print = print_int,
+    .format = format_int,
     .cmp = cmp_int,
+    .hash = hash_int,
   };
   return &int_type;
 }
@@ -158,10 +578,13 @@ const ctype *ctype_int(void) {
 const ctype *ctype_long(void) {
   static const ctype long_type = {
     .size = sizeof(long),
+    .pod = true,
     .dup = dup_long,
     .destroy = free,
     .print = print_long,
+    .format = format_long,
     .cmp = cmp_long,
+    .hash = hash_long,
   };
   return &long_type;
 }
@@ -169,10 +592,13 @@ const ctype *ctype_long(void) {
 const ctype *ctype_char(void) {
   static const ctype char_type = {
     .size = sizeof(char),
+    .pod = true,
     .dup = dup_char,
     .destroy = free,
     .print = print_char,
+    .format = format_char,
     .cmp = cmp_char,
+    .hash = hash_char,
   };
   return &char_type;
 }
@@ -180,10 +606,13 @@ const ctype *ctype_char(void) {
 const ctype *ctype_bool(void) {
   static const ctype bool_type = {
     .size = sizeof(bool),
+    .pod = true,
     .dup = dup_bool,
     .destroy = free,
     .print = print_bool,
+    .format = format_bool,
     .cmp = cmp_bool,
+    .hash = hash_bool,
   };
   return &bool_type;
 }
@@ -191,10 +620,13 @@ const ctype *ctype_bool(void) {
 const ctype *ctype_size_t(void) {
   static const ctype size_t_type = {
     .size = sizeof(size_t),
+    .pod = true,
     .dup = dup_size_t,
     .destroy = free,
     .print = print_size_t,
+    .format = format_size_t,
     .cmp = cmp_size_t,
+    .hash = hash_size_t,
   };
   return &size_t_type;
 }
@@ -203,10 +635,13 @@ const ctype *ctype_size_t(void) {
 const ctype *ctype_float(void) {
   static const ctype float_type = {
     .size = sizeof(float),
+    .pod = true,
     .dup = dup_float,
     .destroy = free,
     .print = print_float,
+    .format = format_float,
     .cmp = cmp_float,
+    .hash = hash_float,
   };
   return &float_type;
 }
@@ -214,10 +649,13 @@ const ctype *ctype_float(void) {
 const ctype *ctype_double(void) {
   static const ctype double_type = {
     .size = sizeof(double),
+    .pod = true,
     .dup = dup_double,
     .destroy = free,
     .print = print_double,
+    .format = format_double,
     .cmp = cmp_double,
+    .hash = hash_double,
   };
   return &double_type;
 }
@@ -226,19 +664,100 @@ const ctype *ctype_double(void) {
 const ctype *ctype_string(void) {
   static const ctype string_type = {
     .size = sizeof(char *),
+    .pod = false,
     .dup = dup_string,
     .destroy = free,
     .print = print_string,
+    .format = format_string,
     .cmp = cmp_string,
+    .hash = hash_string,
+    .dup_with = dup_with_string,
+    .destroy_with = destroy_with_string,
+    .string = true,
+    .serialize = serialize_string,
+    .deserialize = deserialize_string,
   };
   return &string_type;
 }
 
+// An SSO slot holds either the characters and their length, or a heap 
+//   copy with its length [tagged by the last byte]
+#define SSO_SLOT_SIZE 24
+#define SSO_MAX_INLINE (SSO_SLOT_SIZE - 2)
+#define SSO_HEAP_TAG 0xFF
+
+const ctype *ctype_sso_string(void) {
+  static const ctype sso_string_type = {
+    .size = sizeof(char *),
+    .pod = false,
+    .dup = dup_string,
+    .destroy = free,
+    .print = print_string,
+    .format = format_string,
+    .cmp = cmp_string,
+    .hash = hash_string,
+    .dup_with = dup_with_string,
+    .destroy_with = destroy_with_string,
+    .string = true,
+    .slot_size = SSO_SLOT_SIZE,
+    .slot_store = sso_store,
+    .slot_value = sso_value,
+    .slot_release = sso_release,
+    .slot_find = sso_find,
+    .serialize = serialize_string,
+    .deserialize = deserialize_string,
+  };
+  return &sso_string_type;
+}
+
+const ctype *ctype_interned_string(void) {
+  static const ctype interned_string_type = {
+    .size = sizeof(char *),
+    .pod = false,
+    .dup = dup_interned,
+    .destroy = destroy_interned,
+    .print = print_string,
+    .format = format_string,
+    .cmp = cmp_interned,
+    .hash = hash_string,
+    .dup_with = dup_with_interned,
+    .destroy_with = destroy_with_interned,
+    .string = true,
+    .canonical = canonical_interned,
+    .serialize = serialize_string,
+    .deserialize = deserialize_interned,
+  };
+  return &interned_string_type;
+}
+
 // Helper function implementation
-static void print_bool(const void *item) {
+static size_t format_char(const void *item, char *buf, size_t cap) {
+  ASSERT_NOT_NULL(item, NULL);
+  if (cap >= 1) {
+    *buf = *(const char *) item;
+  }
+  return 1;
+}
+
+static size_t format_bool(const void *item, char *buf, size_t cap) {
   ASSERT_NOT_NULL(item, NULL);
   const bool *bool_ptr = item;
-  printf(*bool_ptr ? "true" : "false");
+  const char *text = *bool_ptr ? "true" : "false";
+  size_t len = strlen(text);
+  if (len <= cap) {
+    memcpy(buf, text, len);
+  }
+  return len;
+}
+
+static void *dup_pod(const void *item, size_t size) {
+  ASSERT_NOT_NULL(item, NULL);
+  void *copy = malloc(size);
+  if (!copy) {
+    return NULL;
+  }
+  memcpy(copy, item, size);
+  return copy;
 }
 
 static void *dup_string(const void *item) {
@@ -265,6 +784,187 @@ static int cmp_string(const void *s1, const void *s2) {
 
 static void print_string(const void *item) {
   ASSERT_NOT_NULL(item, NULL);
-  const char *str = item;
-  printf("%s", str);
+  fputs(item, stdout);
+}
+
+static size_t format_string(const void *item, char *buf, size_t cap) {
+  ASSERT_NOT_NULL(item, NULL);
+  size_t len = strlen(item);
+  if (len <= cap) {
+    memcpy(buf, item, len);
+  }
+  return len;
+}
+
+static size_t hash_string(const void *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  return cintern_hash(item);
+}
+
+static void *dup_with_string(const void *item, const callocator *alloc) {
+  ASSERT_NOT_NULL(item, NULL);
+  size_t size = strlen(item) + 1;
+  char *dup_str = callocator_alloc(alloc, size);
+  if (!dup_str) {
+    return NULL;
+  }
+  memcpy(dup_str, item, size);
+  return dup_str;
+}
+
+static void destroy_with_string(void *item, const callocator *alloc) {
+  ASSERT_NOT_NULL(item, NULL);
+  callocator_release(alloc, item, strlen(item) + 1);
+}
+
+// A string is serialized as its characters, without the null terminator
+static size_t serialize_string(const void *item, void *buf, size_t cap) {
+  ASSERT_NOT_NULL(item, NULL);
+  size_t len = strlen(item);
+  if (len <= cap) {
+    memcpy(buf, item, len);
+  }
+  return len;
+}
+
+static void *deserialize_string(const void *buf, size_t len) {
+  if (len == SIZE_MAX || (len > 0 && memchr(buf, '\0', len))) {
+    return NULL;
+  }
+  char *str = malloc(len + 1);
+  if (!str) {
+    return NULL;
+  }
+  if (len > 0) {
+    memcpy(str, buf, len);
+  }
+  str[len] = '\0';
+  return str;
+}
+
+// === SSO string type ===
+static bool sso_store(void *slot, const void *item, const callocator *alloc) {
+  unsigned char *bytes = slot;
+  size_t len = strlen(item);
+  if (len <= SSO_MAX_INLINE) {
+    memcpy(bytes, item, len + 1);
+    bytes[SSO_SLOT_SIZE - 1] = (unsigned char) len;
+    return true;
+  }
+
+  char *heap_str = callocator_alloc(alloc, len + 1);
+  if (!heap_str) {
+    return false;
+  }
+  memcpy(heap_str, item, len + 1);
+  memcpy(bytes, &heap_str, sizeof(heap_str));
+  memcpy(bytes + sizeof(heap_str), &len, sizeof(len));
+  bytes[SSO_SLOT_SIZE - 1] = SSO_HEAP_TAG;
+  return true;
+}
+
+static const void *sso_value(const void *slot) {
+  const unsigned char *bytes = slot;
+  if (bytes[SSO_SLOT_SIZE - 1] != SSO_HEAP_TAG) {
+    return bytes;
+  }
+  char *heap_str;
+  memcpy(&heap_str, bytes, sizeof(heap_str));
+  return heap_str;
+}
+
+static void sso_release(void *slot, const callocator *alloc) {
+  unsigned char *bytes = slot;
+  if (bytes[SSO_SLOT_SIZE - 1] != SSO_HEAP_TAG) return;
+
+  char *heap_str;
+  size_t len;
+  memcpy(&heap_str, bytes, sizeof(heap_str));
+  memcpy(&len, bytes + sizeof(heap_str), sizeof(len));
+  callocator_release(alloc, heap_str, len + 1);
+}
+
+// Scan n slots for item: produce the first (or last) match, or n; if 
+//   count is not NULL, count all matches instead
+static size_t sso_find(const void *slots, size_t n, const void *item,
+                       bool last, size_t *count) {
+  const unsigned char *base = slots;
+  size_t len = strlen(item);
+  if (count) {
+    *count = 0;
+    for (size_t i = 0; i < n; ++i) {
+      *count += sso_equal(base + i * SSO_SLOT_SIZE, item, len);
+    }
+    return n;
+  }
+  if (last) {
+    for (size_t i = n; i-- > 0;) {
+      if (sso_equal(base + i * SSO_SLOT_SIZE, item, len)) return i;
+    }
+    return n;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (sso_equal(base + i * SSO_SLOT_SIZE, item, len)) return i;
+  }
+  return n;
+}
+
+// Compare the cached length of slot before its characters
+static inline bool sso_equal(const unsigned char *slot, const char *str,
+                             size_t len) {
+  unsigned char tag = slot[SSO_SLOT_SIZE - 1];
+  if (tag != SSO_HEAP_TAG) {
+    return tag == len && !memcmp(slot, str, len);
+  }
+  size_t heap_len;
+  memcpy(&heap_len, slot + sizeof(char *), sizeof(heap_len));
+  if (heap_len != len) {
+    return false;
+  }
+  char *heap_str;
+  memcpy(&heap_str, slot, sizeof(heap_str));
+  return !memcmp(heap_str, str, len);
+}
+
+// === Interned string type ===
+// Interned values are shared by every storage ADT, so they never come 
+//   from a client allocator
+static void *dup_interned(const void *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  return (void *) cintern_acquire(item);
+}
+
+static void destroy_interned(void *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  cintern_release(item);
+}
+
+static void *dup_with_interned(const void *item, const callocator *alloc) {
+  (void) alloc;
+  return dup_interned(item);
+}
+
+static void destroy_with_interned(void *item, const callocator *alloc) {
+  (void) alloc;
+  destroy_interned(item);
+}
+
+static int cmp_interned(const void *s1, const void *s2) {
+  ASSERT_NOT_NULL(s1, "The first string");
+  ASSERT_NOT_NULL(s2, "The second string");
+  return (s1 == s2) ? 0 : strcmp(s1, s2);
+}
+
+static const void *canonical_interned(const void *item) {
+  return cintern_lookup(item);
+}
+
+static void *deserialize_interned(const void *buf, size_t len) {
+  char *str = deserialize_string(buf, len);
+  if (!str) {
+    return NULL;
+  }
+  const char *interned = cintern_acquire(str);
+  free(str);
+  return (void *) interned;
 }
@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ctypeitem.h"
+#include "citem.h"
+#include "cerror.h"
+
+ctypeitem *ctypeitem_create(const void *value, const ctype *type) {
+  ASSERT_NOT_NULL(value, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+
+  ctypeitem *item = malloc(sizeof(*item));
+  if (!item) {
+    ALLOC_ERROR("ctypeitem");
+  }
+  citem_store(item, value, type);
+  return item;
+}
+
+ctypeitem *ctypeitem_destroy(ctypeitem *item) {
+  if (!item) return NULL;
+  ASSERT_MSG(item->storage != CTYPEITEM_BORROWED,
+             "Temporary ctypeitems cannot be destroyed!");
+  citem_release(item);
+  free(item);
+  return NULL;
+}
+
+ctypeitem *ctypeitem_dup(const ctypeitem *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  return ctypeitem_create(ctypeitem_value(item), item->type);
+}
+
+bool ctypeitem_equals(const ctypeitem *i1, const ctypeitem *i2) {
+  ASSERT_NOT_NULL(i1, "The first ctypeitem");
+  ASSERT_NOT_NULL(i2, "The second ctypeitem");
+  return ctype_equals(i1->type, i2->type) &&
+         data_cmp(ctypeitem_value(i1), ctypeitem_value(i2), i1->type) == 0;
+}
+
+const void *ctypeitem_value(const ctypeitem *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  return (item->storage == CTYPEITEM_INLINE) ? item->payload.bytes 
+                                             : item->payload.ptr;
+}
+
+void *ctypeitem_value_mutable(ctypeitem *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  return (item->storage == CTYPEITEM_INLINE) ? item->payload.bytes 
+                                             : item->payload.ptr;
+}
+
+const ctype *ctypeitem_type(const ctypeitem *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  return item->type;
+}
+
+void ctypeitem_print(const ctypeitem *item) {
+  ASSERT_NOT_NULL(item, NULL);
+  data_print(ctypeitem_value(item), item->type);
+}
+
+void citem_store(ctypeitem *item, const void *value, const ctype *type) {
+  item->type = type;
+  if (ctype_is_pod(type) && data_size(type) <= CTYPEITEM_INLINE_SIZE) {
+    item->storage = CTYPEITEM_INLINE;
+    memcpy(item->payload.bytes, value, data_size(type));
+    return;
+  }
+  item->storage = CTYPEITEM_HEAP;
+  item->payload.ptr = data_dup(value, type);
+  if (!item->payload.ptr) {
+    FATAL_ERROR("Failed to duplicate item!");
+  }
+}
+
+void citem_release(ctypeitem *item) {
+  if (item->storage == CTYPEITEM_HEAP) {
+    data_destroy(item->payload.ptr, item->type);
+  }
+}
+
+int citem_cmp(const ctypeitem *i1, const ctypeitem *i2) {
+  if (!ctype_equals(i1->type, i2->type)) {
+    return ((uintptr_t) i1->type < (uintptr_t) i2->type) ? -1 : 1;
+  }
+  return data_cmp(ctypeitem_value(i1), ctypeitem_value(i2), i1->type);
+}
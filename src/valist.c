@@ -0,0 +1,1057 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "valist.h"
+#include "citem.h"
+#include "cerror.h"
+#include "csort.h"
+#include "ckernel.h"
+
+// The items of one ctype in a columnar valist, in list order
+typedef struct {
+  const ctype *type;
+  ckernel_kind kernel;    // CKERNEL_NONE unless type is a built-in ctype
+  size_t width;           // the size of the values, or 0 if not copied
+  unsigned char *values;  // dense copies of the values of a POD ctype
+  size_t *positions;      // the indices of the items in the valist
+  size_t size;
+  size_t capacity;
+} column;
+
+// Items are ctypeitem records stored contiguously in items: values of
+//   small POD ctypes are held in the record, and other values in the heap
+//   [see citem_store]. Records own their values and are moved with memcpy.
+//
+// A columnar valist also indexes its items by ctype in columns. Appends
+//   extend the columns; any other modification marks them stale, and the
+//   next scan that needs them rebuilds them from items.
+struct valist {
+  ctypeitem *items;
+  size_t size;
+  size_t capacity;
+  bool columnar;
+  bool stale;
+  column *columns;
+  size_t column_count;
+  size_t column_capacity;
+};
+
+const size_t VALIST_INDEX_NOT_FOUND = SIZE_MAX;
+
+static const size_t DEFAULT_INIT_CAPACITY = 1;
+
+// Assertion messages
+static const char *ASSERT_VALIST_NOT_EMPTY
+  = "valist cannot be empty!";
+static const char *ASSERT_INDEX_BOUNDED
+  = "Index cannot exceed (valist_size - 1)!";
+static const char *ASSERT_INDEX_BOUNDED_INCLUSIVE
+  = "Index cannot exceed valist_size!";
+static const char *ASSERT_INDEX_END_AFTER_START
+  = "The end index must be greater than or equal to the start index!";
+
+// Helper function declaration
+static valist *create_size(size_t init_cap);
+static valist *copy_range(const valist *al, size_t from, size_t to);
+static void resize_items(valist *al, size_t n);
+static void grow_to_fit(valist *al, size_t needed);
+static void open_slots(valist *al, size_t index, size_t count);
+static void close_slots(valist *al, size_t index, size_t count);
+static bool in_storage(const valist *al, const ctypeitem *item);
+static size_t find_in(const valist *al, size_t from, const ctypeitem *item);
+static size_t find_last_in(const valist *al, size_t end,
+                           const ctypeitem *item);
+static bool *mark_unique(const valist *al);
+static int cmp_indices(const void *a, const void *b, const void *ctx);
+static inline void mark_stale(const valist *al);
+static inline bool columns_ready(const valist *al);
+static void refresh_columns(const valist *al);
+static void rebuild_columns(valist *al);
+static void free_columns(valist *al);
+static column *column_of(const valist *al, const ctype *type);
+static column *add_column(valist *al, const ctype *type);
+static void index_item(valist *al, size_t index);
+static void column_push(column *col, const ctypeitem *item, size_t index);
+static size_t column_seek(const column *col, size_t index);
+static size_t column_find(const valist *al, const column *col, size_t from,
+                          const ctypeitem *item);
+static size_t column_find_last(const valist *al, const column *col,
+                               size_t end, const ctypeitem *item);
+static inline const void *column_value(const valist *al, const column *col,
+                                       size_t i);
+
+valist *valist_create(void) {
+  return create_size(DEFAULT_INIT_CAPACITY);
+}
+
+void valist_destroy(valist *al) {
+  if (!al) return;
+
+  for (size_t i = 0; i < al->size; ++i) {
+    citem_release(&al->items[i]);
+  }
+  free_columns(al);
+  free(al->items);
+  free(al);
+}
+
+void valist_clear(valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  for (size_t i = 0; i < al->size; ++i) {
+    citem_release(&al->items[i]);
+  }
+  al->size = 0;
+  mark_stale(al);
+}
+
+valist *valist_dup(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  valist *dup = copy_range(al, 0, al->size);
+  dup->columnar = al->columnar;
+  return dup;
+}
+
+void valist_print(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  printf("[");
+  for (size_t i = 0; i < al->size; ++i) {
+    if (i != 0) {
+      printf(", ");
+    }
+    ctypeitem_print(&al->items[i]);
+  }
+  printf("]\n");
+}
+
+bool valist_equals(const valist *l1, const valist *l2) {
+  ASSERT_NOT_NULL(l1, "The first valist");
+  ASSERT_NOT_NULL(l2, "The second valist");
+
+  if (l1->size != l2->size) {
+    return false;
+  }
+  for (size_t i = 0; i < l1->size; ++i) {
+    if (!ctypeitem_equals(&l1->items[i], &l2->items[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t valist_size(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->size;
+}
+
+bool valist_empty(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->size == 0;
+}
+
+size_t valist_capacity(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->capacity;
+}
+
+void valist_reserve(valist *al, size_t n) {
+  ASSERT_NOT_NULL(al, NULL);
+  if (n > al->capacity) {
+    resize_items(al, n);
+  }
+}
+
+void valist_reclaim(valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  // An empty valist keeps one record so that its storage stays valid
+  size_t n = al->size ? al->size : 1;
+  if (n != al->capacity) {
+    resize_items(al, n);
+  }
+}
+
+const ctypeitem *valist_get(const valist *al, size_t index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
+  return &al->items[index];
+}
+
+ctypeitem *valist_get_mutable(const valist *al, size_t index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
+
+  // The value may be modified through the result
+  mark_stale(al);
+  return &al->items[index];
+}
+
+void valist_set(valist *al, size_t index, const ctypeitem *new_item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_NOT_NULL(new_item, "The new item");
+
+  // new_item may be the item being replaced
+  ctypeitem copy;
+  citem_store(&copy, ctypeitem_value(new_item), new_item->type);
+  citem_release(&al->items[index]);
+  al->items[index] = copy;
+  mark_stale(al);
+}
+
+void valist_swap(valist *al, size_t i, size_t j) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(i < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(j < al->size, ASSERT_INDEX_BOUNDED);
+
+  ctypeitem temp = al->items[i];
+  al->items[i] = al->items[j];
+  al->items[j] = temp;
+  mark_stale(al);
+}
+
+void valist_append(valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  valist_insert(al, al->size, item);
+}
+
+void valist_append_all(valist *al, const valist *src) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(src, NULL);
+  valist_insert_all(al, al->size, src);
+}
+
+void valist_insert(valist *al, size_t index, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  ASSERT_MSG(index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  // The copy is made first, as item may be a record of al that moves
+  ctypeitem copy;
+  citem_store(&copy, ctypeitem_value(item), item->type);
+  bool at_end = (index == al->size);
+  open_slots(al, index, 1);
+  al->items[index] = copy;
+
+  if (at_end) {
+    index_item(al, index);
+  } else {
+    mark_stale(al);
+  }
+}
+
+void valist_insert_front(valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  valist_insert(al, 0, item);
+}
+
+void valist_insert_all(valist *al, size_t index, const valist *src) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(src, NULL);
+  ASSERT_MSG(index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  // Inserting al into itself reads from a stable copy
+  valist *self_copy = NULL;
+  if (src == al) {
+    self_copy = valist_dup(al);
+    src = self_copy;
+  }
+  size_t n = src->size;
+  bool at_end = (index == al->size);
+  open_slots(al, index, n);
+  for (size_t i = 0; i < n; ++i) {
+    const ctypeitem *item = &src->items[i];
+    citem_store(&al->items[index + i], ctypeitem_value(item), item->type);
+    if (at_end) {
+      index_item(al, index + i);
+    }
+  }
+  if (!at_end && n > 0) {
+    mark_stale(al);
+  }
+  valist_destroy(self_copy);
+}
+
+void valist_pop(valist *al, size_t index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(index < al->size, ASSERT_INDEX_BOUNDED);
+
+  citem_release(&al->items[index]);
+  close_slots(al, index, 1);
+  mark_stale(al);
+}
+
+size_t valist_remove(valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t index = find_in(al, 0, item);
+  if (index != VALIST_INDEX_NOT_FOUND) {
+    valist_pop(al, index);
+  }
+  return index;
+}
+
+size_t valist_remove_last(valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_NOT_NULL(item, NULL);
+
+  size_t index = find_last_in(al, al->size, item);
+  if (index != VALIST_INDEX_NOT_FOUND) {
+    valist_pop(al, index);
+  }
+  return index;
+}
+
+size_t valist_remove_all(valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_NOT_NULL(item, NULL);
+
+  // item may be a record of al, which is released or moved while
+  //   compacting
+  ctypeitem copy;
+  bool copied = in_storage(al, item);
+  if (copied) {
+    citem_store(&copy, ctypeitem_value(item), item->type);
+    item = &copy;
+  }
+
+  size_t write = 0;
+  for (size_t read = 0; read < al->size; ++read) {
+    if (ctypeitem_equals(&al->items[read], item)) {
+      citem_release(&al->items[read]);
+    } else {
+      al->items[write++] = al->items[read];
+    }
+  }
+  if (copied) {
+    citem_release(&copy);
+  }
+
+  size_t total = al->size - write;
+  al->size = write;
+  if (total > 0) {
+    mark_stale(al);
+  }
+  return total;
+}
+
+size_t valist_remove_if(valist *al, valist_pred pred, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  // While pred runs, al holds only the items kept so far
+  mark_stale(al);
+  size_t n = al->size;
+  size_t write = 0;
+  for (size_t read = 0; read < n; ++read) {
+    al->size = write;
+    if (pred(al, &al->items[read], args)) {
+      citem_release(&al->items[read]);
+    } else {
+      al->items[write++] = al->items[read];
+    }
+  }
+  al->size = write;
+  return n - write;
+}
+
+void valist_remove_range(valist *al, size_t from_index, size_t to_index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(from_index < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+
+  for (size_t i = from_index; i < to_index; ++i) {
+    citem_release(&al->items[i]);
+  }
+  close_slots(al, from_index, to_index - from_index);
+  mark_stale(al);
+}
+
+bool valist_contains(const valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  refresh_columns(al);
+  return find_in(al, 0, item) != VALIST_INDEX_NOT_FOUND;
+}
+
+size_t valist_index(const valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  refresh_columns(al);
+  return find_in(al, 0, item);
+}
+
+size_t valist_index_last(const valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+  refresh_columns(al);
+  return find_last_in(al, al->size, item);
+}
+
+valist *valist_index_all(const valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  refresh_columns(al);
+  valist *indices = valist_create();
+  for (size_t i = find_in(al, 0, item); i != VALIST_INDEX_NOT_FOUND;
+       i = find_in(al, i + 1, item)) {
+    valist_append(indices, CTYPEITEM(&i, ctype_size_t()));
+  }
+  return indices;
+}
+
+valist *valist_index_all_if(const valist *al, valist_pred pred,
+                            const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  valist *indices = valist_create();
+  for (size_t i = 0; i < al->size; ++i) {
+    if (pred(al, &al->items[i], args)) {
+      valist_append(indices, CTYPEITEM(&i, ctype_size_t()));
+    }
+  }
+  return indices;
+}
+
+size_t valist_count(const valist *al, const ctypeitem *item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(item, NULL);
+
+  refresh_columns(al);
+  if (columns_ready(al)) {
+    const column *col = column_of(al, item->type);
+    if (!col) {
+      return 0;
+    } else if (col->kernel != CKERNEL_NONE) {
+      return ckernel_count(col->kernel, col->values, col->size,
+                           ctypeitem_value(item));
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < col->size; ++i) {
+      total += data_cmp(column_value(al, col, i), ctypeitem_value(item),
+                        item->type) == 0;
+    }
+    return total;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < al->size; ++i) {
+    total += ctypeitem_equals(&al->items[i], item);
+  }
+  return total;
+}
+
+size_t valist_replace(valist *al, const ctypeitem *old_item,
+                      const ctypeitem *new_item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(old_item, "The original item");
+  ASSERT_NOT_NULL(new_item, "The new item");
+
+  size_t index = find_in(al, 0, old_item);
+  if (index != VALIST_INDEX_NOT_FOUND) {
+    valist_set(al, index, new_item);
+  }
+  return index;
+}
+
+size_t valist_replace_last(valist *al, const ctypeitem *old_item,
+                           const ctypeitem *new_item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(old_item, "The original item");
+  ASSERT_NOT_NULL(new_item, "The new item");
+
+  size_t index = find_last_in(al, al->size, old_item);
+  if (index != VALIST_INDEX_NOT_FOUND) {
+    valist_set(al, index, new_item);
+  }
+  return index;
+}
+
+size_t valist_replace_all(valist *al, const ctypeitem *old_item,
+                          const ctypeitem *new_item) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(old_item, "The original item");
+  ASSERT_NOT_NULL(new_item, "The new item");
+
+  // Either item may be a record of al that is replaced on the way
+  ctypeitem old_copy, new_copy;
+  citem_store(&old_copy, ctypeitem_value(old_item), old_item->type);
+  citem_store(&new_copy, ctypeitem_value(new_item), new_item->type);
+  size_t total = 0;
+  for (size_t i = find_in(al, 0, &old_copy); i != VALIST_INDEX_NOT_FOUND;
+       i = find_in(al, i + 1, &old_copy)) {
+    valist_set(al, i, &new_copy);
+    ++total;
+  }
+  citem_release(&old_copy);
+  citem_release(&new_copy);
+  return total;
+}
+
+size_t valist_replace_if(valist *al, const ctypeitem *new_item,
+                         valist_pred pred, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(new_item, "The replacement item");
+  ASSERT_NOT_NULL(pred, NULL);
+
+  ctypeitem new_copy;
+  citem_store(&new_copy, ctypeitem_value(new_item), new_item->type);
+  size_t total = 0;
+  for (size_t i = 0; i < al->size; ++i) {
+    if (pred(al, &al->items[i], args)) {
+      valist_set(al, i, &new_copy);
+      ++total;
+    }
+  }
+  citem_release(&new_copy);
+  return total;
+}
+
+void valist_reverse(valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  for (size_t i = 0; i < al->size / 2; ++i) {
+    valist_swap(al, i, al->size - i - 1);
+  }
+}
+
+valist *valist_slice(const valist *al, size_t from_index, size_t to_index) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_MSG(al->size > 0, ASSERT_VALIST_NOT_EMPTY);
+  ASSERT_MSG(from_index < al->size, ASSERT_INDEX_BOUNDED);
+  ASSERT_MSG(to_index >= from_index, ASSERT_INDEX_END_AFTER_START);
+  ASSERT_MSG(to_index <= al->size, ASSERT_INDEX_BOUNDED_INCLUSIVE);
+  return copy_range(al, from_index, to_index);
+}
+
+valist *valist_filter(const valist *al, valist_pred pred, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  valist *filtered = valist_create();
+  for (size_t i = 0; i < al->size; ++i) {
+    if (pred(al, &al->items[i], args)) {
+      valist_append(filtered, &al->items[i]);
+    }
+  }
+  return filtered;
+}
+
+void valist_foreach(const valist *al, valist_map map, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(map, NULL);
+
+  // map may modify the values
+  mark_stale(al);
+  for (size_t i = 0; i < al->size; ++i) {
+    map(al, &al->items[i], args);
+  }
+}
+
+valist *valist_unique(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  bool *keep = mark_unique(al);
+  valist *unique = valist_create();
+  for (size_t i = 0; i < al->size; ++i) {
+    if (keep[i]) {
+      valist_append(unique, &al->items[i]);
+    }
+  }
+  free(keep);
+  return unique;
+}
+
+size_t valist_remove_dup(valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  bool *keep = mark_unique(al);
+  size_t kept = 0;
+  for (size_t i = 0; i < al->size; ++i) {
+    if (keep[i]) {
+      al->items[kept++] = al->items[i];
+    } else {
+      citem_release(&al->items[i]);
+    }
+  }
+  free(keep);
+
+  size_t total = al->size - kept;
+  al->size = kept;
+  if (total > 0) {
+    mark_stale(al);
+  }
+  return total;
+}
+
+void valist_set_columnar(valist *al, bool columnar) {
+  ASSERT_NOT_NULL(al, NULL);
+
+  if (!columnar) {
+    free_columns(al);
+  }
+  al->columnar = columnar;
+  al->stale = true;
+}
+
+bool valist_columnar(const valist *al) {
+  ASSERT_NOT_NULL(al, NULL);
+  return al->columnar;
+}
+
+size_t valist_count_type(const valist *al, const ctype *type) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+
+  refresh_columns(al);
+  if (columns_ready(al)) {
+    const column *col = column_of(al, type);
+    return col ? col->size : 0;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < al->size; ++i) {
+    total += ctype_equals(al->items[i].type, type);
+  }
+  return total;
+}
+
+size_t valist_count_type_if(const valist *al, const ctype *type,
+                            valist_pred pred, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  refresh_columns(al);
+  size_t total = 0;
+  if (columns_ready(al)) {
+    const column *col = column_of(al, type);
+    for (size_t i = 0; col && i < col->size; ++i) {
+      total += pred(al, CTYPEITEM(column_value(al, col, i), type), args);
+    }
+    return total;
+  }
+
+  for (size_t i = 0; i < al->size; ++i) {
+    if (ctype_equals(al->items[i].type, type)) {
+      total += pred(al, &al->items[i], args);
+    }
+  }
+  return total;
+}
+
+valist *valist_filter_type(const valist *al, const ctype *type,
+                           valist_pred pred, const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(pred, NULL);
+
+  refresh_columns(al);
+  valist *filtered = valist_create();
+  if (columns_ready(al)) {
+    const column *col = column_of(al, type);
+    for (size_t i = 0; col && i < col->size; ++i) {
+      const ctypeitem *item = CTYPEITEM(column_value(al, col, i), type);
+      if (pred(al, item, args)) {
+        valist_append(filtered, item);
+      }
+    }
+    return filtered;
+  }
+
+  for (size_t i = 0; i < al->size; ++i) {
+    const ctypeitem *item = &al->items[i];
+    if (ctype_equals(item->type, type) && pred(al, item, args)) {
+      valist_append(filtered, item);
+    }
+  }
+  return filtered;
+}
+
+void valist_foreach_type(const valist *al, const ctype *type, valist_map map,
+                         const void *args) {
+  ASSERT_NOT_NULL(al, NULL);
+  ASSERT_NOT_NULL(type, NULL);
+  ASSERT_NOT_NULL(map, NULL);
+
+  refresh_columns(al);
+  if (columns_ready(al)) {
+    // map runs on the records, and copies of their values are updated
+    column *col = column_of(al, type);
+    for (size_t i = 0; col && i < col->size; ++i) {
+      ctypeitem *item = &al->items[col->positions[i]];
+      map(al, item, args);
+      if (col->width) {
+        memcpy(col->values + i * col->width, ctypeitem_value(item),
+               col->width);
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < al->size; ++i) {
+    if (ctype_equals(al->items[i].type, type)) {
+      map(al, &al->items[i], args);
+    }
+  }
+}
+
+// Helper function implementation
+static valist *create_size(size_t init_cap) {
+  valist *al = malloc(sizeof(*al));
+  if (!al) {
+    ALLOC_ERROR("valist");
+  }
+  if (init_cap > SIZE_MAX / sizeof(*al->items)) {
+    ALLOC_ERROR("valist with the given capacity");
+  }
+  al->items = malloc(sizeof(*al->items) * init_cap);
+  if (!al->items) {
+    ALLOC_ERROR("valist with the given capacity");
+  }
+  al->size = 0;
+  al->capacity = init_cap;
+  al->columnar = false;
+  al->stale = true;
+  al->columns = NULL;
+  al->column_count = 0;
+  al->column_capacity = 0;
+  return al;
+}
+
+// Produce a valist of copies of the items [from, to) of al
+static valist *copy_range(const valist *al, size_t from, size_t to) {
+  size_t range = to - from;
+  valist *sub = create_size(range ? range : DEFAULT_INIT_CAPACITY);
+  for (size_t i = 0; i < range; ++i) {
+    const ctypeitem *item = &al->items[from + i];
+    citem_store(&sub->items[i], ctypeitem_value(item), item->type);
+  }
+  sub->size = range;
+  return sub;
+}
+
+static void resize_items(valist *al, size_t n) {
+  if (n > SIZE_MAX / sizeof(*al->items)) {
+    ALLOC_ERROR("valist with the given capacity");
+  }
+  ctypeitem *items = realloc(al->items, sizeof(*items) * n);
+  if (!items) {
+    ALLOC_ERROR("valist with the given capacity");
+  }
+  al->items = items;
+  al->capacity = n;
+}
+
+// Grow al geometrically until it holds at least needed records
+static void grow_to_fit(valist *al, size_t needed) {
+  if (needed <= al->capacity) return;
+
+  size_t capacity = al->capacity;
+  while (capacity < needed) {
+    capacity = (capacity > SIZE_MAX / 2) ? needed : capacity * 2;
+  }
+  resize_items(al, capacity);
+}
+
+// Make room for count records at index, moving the records after it up
+static void open_slots(valist *al, size_t index, size_t count) {
+  if (count > SIZE_MAX - al->size) {
+    ALLOC_ERROR("valist with the given capacity");
+  }
+  grow_to_fit(al, al->size + count);
+  memmove(&al->items[index + count], &al->items[index],
+          sizeof(*al->items) * (al->size - index));
+  al->size += count;
+}
+
+// Remove the count released records at index, moving the records after it
+//   down
+static void close_slots(valist *al, size_t index, size_t count) {
+  memmove(&al->items[index], &al->items[index + count],
+          sizeof(*al->items) * (al->size - index - count));
+  al->size -= count;
+}
+
+// Check if item is one of the records of al, or refers to the value of 
+//   one
+static bool in_storage(const valist *al, const ctypeitem *item) {
+  uintptr_t begin = (uintptr_t) al->items;
+  uintptr_t end = begin + sizeof(*al->items) * al->capacity;
+  uintptr_t record = (uintptr_t) item;
+  uintptr_t value = (uintptr_t) ctypeitem_value(item);
+  return (record >= begin && record < end) || (value >= begin && value < end);
+}
+
+// Produce the first index position >= from of item in al,
+//   or VALIST_INDEX_NOT_FOUND
+static size_t find_in(const valist *al, size_t from, const ctypeitem *item) {
+  if (columns_ready(al)) {
+    const column *col = column_of(al, item->type);
+    return col ? column_find(al, col, from, item) : VALIST_INDEX_NOT_FOUND;
+  }
+  for (size_t i = from; i < al->size; ++i) {
+    if (ctypeitem_equals(&al->items[i], item)) {
+      return i;
+    }
+  }
+  return VALIST_INDEX_NOT_FOUND;
+}
+
+// Produce the last index position < end of item in al,
+//   or VALIST_INDEX_NOT_FOUND
+static size_t find_last_in(const valist *al, size_t end,
+                           const ctypeitem *item) {
+  if (columns_ready(al)) {
+    const column *col = column_of(al, item->type);
+    return col ? column_find_last(al, col, end, item) 
+               : VALIST_INDEX_NOT_FOUND;
+  }
+  for (size_t i = end; i > 0; --i) {
+    if (ctypeitem_equals(&al->items[i - 1], item)) {
+      return i - 1;
+    }
+  }
+  return VALIST_INDEX_NOT_FOUND;
+}
+
+// Produce flags marking the first occurrence of each item in al: stably
+//   sorting the indices by item places each first occurrence at the start
+//   of its run of equal items
+static bool *mark_unique(const valist *al) {
+  bool *keep = malloc(al->size ? al->size * sizeof(*keep) : 1);
+  size_t *order = malloc(al->size ? al->size * sizeof(*order) : 1);
+  if (!keep || !order) {
+    ALLOC_ERROR("unique flags of valist");
+  }
+  for (size_t i = 0; i < al->size; ++i) {
+    order[i] = i;
+  }
+  csort_tim(order, al->size, sizeof(*order), cmp_indices, al);
+
+  for (size_t run = 0; run < al->size;) {
+    const ctypeitem *first = &al->items[order[run]];
+    keep[order[run]] = true;
+    size_t next = run + 1;
+    for (; next < al->size; ++next) {
+      if (citem_cmp(&al->items[order[next]], first)) break;
+      keep[order[next]] = false;
+    }
+    run = next;
+  }
+  free(order);
+  return keep;
+}
+
+// Compare the items of the valist ctx at the indices a and b
+static int cmp_indices(const void *a, const void *b, const void *ctx) {
+  const valist *al = ctx;
+  return citem_cmp(&al->items[*(const size_t *) a],
+                   &al->items[*(const size_t *) b]);
+}
+
+static inline void mark_stale(const valist *al) {
+  ((valist *) al)->stale = true;
+}
+
+// Check if the columns of al are in use and up to date
+static inline bool columns_ready(const valist *al) {
+  return al->columnar && !al->stale;
+}
+
+// Rebuild stale columns of a columnar valist before a scan; the columns
+//   are a cache, so the scan is still a read of al
+static void refresh_columns(const valist *al) {
+  if (al->columnar && al->stale) {
+    rebuild_columns((valist *) al);
+  }
+}
+
+// Index every item of al again, keeping the storage of columns that are
+//   still needed and freeing the others
+static void rebuild_columns(valist *al) {
+  for (size_t c = 0; c < al->column_count; ++c) {
+    al->columns[c].size = 0;
+  }
+  al->stale = false;
+  for (size_t i = 0; i < al->size; ++i) {
+    index_item(al, i);
+  }
+
+  size_t kept = 0;
+  for (size_t c = 0; c < al->column_count; ++c) {
+    column *col = &al->columns[c];
+    if (col->size > 0) {
+      al->columns[kept++] = *col;
+    } else {
+      free(col->values);
+      free(col->positions);
+    }
+  }
+  al->column_count = kept;
+}
+
+static void free_columns(valist *al) {
+  for (size_t c = 0; c < al->column_count; ++c) {
+    free(al->columns[c].values);
+    free(al->columns[c].positions);
+  }
+  free(al->columns);
+  al->columns = NULL;
+  al->column_count = 0;
+  al->column_capacity = 0;
+}
+
+// Produce the column of the items of type in al, or NULL if there is none
+static column *column_of(const valist *al, const ctype *type) {
+  for (size_t c = 0; c < al->column_count; ++c) {
+    if (ctype_equals(al->columns[c].type, type)) {
+      return &al->columns[c];
+    }
+  }
+  return NULL;
+}
+
+static column *add_column(valist *al, const ctype *type) {
+  if (al->column_count == al->column_capacity) {
+    size_t capacity = al->column_capacity ? al->column_capacity * 2 : 4;
+    column *columns = realloc(al->columns, sizeof(*columns) * capacity);
+    if (!columns) {
+      ALLOC_ERROR("valist column");
+    }
+    al->columns = columns;
+    al->column_capacity = capacity;
+  }
+
+  column *col = &al->columns[al->column_count++];
+  col->type = type;
+  col->kernel = ckernel_select(type);
+  col->width = ctype_is_pod(type) ? data_size(type) : 0;
+  col->values = NULL;
+  col->positions = NULL;
+  col->size = 0;
+  col->capacity = 0;
+  return col;
+}
+
+// Add the item at index, which follows every indexed item, to its column
+static void index_item(valist *al, size_t index) {
+  if (!columns_ready(al)) return;
+
+  const ctypeitem *item = &al->items[index];
+  column *col = column_of(al, item->type);
+  if (!col) {
+    col = add_column(al, item->type);
+  }
+  column_push(col, item, index);
+}
+
+static void column_push(column *col, const ctypeitem *item, size_t index) {
+  if (col->size == col->capacity) {
+    size_t capacity = col->capacity ? col->capacity * 2 : 8;
+    if (capacity > SIZE_MAX / sizeof(*col->positions) ||
+        (col->width && capacity > SIZE_MAX / col->width)) {
+      ALLOC_ERROR("valist column");
+    }
+    size_t *positions = realloc(col->positions,
+                                sizeof(*positions) * capacity);
+    if (!positions) {
+      ALLOC_ERROR("valist column");
+    }
+    col->positions = positions;
+    if (col->width) {
+      unsigned char *values = realloc(col->values, col->width * capacity);
+      if (!values) {
+        ALLOC_ERROR("valist column");
+      }
+      col->values = values;
+    }
+    col->capacity = capacity;
+  }
+
+  if (col->width) {
+    memcpy(col->values + col->size * col->width, ctypeitem_value(item),
+           col->width);
+  }
+  col->positions[col->size++] = index;
+}
+
+// Produce the number of items of col at indices below index
+static size_t column_seek(const column *col, size_t index) {
+  size_t lo = 0;
+  size_t hi = col->size;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (col->positions[mid] < index) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Produce the first index position >= from of item in the column col of
+//   al, or VALIST_INDEX_NOT_FOUND
+static size_t column_find(const valist *al, const column *col, size_t from,
+                          const ctypeitem *item) {
+  size_t start = column_seek(col, from);
+  if (col->kernel != CKERNEL_NONE) {
+    size_t n = col->size - start;
+    size_t i = ckernel_find(col->kernel, col->values + start * col->width,
+                            n, ctypeitem_value(item));
+    return (i < n) ? col->positions[start + i] : VALIST_INDEX_NOT_FOUND;
+  }
+  for (size_t i = start; i < col->size; ++i) {
+    if (data_cmp(column_value(al, col, i), ctypeitem_value(item),
+                 col->type) == 0) {
+      return col->positions[i];
+    }
+  }
+  return VALIST_INDEX_NOT_FOUND;
+}
+
+// Produce the last index position < end of item in the column col of al,
+//   or VALIST_INDEX_NOT_FOUND
+static size_t column_find_last(const valist *al, const column *col,
+                               size_t end, const ctypeitem *item) {
+  size_t stop = column_seek(col, end);
+  if (col->kernel != CKERNEL_NONE) {
+    size_t i = ckernel_find_last(col->kernel, col->values, stop,
+                                 ctypeitem_value(item));
+    return (i < stop) ? col->positions[i] : VALIST_INDEX_NOT_FOUND;
+  }
+  for (size_t i = stop; i > 0; --i) {
+    if (data_cmp(column_value(al, col, i - 1), ctypeitem_value(item),
+                 col->type) == 0) {
+      return col->positions[i - 1];
+    }
+  }
+  return VALIST_INDEX_NOT_FOUND;
+}
+
+// Produce the value of the i-th item of col: its dense copy if the ctype
+//   is POD, and the value of its record otherwise
+static inline const void *column_value(const valist *al, const column *col,
+                                       size_t i) {
+  return col->width ? col->values + i * col->width
+                    : ctypeitem_value(&al->items[col->positions[i]]);
+}
@@ -0,0 +1,106 @@
+// Tests of calist.
+//   Each copying API must give the copy items of its own: a copy sharing
+//   an item with its source frees it twice when both are destroyed, which
+//   Valgrind [make test] reports.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include "calist.h"
+
+// Short strings fit in the slots of ctype_sso_string, and long ones spill
+//   to the heap
+static const char *const STRINGS[] = {
+  "short",
+  "a string much longer than twenty-two characters",
+  "",
+  "another string that lives on the heap, 52 chars",
+  "short",
+};
+#define STRING_COUNT (sizeof(STRINGS) / sizeof(STRINGS[0]))
+
+// Check if al holds the count strings starting at STRINGS[from]
+static bool holds_strings(const calist *al, size_t from, size_t count) {
+  if (calist_size(al) != count) return false;
+  for (size_t i = 0; i < count; ++i) {
+    if (strcmp(calist_get(al, i), STRINGS[from + i]) != 0) return false;
+  }
+  return true;
+}
+
+static bool is_any(const calist *al, const void *item, const void *args) {
+  (void) al;
+  (void) item;
+  (void) args;
+  return true;
+}
+
+// Create a calist of type holding STRINGS
+static calist *create_strings(const ctype *type) {
+  calist *al = calist_create(type);
+  for (size_t i = 0; i < STRING_COUNT; ++i) {
+    calist_append(al, STRINGS[i]);
+  }
+  return al;
+}
+
+// Destroy each copy only after its source, so that a copy sharing items
+//   with the source reads freed memory as well
+static void test_copies(const ctype *type) {
+  calist *al = create_strings(type);
+  calist *dup = calist_dup(al);
+  calist *slice = calist_slice(al, 1, 4);
+  calist *view_copy = calist_view_to_calist(calist_view_of(al, 1, 4));
+  calist *filtered = calist_filter(al, is_any, NULL);
+  calist *unique = calist_unique(al);
+
+  FILE *file = tmpfile();
+  assert(file);
+  assert(calist_save(al, file));
+  rewind(file);
+  calist *loaded = calist_load(type, file);
+  fclose(file);
+  assert(loaded);
+
+  // Overwriting the source must not change the copies
+  calist_set(al, 1, "a replacement that is also longer than 22 chars");
+  calist_destroy(al);
+
+  assert(holds_strings(dup, 0, STRING_COUNT));
+  assert(holds_strings(slice, 1, 3));
+  assert(holds_strings(view_copy, 1, 3));
+  assert(holds_strings(filtered, 0, STRING_COUNT));
+  assert(holds_strings(unique, 0, STRING_COUNT - 1));
+  assert(holds_strings(loaded, 0, STRING_COUNT));
+
+  calist_destroy(dup);
+  calist_destroy(slice);
+  calist_destroy(view_copy);
+  calist_destroy(filtered);
+  calist_destroy(unique);
+  calist_destroy(loaded);
+}
+
+// Slices of every range of an SSO list, including those of one long string
+static void test_sso_slices(void) {
+  calist *al = create_strings(ctype_sso_string());
+  for (size_t from = 0; from < STRING_COUNT; ++from) {
+    for (size_t end = from; end <= STRING_COUNT; ++end) {
+      calist *slice = calist_slice(al, from, end);
+      assert(holds_strings(slice, from, end - from));
+      calist_destroy(slice);
+    }
+  }
+  calist_destroy(al);
+}
+
+int main(void) {
+  test_copies(ctype_sso_string());
+  test_copies(ctype_interned_string());
+  test_copies(ctype_string());
+  test_sso_slices();
+  printf("All calist tests passed\n");
+  return EXIT_SUCCESS;
+}